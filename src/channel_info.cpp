@@ -46,7 +46,7 @@ stream_id ChannelInfo::GetId() const {
   return epg_.GetId();
 }
 
-EpgInfo ChannelInfo::GetEpg() const {
+const EpgInfo& ChannelInfo::GetEpg() const {
   return epg_;
 }
 
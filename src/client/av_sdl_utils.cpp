@@ -18,10 +18,165 @@
 
 #include "client/av_sdl_utils.h"
 
+#include <stdint.h>  // for uint16_t, uint8_t
+#include <string.h>  // for memcpy
+
+#include <SDL2/SDL_version.h>  // for SDL_VERSION_ATLEAST
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_NARROW_SSE2 1
+#include <emmintrin.h>  // for SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define HAVE_NARROW_NEON 1
+#include <arm_neon.h>
+#endif
+
+extern "C" {
+#include <libavutil/imgutils.h>  // for av_image_get_buffer_size
+}
+
 namespace fasto {
 namespace fastotv {
 namespace client {
 
+namespace {
+
+bool IsRendererSupportFormat(const SDL_RendererInfo& info, Uint32 format) {
+  for (Uint32 i = 0; i < info.num_texture_formats; ++i) {
+    if (info.texture_formats[i] == format) {
+      return true;
+    }
+  }
+  return false;
+}
+
+common::Error LockTexture(SDL_Texture* tex, void** pixels, int* pitch) {
+  if (SDL_LockTexture(tex, NULL, pixels, pitch) != 0) {
+    return common::make_error_value(common::MemSPrintf("LockTexture error: %s.", SDL_GetError()),
+                                    common::Value::E_ERROR);
+  }
+  return common::Error();
+}
+
+common::Error UploadNVTexture(SDL_Texture* tex, const AVFrame* frame) {
+  if (frame->linesize[0] < 0 || frame->linesize[1] < 0) {
+    return common::make_error_value("Negative linesize is not supported for NV.", common::Value::E_ERROR);
+  }
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+  if (SDL_UpdateNVTexture(tex, NULL, frame->data[0], frame->linesize[0], frame->data[1], frame->linesize[1]) != 0) {
+    return common::make_error_value(common::MemSPrintf("UpdateNVTexture error: %s.", SDL_GetError()),
+                                    common::Value::E_ERROR);
+  }
+  return common::Error();
+#else
+  void* pixels = NULL;
+  int pitch = 0;
+  common::Error err = LockTexture(tex, &pixels, &pitch);
+  if (err && err->IsError()) {
+    return err;
+  }
+
+  uint8_t* dst = static_cast<uint8_t*>(pixels);
+  for (int y = 0; y < frame->height; ++y) {
+    memcpy(dst + y * pitch, frame->data[0] + y * frame->linesize[0], frame->width);
+  }
+  dst += pitch * frame->height;
+  const int uv_width = (frame->width + 1) & ~1;
+  for (int y = 0; y < (frame->height + 1) / 2; ++y) {
+    memcpy(dst + y * pitch, frame->data[1] + y * frame->linesize[1], uv_width);
+  }
+  SDL_UnlockTexture(tex);
+  return common::Error();
+#endif
+}
+
+// P010 keeps sample in high bits, so high byte is the 8 bit sample
+void NarrowP010Row(uint8_t* dst, const uint16_t* src, int count) {
+  int x = 0;
+#if defined(HAVE_NARROW_SSE2)
+  for (; x + 16 <= count; x += 16) {
+    const __m128i lo = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x)), 8);
+    const __m128i hi = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 8)), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+  }
+#elif defined(HAVE_NARROW_NEON)
+  for (; x + 16 <= count; x += 16) {
+    const uint8x8_t lo = vshrn_n_u16(vld1q_u16(src + x), 8);
+    const uint8x8_t hi = vshrn_n_u16(vld1q_u16(src + x + 8), 8);
+    vst1q_u8(dst + x, vcombine_u8(lo, hi));
+  }
+#endif
+  for (; x < count; ++x) {
+    dst[x] = src[x] >> 8;
+  }
+}
+
+// SDL2 has no 10 bit textures, rows are narrowed straight into locked NV12 texture
+common::Error UploadP010Texture(SDL_Texture* tex, const AVFrame* frame) {
+  if (frame->linesize[0] < 0 || frame->linesize[1] < 0) {
+    return common::make_error_value("Negative linesize is not supported for P010.", common::Value::E_ERROR);
+  }
+
+  void* pixels = NULL;
+  int pitch = 0;
+  common::Error err = LockTexture(tex, &pixels, &pitch);
+  if (err && err->IsError()) {
+    return err;
+  }
+
+  uint8_t* dst = static_cast<uint8_t*>(pixels);
+  for (int y = 0; y < frame->height; ++y) {
+    const uint16_t* src = reinterpret_cast<const uint16_t*>(frame->data[0] + y * frame->linesize[0]);
+    NarrowP010Row(dst + y * pitch, src, frame->width);
+  }
+  dst += pitch * frame->height;
+  const int uv_width = (frame->width + 1) & ~1;
+  for (int y = 0; y < (frame->height + 1) / 2; ++y) {
+    const uint16_t* src = reinterpret_cast<const uint16_t*>(frame->data[1] + y * frame->linesize[1]);
+    NarrowP010Row(dst + y * pitch, src, uv_width);
+  }
+  SDL_UnlockTexture(tex);
+  return common::Error();
+}
+
+}  // namespace
+
+Uint32 ConvertPixelFormatToSDL(AVPixelFormat pix_fmt) {
+  switch (pix_fmt) {
+    case AV_PIX_FMT_YUV420P:
+      return SDL_PIXELFORMAT_YV12;
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_P010LE:
+      return SDL_PIXELFORMAT_NV12;
+    case AV_PIX_FMT_NV21:
+      return SDL_PIXELFORMAT_NV21;
+    case AV_PIX_FMT_BGRA:
+      return SDL_PIXELFORMAT_ARGB8888;
+    default:
+      return SDL_PIXELFORMAT_UNKNOWN;
+  }
+}
+
+std::vector<AVPixelFormat> GetSupportedPixelFormats(SDL_Renderer* renderer) {
+  std::vector<AVPixelFormat> result;
+  SDL_RendererInfo info;
+  if (renderer && SDL_GetRendererInfo(renderer, &info) == 0) {
+    if (IsRendererSupportFormat(info, SDL_PIXELFORMAT_NV12)) {
+      result.push_back(AV_PIX_FMT_NV12);
+      result.push_back(AV_PIX_FMT_P010LE);
+    }
+    if (IsRendererSupportFormat(info, SDL_PIXELFORMAT_NV21)) {
+      result.push_back(AV_PIX_FMT_NV21);
+    }
+  }
+
+  // always available, SDL converts them itself if renderer can't
+  result.push_back(AV_PIX_FMT_YUV420P);
+  result.push_back(AV_PIX_FMT_BGRA);
+  result.push_back(AV_PIX_FMT_NONE);
+  return result;
+}
+
 common::Error UploadTexture(SDL_Texture* tex, const AVFrame* frame) {
   if (frame->format == AV_PIX_FMT_YUV420P) {
     if (frame->linesize[0] < 0 || frame->linesize[1] < 0 || frame->linesize[2] < 0) {
@@ -33,6 +188,10 @@ common::Error UploadTexture(SDL_Texture* tex, const AVFrame* frame) {
                                       common::Value::E_ERROR);
     }
     return common::Error();
+  } else if (frame->format == AV_PIX_FMT_NV12 || frame->format == AV_PIX_FMT_NV21) {
+    return UploadNVTexture(tex, frame);
+  } else if (frame->format == AV_PIX_FMT_P010LE) {
+    return UploadP010Texture(tex, frame);
   } else if (frame->format == AV_PIX_FMT_BGRA) {
     if (frame->linesize[0] < 0) {
       if (SDL_UpdateTexture(tex, NULL, frame->data[0] + frame->linesize[0] * (frame->height - 1),
@@ -55,6 +214,18 @@ common::Error UploadTexture(SDL_Texture* tex, const AVFrame* frame) {
                                   common::Value::E_ERROR);
 }
 
+size_t CalcUploadTextureSize(const AVFrame* frame) {
+  AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+  if (format == AV_PIX_FMT_P010LE) {
+    format = AV_PIX_FMT_NV12;  // samples are narrowed to 8 bit on upload
+  }
+  int size = av_image_get_buffer_size(format, frame->width, frame->height, 1);
+  if (size < 0) {
+    return 0;
+  }
+  return size;
+}
+
 }  // namespace client
 }  // namespace fastotv
 }  // namespace fasto
@@ -18,9 +18,14 @@
 
 #pragma once
 
+#include <stddef.h>  // for size_t
+
+#include <vector>  // for vector
+
 #include <SDL2/SDL_render.h>  // for SDL_Renderer, SDL_Texture
 extern "C" {
-#include <libavutil/frame.h>  // for AVFrame
+#include <libavutil/frame.h>   // for AVFrame
+#include <libavutil/pixfmt.h>  // for AVPixelFormat
 }
 
 #include <common/error.h>  // for Error
@@ -29,7 +34,14 @@ namespace fasto {
 namespace fastotv {
 namespace client {
 
+// texture format for frames of pix_fmt, SDL_PIXELFORMAT_UNKNOWN if not supported
+Uint32 ConvertPixelFormatToSDL(AVPixelFormat pix_fmt);
+// pixel formats which UploadTexture can put into renderer textures without swscale
+std::vector<AVPixelFormat> GetSupportedPixelFormats(SDL_Renderer* renderer);
+
 common::Error UploadTexture(SDL_Texture* tex, const AVFrame* frame) WARN_UNUSED_RESULT;
+// bytes which UploadTexture copies into texture for frame
+size_t CalcUploadTextureSize(const AVFrame* frame);
 
 }  // namespace client
 }  // namespace fastotv
@@ -0,0 +1,308 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "client/channel_icon_cache.h"
+
+#include <stdint.h>  // for uint32_t, uint64_t
+
+#include <algorithm>  // for max
+#include <limits>     // for numeric_limits
+
+#include <SDL2/SDL_image.h>  // for IMG_Load
+
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+#include "client/sdl_utils.h"  // for SurfaceSaver
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+namespace {
+
+// box filter over ARGB8888 surfaces, color is weighted by alpha so transparent pixels don't darken edges
+void AreaScale(const SDL_Surface* src, SDL_Surface* dst) {
+  const uint8_t* src_pixels = static_cast<const uint8_t*>(src->pixels);
+  uint8_t* dst_pixels = static_cast<uint8_t*>(dst->pixels);
+  for (int dy = 0; dy < dst->h; ++dy) {
+    const int y0 = dy * src->h / dst->h;
+    const int y1 = std::max(y0 + 1, (dy + 1) * src->h / dst->h);
+    uint32_t* dst_line = reinterpret_cast<uint32_t*>(dst_pixels + dy * dst->pitch);
+    for (int dx = 0; dx < dst->w; ++dx) {
+      const int x0 = dx * src->w / dst->w;
+      const int x1 = std::max(x0 + 1, (dx + 1) * src->w / dst->w);
+      uint64_t a = 0, r = 0, g = 0, b = 0;
+      for (int y = y0; y < y1; ++y) {
+        const uint32_t* src_line = reinterpret_cast<const uint32_t*>(src_pixels + y * src->pitch);
+        for (int x = x0; x < x1; ++x) {
+          const uint32_t pixel = src_line[x];
+          const uint32_t alpha = pixel >> 24;
+          a += alpha;
+          r += ((pixel >> 16) & 0xFF) * alpha;
+          g += ((pixel >> 8) & 0xFF) * alpha;
+          b += (pixel & 0xFF) * alpha;
+        }
+      }
+      const uint64_t count = static_cast<uint64_t>(y1 - y0) * (x1 - x0);
+      uint32_t result = 0;
+      if (a) {
+        result = static_cast<uint32_t>((a + count / 2) / count) << 24 | static_cast<uint32_t>((r + a / 2) / a) << 16 |
+                 static_cast<uint32_t>((g + a / 2) / a) << 8 | static_cast<uint32_t>((b + a / 2) / a);
+      }
+      dst_line[dx] = result;
+    }
+  }
+}
+
+}  // namespace
+
+ChannelIconCache::ChannelIconCache(size_t max_memory, size_t workers)
+    : max_memory_(max_memory),
+      workers_(),
+      mutex_(),
+      cond_(),
+      requests_(),
+      pending_(),
+      results_(),
+      invalidated_(),
+      versions_(),
+      running_(false),
+      icons_(),
+      lru_(),
+      used_memory_(0) {
+  for (size_t i = 0; i < (workers ? workers : 1); ++i) {
+    workers_.push_back(THREAD_MANAGER()->CreateThread(&ChannelIconCache::Run, this));
+  }
+}
+
+ChannelIconCache::~ChannelIconCache() {
+  Stop();
+  icons_.clear();
+  lru_.clear();
+  used_memory_ = 0;
+}
+
+bool ChannelIconCache::Start() {
+  {
+    lock_t lock(mutex_);
+    if (running_) {
+      return true;
+    }
+    running_ = true;
+  }
+
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (!workers_[i]->Start()) {
+      {
+        lock_t lock(mutex_);
+        running_ = false;
+        cond_.notify_all();
+      }
+      for (size_t j = 0; j < i; ++j) {
+        workers_[j]->Join();
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void ChannelIconCache::Stop() {
+  {
+    lock_t lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    cond_.notify_all();
+  }
+
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Join();
+  }
+
+  lock_t lock(mutex_);
+  for (size_t i = 0; i < results_.size(); ++i) {
+    SDL_FreeSurface(results_[i].surface);
+  }
+  results_.clear();
+  requests_.clear();
+  pending_.clear();
+}
+
+channel_icon_t ChannelIconCache::GetIcon(const std::string& path, int size) {
+  ApplyUpdates();
+
+  const key_t key(path, size);
+  auto found = icons_.find(key);
+  if (found != icons_.end()) {
+    lru_.splice(lru_.begin(), lru_, found->second.lru);
+    return found->second.icon;
+  }
+
+  lock_t lock(mutex_);
+  if (running_ && pending_.insert(key).second) {
+    Request request = {key, versions_[path]};
+    requests_.push_back(request);
+    cond_.notify_one();
+  }
+  return channel_icon_t();
+}
+
+void ChannelIconCache::Invalidate(const std::string& path) {
+  lock_t lock(mutex_);
+  versions_[path]++;
+  invalidated_.push_back(path);
+}
+
+size_t ChannelIconCache::GetUsedMemory() const {
+  return used_memory_;
+}
+
+size_t ChannelIconCache::GetMaxMemory() const {
+  return max_memory_;
+}
+
+int ChannelIconCache::Run() {
+  while (true) {
+    Request request;
+    {
+      lock_t lock(mutex_);
+      while (running_ && requests_.empty()) {
+        cond_.wait(lock);
+      }
+      if (!running_) {
+        return 0;
+      }
+      request = requests_.front();
+      requests_.pop_front();
+    }
+
+    Result result = {request.key, request.version, LoadScaled(request.key.first, request.key.second)};
+    lock_t lock(mutex_);
+    results_.push_back(result);
+  }
+}
+
+SDL_Surface* ChannelIconCache::LoadScaled(const std::string& path, int size) {
+  SDL_Surface* surface = IMG_Load(path.c_str());
+  if (!surface || size <= 0 || (surface->w <= size && surface->h <= size)) {
+    return surface;
+  }
+
+  SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+  SDL_FreeSurface(surface);
+  if (!converted) {
+    return NULL;
+  }
+
+  // icons are drawn into square, so they are scaled the same way
+  SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+  if (!scaled) {
+    SDL_FreeSurface(converted);
+    return NULL;
+  }
+
+  // SDL_BlitScaled is nearest neighbour only, renderer used to scale icons with linear filter
+  if (SDL_LockSurface(converted) != 0) {
+    SDL_FreeSurface(converted);
+    SDL_FreeSurface(scaled);
+    return NULL;
+  }
+  if (SDL_LockSurface(scaled) != 0) {
+    SDL_UnlockSurface(converted);
+    SDL_FreeSurface(converted);
+    SDL_FreeSurface(scaled);
+    return NULL;
+  }
+  AreaScale(converted, scaled);
+  SDL_UnlockSurface(scaled);
+  SDL_UnlockSurface(converted);
+  SDL_FreeSurface(converted);
+  return scaled;
+}
+
+void ChannelIconCache::ApplyUpdates() {
+  std::vector<Result> results;
+  std::vector<std::string> invalidated;
+  {
+    lock_t lock(mutex_);
+    if (results_.empty() && invalidated_.empty()) {
+      return;
+    }
+
+    invalidated.swap(invalidated_);
+    for (size_t i = 0; i < results_.size(); ++i) {
+      const Result& result = results_[i];
+      pending_.erase(result.key);
+      if (versions_[result.key.first] != result.version) {  // file changed while decoding
+        SDL_FreeSurface(result.surface);
+        continue;
+      }
+      results.push_back(result);
+    }
+    results_.clear();
+  }
+
+  for (size_t i = 0; i < invalidated.size(); ++i) {
+    const std::string& path = invalidated[i];
+    auto it = icons_.lower_bound(key_t(path, std::numeric_limits<int>::min()));
+    while (it != icons_.end() && it->first.first == path) {
+      key_t key = it->first;
+      ++it;
+      Erase(key);
+    }
+  }
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    Erase(result.key);
+
+    Icon icon;
+    icon.bytes = 0;
+    if (result.surface) {
+      icon.bytes = static_cast<size_t>(result.surface->pitch) * result.surface->h;
+      icon.icon = common::make_shared<SurfaceSaver>(result.surface);
+    }
+    lru_.push_front(result.key);
+    icon.lru = lru_.begin();
+    icons_[result.key] = icon;
+    used_memory_ += icon.bytes;
+  }
+  Shrink();
+}
+
+void ChannelIconCache::Erase(const key_t& key) {
+  auto found = icons_.find(key);
+  if (found == icons_.end()) {
+    return;
+  }
+
+  used_memory_ -= found->second.bytes;
+  lru_.erase(found->second.lru);
+  icons_.erase(found);
+}
+
+void ChannelIconCache::Shrink() {
+  while (used_memory_ > max_memory_ && lru_.size() > 1) {
+    Erase(lru_.back());
+  }
+}
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,121 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <deque>   // for deque
+#include <list>    // for list
+#include <map>     // for map
+#include <set>     // for set
+#include <string>  // for string
+#include <vector>  // for vector
+
+#include <SDL2/SDL_surface.h>  // for SDL_Surface
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+#include <common/smart_ptr.h>
+#include <common/threads/types.h>  // for condition_variable, mutex
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+class SurfaceSaver;
+typedef common::shared_ptr<SurfaceSaver> channel_icon_t;
+
+/*
+ * Channel icons are decoded lazily on worker threads, when they are first needed for display,
+ * and downscaled to the drawn size. Decoded icons are evicted least recently used first
+ * when memory budget is exceeded.
+ */
+class ChannelIconCache {
+ public:
+  enum { default_workers = 2 };
+
+  explicit ChannelIconCache(size_t max_memory, size_t workers = default_workers);
+  ~ChannelIconCache();
+
+  bool Start();
+  void Stop();  // drops not yet decoded requests
+
+  // main thread only, empty until icon is decoded
+  channel_icon_t GetIcon(const std::string& path, int size);
+  // icon file was changed on disk, can be called from any thread
+  void Invalidate(const std::string& path);
+
+  size_t GetUsedMemory() const;
+  size_t GetMaxMemory() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ChannelIconCache);
+  typedef common::unique_lock<common::mutex> lock_t;
+  typedef std::pair<std::string, int> key_t;  // path, size
+
+  struct Request {
+    key_t key;
+    size_t version;
+  };
+
+  struct Result {
+    key_t key;
+    size_t version;
+    SDL_Surface* surface;  // NULL if decoding failed
+  };
+
+  struct Icon {
+    channel_icon_t icon;  // empty if decoding failed, not retried until invalidation
+    size_t bytes;
+    std::list<key_t>::iterator lru;
+  };
+
+  int Run();
+  static SDL_Surface* LoadScaled(const std::string& path, int size);
+
+  void ApplyUpdates();
+  void Erase(const key_t& key);
+  void Shrink();
+
+  const size_t max_memory_;
+
+  std::vector<common::shared_ptr<common::threads::Thread<int> > > workers_;
+  common::mutex mutex_;
+  common::condition_variable cond_;
+  std::deque<Request> requests_;
+  std::set<key_t> pending_;
+  std::vector<Result> results_;
+  std::vector<std::string> invalidated_;
+  std::map<std::string, size_t> versions_;
+  bool running_;
+
+  // main thread
+  std::map<key_t, Icon> icons_;
+  std::list<key_t> lru_;  // most recently used first
+  size_t used_memory_;
+};
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
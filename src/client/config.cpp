@@ -43,6 +43,11 @@
 #define CONFIG_PLAYER_OPTIONS_LAST_SHOWED_CHANNEL_ID_FIELD "last_showed_channel_id"
 #define CONFIG_PLAYER_OPTIONS_EXIT_ON_KEYDOWN_FIELD "exitonkeydown"
 #define CONFIG_PLAYER_OPTIONS_EXIT_ON_MOUSEDOWN_FIELD "exitonmousedown"
+#define CONFIG_PLAYER_OPTIONS_PREWARM_FIELD "prewarm"
+#define CONFIG_PLAYER_OPTIONS_PREWARM_MEMORY_FIELD "prewarmmem"
+#define CONFIG_PLAYER_OPTIONS_PREWARM_BANDWIDTH_FIELD "prewarmbw"
+#define CONFIG_PLAYER_OPTIONS_VSYNC_ALIGN_FIELD "vsyncalign"
+#define CONFIG_PLAYER_OPTIONS_ICONS_MEMORY_FIELD "iconsmem"
 
 #define CONFIG_APP_OPTIONS "app_options"
 #define CONFIG_APP_OPTIONS_AST_FIELD "ast"
@@ -64,6 +69,18 @@
 #define CONFIG_APP_OPTIONS_HWACCEL_DEVICE_FIELD "hwaccel_device"
 #define CONFIG_APP_OPTIONS_HWACCEL_OUTPUT_FORMAT_FIELD "hwaccel_output_format"
 #define CONFIG_APP_OPTIONS_AUTOROTATE_FIELD "autorotate"
+#define CONFIG_APP_OPTIONS_DOWNSCALE_FIELD "downscale"
+#define CONFIG_APP_OPTIONS_FRAME_QUEUE_FIELD "framequeue"
+#define CONFIG_APP_OPTIONS_VIDEO_QUEUE_SIZE_FIELD "vqsize"
+#define CONFIG_APP_OPTIONS_AUDIO_QUEUE_SIZE_FIELD "aqsize"
+#define CONFIG_APP_OPTIONS_DECODER_THREADS_FIELD "dthreads"
+#define CONFIG_APP_OPTIONS_DECODER_THREAD_TYPE_FIELD "dthreadtype"
+#define CONFIG_APP_OPTIONS_DECODER_LATENCY_FIELD "dlatency"
+#define CONFIG_APP_OPTIONS_DECODER_SKIP_FIELD "dskip"
+#define CONFIG_APP_OPTIONS_LIVE_LATENCY_FIELD "livelatency"
+#define CONFIG_APP_OPTIONS_BUFFER_LOW_FIELD "bufferlow"
+#define CONFIG_APP_OPTIONS_BUFFER_HIGH_FIELD "bufferhigh"
+#define CONFIG_APP_OPTIONS_READAHEAD_FIELD "readahead"
 
 // vaapi args: -hwaccel vaapi -hwaccel_device /dev/dri/card0
 // vdpau args: -hwaccel vdpau
@@ -94,6 +111,18 @@
   hwaccel_device=std::string() []
   hwaccel_output_format=std::string() []
   autorotate=false [true,false]
+  downscale=true [true,false]
+  framequeue=adaptive [fixed, adaptive]
+  vqsize=0 [0, INT_MAX]
+  aqsize=0 [0, INT_MAX]
+  dthreads=0 [0, INT_MAX]
+  dthreadtype=auto [auto, frame, slice]
+  dlatency=0 [0, INT_MAX] msec
+  dskip=true [true,false]
+  livelatency=0 [0, INT_MAX] msec
+  bufferlow=0 [0, INT_MAX] msec
+  bufferhigh=0 [0, INT_MAX] msec
+  readahead=0 [0, INT_MAX] KB
 
   [player_options]
   width=0  [0, INT_MAX]
@@ -102,6 +131,11 @@
   volume=100 [0,100]
   exitonkeydown=false [true,false]
   exitonmousedown=false [true,false]
+  prewarm=false [true,false]
+  prewarmmem=16384 [0, INT_MAX] KB
+  prewarmbw=0 [0, INT_MAX] kb/s
+  vsyncalign=false [true,false]
+  iconsmem=8192 [0, INT_MAX] KB
 */
 
 namespace fasto {
@@ -110,6 +144,16 @@ namespace client {
 
 namespace {
 
+const char* decoder_thread_type_to_text(fasto::fastotv::client::core::DECODER_THREAD_TYPE type) {
+  if (type == fasto::fastotv::client::core::DECODER_THREAD_FRAME) {
+    return "frame";
+  } else if (type == fasto::fastotv::client::core::DECODER_THREAD_SLICE) {
+    return "slice";
+  }
+
+  return "auto";
+}
+
 int ini_handler_fasto(void* user, const char* section, const char* name, const char* value) {
   TVConfig* pconfig = reinterpret_cast<TVConfig*>(user);
   size_t value_len = strlen(value);
@@ -166,6 +210,36 @@ int ini_handler_fasto(void* user, const char* section, const char* name, const c
       pconfig->player_options.exit_on_mousedown = exit;
     }
     return 1;
+  } else if (MATCH(CONFIG_PLAYER_OPTIONS, CONFIG_PLAYER_OPTIONS_PREWARM_FIELD)) {
+    bool prewarm;
+    if (parse_bool(value, &prewarm)) {
+      pconfig->player_options.prewarm_adjacent_streams = prewarm;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_PLAYER_OPTIONS, CONFIG_PLAYER_OPTIONS_PREWARM_MEMORY_FIELD)) {
+    int memory;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &memory)) {
+      pconfig->player_options.prewarm_max_memory = memory;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_PLAYER_OPTIONS, CONFIG_PLAYER_OPTIONS_PREWARM_BANDWIDTH_FIELD)) {
+    int bandwidth;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &bandwidth)) {
+      pconfig->player_options.prewarm_max_bandwidth = bandwidth;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_PLAYER_OPTIONS, CONFIG_PLAYER_OPTIONS_VSYNC_ALIGN_FIELD)) {
+    bool align;
+    if (parse_bool(value, &align)) {
+      pconfig->player_options.align_to_vsync = align;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_PLAYER_OPTIONS, CONFIG_PLAYER_OPTIONS_ICONS_MEMORY_FIELD)) {
+    int memory;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &memory)) {
+      pconfig->player_options.icons_max_memory = memory;
+    }
+    return 1;
   } else if (MATCH(CONFIG_PLAYER_OPTIONS, CONFIG_PLAYER_OPTIONS_LAST_SHOWED_CHANNEL_ID_FIELD)) {
     pconfig->player_options.last_showed_channel_id = value;
     return 1;
@@ -292,6 +366,86 @@ int ini_handler_fasto(void* user, const char* section, const char* name, const c
       pconfig->app_options.autorotate = autorotate;
     }
     return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_DOWNSCALE_FIELD)) {
+    bool downscale;
+    if (parse_bool(value, &downscale)) {
+      pconfig->app_options.display_downscale = downscale;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_FRAME_QUEUE_FIELD)) {
+    if (strcmp(value, "fixed") == 0) {
+      pconfig->app_options.frame_queue_strategy = fasto::fastotv::client::core::FRAME_QUEUE_FIXED;
+    } else if (strcmp(value, "adaptive") == 0) {
+      pconfig->app_options.frame_queue_strategy = fasto::fastotv::client::core::FRAME_QUEUE_ADAPTIVE;
+    } else {
+      return 0;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_VIDEO_QUEUE_SIZE_FIELD)) {
+    int size;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &size)) {
+      pconfig->app_options.video_frame_queue_size = size;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_AUDIO_QUEUE_SIZE_FIELD)) {
+    int size;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &size)) {
+      pconfig->app_options.audio_frame_queue_size = size;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_DECODER_THREADS_FIELD)) {
+    int threads;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &threads)) {
+      pconfig->app_options.decoder_thread_count = threads;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_DECODER_THREAD_TYPE_FIELD)) {
+    if (strcmp(value, "auto") == 0) {
+      pconfig->app_options.decoder_thread_type = fasto::fastotv::client::core::DECODER_THREAD_AUTO;
+    } else if (strcmp(value, "frame") == 0) {
+      pconfig->app_options.decoder_thread_type = fasto::fastotv::client::core::DECODER_THREAD_FRAME;
+    } else if (strcmp(value, "slice") == 0) {
+      pconfig->app_options.decoder_thread_type = fasto::fastotv::client::core::DECODER_THREAD_SLICE;
+    } else {
+      return 0;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_DECODER_LATENCY_FIELD)) {
+    int latency;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &latency)) {
+      pconfig->app_options.decoder_max_latency = latency;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_DECODER_SKIP_FIELD)) {
+    bool skip;
+    if (parse_bool(value, &skip)) {
+      pconfig->app_options.decoder_skip = skip;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_LIVE_LATENCY_FIELD)) {
+    int latency;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &latency)) {
+      pconfig->app_options.live_latency = latency;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_BUFFER_LOW_FIELD)) {
+    int buffer;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &buffer)) {
+      pconfig->app_options.buffer_low = buffer;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_BUFFER_HIGH_FIELD)) {
+    int buffer;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &buffer)) {
+      pconfig->app_options.buffer_high = buffer;
+    }
+    return 1;
+  } else if (MATCH(CONFIG_APP_OPTIONS, CONFIG_APP_OPTIONS_READAHEAD_FIELD)) {
+    int size;
+    if (parse_number(value, 0, std::numeric_limits<int>::max(), &size)) {
+      pconfig->app_options.readahead_size = size;
+    }
+    return 1;
   } else {
     return 0; /* unknown section/name, error */
   }
@@ -370,6 +524,28 @@ common::Error save_config_file(const std::string& config_absolute_path, TVConfig
                                  options->app_options.hwaccel_output_format);
   config_save_file.WriteFormated(CONFIG_APP_OPTIONS_AUTOROTATE_FIELD "=%s\n",
                                  common::ConvertToString(options->app_options.autorotate));
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_DOWNSCALE_FIELD "=%s\n",
+                                 common::ConvertToString(options->app_options.display_downscale));
+  config_save_file.WriteFormated(
+      CONFIG_APP_OPTIONS_FRAME_QUEUE_FIELD "=%s\n",
+      options->app_options.frame_queue_strategy == fasto::fastotv::client::core::FRAME_QUEUE_FIXED ? "fixed"
+                                                                                                  : "adaptive");
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_VIDEO_QUEUE_SIZE_FIELD "=%d\n",
+                                 options->app_options.video_frame_queue_size);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_AUDIO_QUEUE_SIZE_FIELD "=%d\n",
+                                 options->app_options.audio_frame_queue_size);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_DECODER_THREADS_FIELD "=%d\n",
+                                 options->app_options.decoder_thread_count);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_DECODER_THREAD_TYPE_FIELD "=%s\n",
+                                 decoder_thread_type_to_text(options->app_options.decoder_thread_type));
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_DECODER_LATENCY_FIELD "=%d\n",
+                                 options->app_options.decoder_max_latency);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_DECODER_SKIP_FIELD "=%s\n",
+                                 common::ConvertToString(options->app_options.decoder_skip));
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_LIVE_LATENCY_FIELD "=%d\n", options->app_options.live_latency);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_BUFFER_LOW_FIELD "=%d\n", options->app_options.buffer_low);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_BUFFER_HIGH_FIELD "=%d\n", options->app_options.buffer_high);
+  config_save_file.WriteFormated(CONFIG_APP_OPTIONS_READAHEAD_FIELD "=%d\n", options->app_options.readahead_size);
 
   config_save_file.Write("[" CONFIG_PLAYER_OPTIONS "]\n");
   config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_WIDTH_FIELD "=%d\n", options->player_options.screen_size.width);
@@ -382,6 +558,16 @@ common::Error save_config_file(const std::string& config_absolute_path, TVConfig
                                  common::ConvertToString(options->player_options.exit_on_keydown));
   config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_EXIT_ON_MOUSEDOWN_FIELD "=%s\n",
                                  common::ConvertToString(options->player_options.exit_on_mousedown));
+  config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_PREWARM_FIELD "=%s\n",
+                                 common::ConvertToString(options->player_options.prewarm_adjacent_streams));
+  config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_PREWARM_MEMORY_FIELD "=%d\n",
+                                 options->player_options.prewarm_max_memory);
+  config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_PREWARM_BANDWIDTH_FIELD "=%d\n",
+                                 options->player_options.prewarm_max_bandwidth);
+  config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_VSYNC_ALIGN_FIELD "=%s\n",
+                                 common::ConvertToString(options->player_options.align_to_vsync));
+  config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_ICONS_MEMORY_FIELD "=%d\n",
+                                 options->player_options.icons_max_memory);
   config_save_file.WriteFormated(CONFIG_PLAYER_OPTIONS_LAST_SHOWED_CHANNEL_ID_FIELD "=%s\n",
                                  options->player_options.last_showed_channel_id);
 
@@ -29,13 +29,25 @@ namespace core {
 
 AppOptions::AppOptions()
     : autorotate(true),
+      display_downscale(true),
       framedrop(FRAME_DROP_AUTO),
       seek_by_bytes(SEEK_AUTO),
       genpts(false),
       av_sync_type(AV_SYNC_AUDIO_MASTER),
       infinite_buffer(-1),
+      frame_queue_strategy(FRAME_QUEUE_ADAPTIVE),
+      video_frame_queue_size(0),
+      audio_frame_queue_size(0),
       wanted_stream_spec(),
       lowres(0),
+      decoder_thread_type(DECODER_THREAD_AUTO),
+      decoder_thread_count(0),
+      decoder_max_latency(0),
+      decoder_skip(true),
+      live_latency(0),
+      buffer_low(0),
+      buffer_high(0),
+      readahead_size(0),
       fast(false),
       audio_codec_name(),
       video_codec_name(),
@@ -44,7 +56,8 @@ AppOptions::AppOptions()
       hwaccel_output_format(),
       auto_exit(true),
       enable_video(true),
-      enable_audio(true)
+      enable_audio(true),
+      probe_cache_path()
 #if CONFIG_AVFILTER
       ,
       vfilters(),
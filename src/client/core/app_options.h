@@ -44,18 +44,32 @@ namespace core {
 
 enum FRAME_DROP_STRATEGY { FRAME_DROP_AUTO = -1, FRAME_DROP_OFF = 0, FRAME_DROP_ON = 1 };
 enum SEEK_STRATEGY { SEEK_AUTO = -1, SEEK_BY_BYTES_OFF = 0, SEEK_BY_BYTES_ON = 1 };
+enum FRAME_QUEUE_STRATEGY { FRAME_QUEUE_FIXED = 0, FRAME_QUEUE_ADAPTIVE = 1 };
+enum DECODER_THREAD_TYPE { DECODER_THREAD_AUTO = 0, DECODER_THREAD_FRAME = 1, DECODER_THREAD_SLICE = 2 };
 
 struct AppOptions {
   AppOptions();
   bool autorotate;
+  bool display_downscale;  // frames bigger than display are scaled in filter stage before texture upload
 
   FRAME_DROP_STRATEGY framedrop;
   SEEK_STRATEGY seek_by_bytes;
   bool genpts;
   AvSyncType av_sync_type;
   int infinite_buffer;
+  FRAME_QUEUE_STRATEGY frame_queue_strategy;
+  int video_frame_queue_size;  // frames, 0 - calculated from stream and memory
+  int audio_frame_queue_size;  // frames, 0 - calculated from stream
   std::string wanted_stream_spec[AVMEDIA_TYPE_NB];
   int lowres;
+  DECODER_THREAD_TYPE decoder_thread_type;
+  int decoder_thread_count;  // video decoder threads, 0 - calculated from cores
+  int decoder_max_latency;   // msec which frame threading can add in auto mode, 0 - unlimited
+  bool decoder_skip;         // skip decoding of frames while video decoder can't keep up with clock
+  int live_latency;          // msec behind live edge kept on realtime streams, 0 - no latency control
+  int buffer_low;            // msec of demuxed media when reading resumes, 0 - live/vod default
+  int buffer_high;           // msec of demuxed media when reading stops, 0 - live/vod default
+  int readahead_size;        // KB read from input ahead of demuxer by own thread, 0 - FFmpeg I/O
 
   /* options specified by the user */
   bool fast;
@@ -68,6 +82,7 @@ struct AppOptions {
   bool auto_exit;  // exit from stream if eos
   bool enable_video;
   bool enable_audio;
+  std::string probe_cache_path;  // per channel, filled by player, empty - full probe on every open
 #if CONFIG_AVFILTER
   std::string vfilters;
   std::string afilters;
@@ -20,6 +20,8 @@
 
 #include <stdlib.h>  // for EXIT_SUCCESS, EXIT_FAI...
 
+#include <algorithm>  // for std::min
+
 #include <SDL2/SDL.h>           // for SDL_Init, SDL_Quit
 #include <SDL2/SDL_keyboard.h>  // for SDL_Keysym
 #include <SDL2/SDL_mouse.h>     // for SDL_ShowCursor
@@ -31,9 +33,11 @@
 #include <common/logger.h>                  // for COMPACT_LOG_ERROR, COM...
 #include <common/macros.h>                  // for UNUSED, DNOTREACHED
 #include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+#include <common/time.h>                    // for current_mstime
 
 #include "client/core/events/events.h"  // for QuitEvent, QuitInfo
 
+#include "client/core/trace.h"  // for TRACE_THREAD_NAME
 #include "client/core/types.h"  // for GetCurrentMsec, msec_t
 #include "client/types.h"       // for Size
 
@@ -82,28 +86,42 @@ int Sdl2Application::PreExec() {
 }
 
 int Sdl2Application::Exec() {
+  TRACE_THREAD_NAME("main");
   SDL_PumpEvents();
+  common::time64_t last_timer_ts = 0;
+  common::time64_t next_timer_ts = 0;
   while (true) {
     SDL_Event event;
-    Uint32 start_wait_ts = SDL_GetTicks();
     int res = SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
-    if (res == -1) {        // error
-    } else if (res == 0) {  // no events
-      events::TimeInfo inf;
-      events::TimerEvent* timer_event = new events::TimerEvent(this, inf);
-      HandleEvent(timer_event);
-      int work_time = SDL_GetTicks() - start_wait_ts;
-      int sleep_timeout = event_timeout_wait_msec - work_time;
-      if (sleep_timeout && InRange<int>(sleep_timeout, 0, event_timeout_wait_msec)) {
-        SDL_Delay(sleep_timeout);
-      }
-    } else {  // some events
+    if (res > 0) {  // some events
       bool is_stop_event = event.type == FASTO_EVENT && event.user.data1 == NULL;
       if (is_stop_event) {
         break;
       }
 
       ProcessEvent(&event);
+      next_timer_ts = std::min(next_timer_ts, last_timer_ts + event_redraw_delay_msec);
+    }
+
+    common::time64_t cur_ts = common::time::current_mstime();
+    if (next_timer_ts - cur_ts > idle_timeout_wait_msec) {  // wall clock stepped back, don't wait for the step
+      next_timer_ts = cur_ts;
+    }
+    if (cur_ts >= next_timer_ts) {
+      events::TimerDeadline deadline(cur_ts + idle_timeout_wait_msec);
+      events::TimeInfo inf(&deadline);
+      events::TimerEvent* timer_event = new events::TimerEvent(this, inf);
+      HandleEvent(timer_event);
+      last_timer_ts = cur_ts;
+      next_timer_ts = deadline.GetTime();
+      cur_ts = common::time::current_mstime();
+    }
+
+    if (res <= 0 && next_timer_ts > cur_ts) {  // sleep until next deadline or incoming event
+      int sleep_timeout = next_timer_ts - cur_ts;
+      if (InRange<int>(sleep_timeout, 0, idle_timeout_wait_msec)) {
+        SDL_WaitEventTimeout(NULL, sleep_timeout);
+      }
     }
     SDL_PumpEvents();
   }
@@ -35,7 +35,10 @@ namespace application {
 
 class Sdl2Application : public common::application::IApplicationImpl {
  public:
-  enum { event_timeout_wait_msec = 1000 / 25 };
+  enum {
+    idle_timeout_wait_msec = 1000 / 4,   // timer interval if nobody asked for earlier one
+    event_redraw_delay_msec = 1000 / 100  // timer after handled events, coalesces bursts of events
+  };
   Sdl2Application(int argc, char** argv);
   ~Sdl2Application();
 
@@ -0,0 +1,298 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/audio_mix.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_MIX_SSE2 1
+#include <emmintrin.h>  // for SSE2
+#if defined(__GNUC__) || defined(__clang__)
+#define HAVE_MIX_AVX2 1
+#define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>  // for AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define HAVE_MIX_NEON 1
+#include <arm_neon.h>
+#endif
+
+extern "C" {
+#include <libavutil/cpu.h>  // for av_get_cpu_flags
+}
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+namespace {
+
+typedef void (*scale_s16_t)(int16_t* dst, const int16_t* src, size_t samples, int volume);
+typedef void (*scale_flt_t)(float* dst, const float* src, size_t samples, int volume);
+
+/*
+ * Reference arithmetic of SDL_MixAudioFormat into silence:
+ * s16 - product divided with truncation toward zero,
+ * flt - product rounded to float, then scaled by power of two, -0.0 + 0.0 gives +0.0
+ *       (older SDL rounds in double, results differ only for denormals).
+ */
+void scale_s16_c(int16_t* dst, const int16_t* src, size_t samples, int volume) {
+  for (size_t i = 0; i < samples; ++i) {
+    dst[i] = static_cast<int16_t>((src[i] * volume) / AUDIO_MIX_MAX_VOLUME);
+  }
+}
+
+void scale_flt_c(float* dst, const float* src, size_t samples, int volume) {
+  const float fvolume = static_cast<float>(volume);
+  const float fmaxvolume = 1.0f / AUDIO_MIX_MAX_VOLUME;
+  for (size_t i = 0; i < samples; ++i) {
+    dst[i] = (src[i] * fvolume) * fmaxvolume + 0.0f;
+  }
+}
+
+#if defined(HAVE_MIX_SSE2)
+inline __m128i div_mix_max_volume_sse2(__m128i prod) {
+  // arithmetic shift rounds toward minus infinity, bias negative values to truncate toward zero
+  const __m128i bias = _mm_and_si128(_mm_srai_epi32(prod, 31), _mm_set1_epi32(AUDIO_MIX_MAX_VOLUME - 1));
+  return _mm_srai_epi32(_mm_add_epi32(prod, bias), 7);
+}
+
+void scale_s16_sse2(int16_t* dst, const int16_t* src, size_t samples, int volume) {
+  const __m128i vol = _mm_set1_epi16(static_cast<int16_t>(volume));
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i lo = _mm_mullo_epi16(s, vol);
+    const __m128i hi = _mm_mulhi_epi16(s, vol);
+    const __m128i prod_lo = div_mix_max_volume_sse2(_mm_unpacklo_epi16(lo, hi));
+    const __m128i prod_hi = div_mix_max_volume_sse2(_mm_unpackhi_epi16(lo, hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(prod_lo, prod_hi));
+  }
+  scale_s16_c(dst + i, src + i, samples - i, volume);
+}
+
+void scale_flt_sse2(float* dst, const float* src, size_t samples, int volume) {
+  const __m128 fvolume = _mm_set1_ps(static_cast<float>(volume));
+  const __m128 fmaxvolume = _mm_set1_ps(1.0f / AUDIO_MIX_MAX_VOLUME);
+  const __m128 zero = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const __m128 s = _mm_loadu_ps(src + i);
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, fvolume), fmaxvolume), zero));
+  }
+  scale_flt_c(dst + i, src + i, samples - i, volume);
+}
+#endif
+
+#if defined(HAVE_MIX_AVX2)
+MIX_TARGET_AVX2 inline __m256i div_mix_max_volume_avx2(__m256i prod) {
+  const __m256i bias = _mm256_and_si256(_mm256_srai_epi32(prod, 31), _mm256_set1_epi32(AUDIO_MIX_MAX_VOLUME - 1));
+  return _mm256_srai_epi32(_mm256_add_epi32(prod, bias), 7);
+}
+
+MIX_TARGET_AVX2 void scale_s16_avx2(int16_t* dst, const int16_t* src, size_t samples, int volume) {
+  const __m256i vol = _mm256_set1_epi16(static_cast<int16_t>(volume));
+  size_t i = 0;
+  for (; i + 16 <= samples; i += 16) {
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i lo = _mm256_mullo_epi16(s, vol);
+    const __m256i hi = _mm256_mulhi_epi16(s, vol);
+    // unpack and pack work inside 128 bit lanes, so samples order is kept
+    const __m256i prod_lo = div_mix_max_volume_avx2(_mm256_unpacklo_epi16(lo, hi));
+    const __m256i prod_hi = div_mix_max_volume_avx2(_mm256_unpackhi_epi16(lo, hi));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packs_epi32(prod_lo, prod_hi));
+  }
+  scale_s16_sse2(dst + i, src + i, samples - i, volume);
+}
+
+MIX_TARGET_AVX2 void scale_flt_avx2(float* dst, const float* src, size_t samples, int volume) {
+  const __m256 fvolume = _mm256_set1_ps(static_cast<float>(volume));
+  const __m256 fmaxvolume = _mm256_set1_ps(1.0f / AUDIO_MIX_MAX_VOLUME);
+  const __m256 zero = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const __m256 s = _mm256_loadu_ps(src + i);
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, fvolume), fmaxvolume), zero));
+  }
+  scale_flt_sse2(dst + i, src + i, samples - i, volume);
+}
+#endif
+
+#if defined(HAVE_MIX_NEON)
+void scale_s16_neon(int16_t* dst, const int16_t* src, size_t samples, int volume) {
+  const int16x4_t vol = vdup_n_s16(static_cast<int16_t>(volume));
+  const int32x4_t max_volume_mask = vdupq_n_s32(AUDIO_MIX_MAX_VOLUME - 1);
+  size_t i = 0;
+  for (; i + 8 <= samples; i += 8) {
+    const int16x8_t s = vld1q_s16(src + i);
+    int32x4_t prod_lo = vmull_s16(vget_low_s16(s), vol);
+    int32x4_t prod_hi = vmull_s16(vget_high_s16(s), vol);
+    // bias negative values to truncate toward zero
+    prod_lo = vaddq_s32(prod_lo, vandq_s32(vshrq_n_s32(prod_lo, 31), max_volume_mask));
+    prod_hi = vaddq_s32(prod_hi, vandq_s32(vshrq_n_s32(prod_hi, 31), max_volume_mask));
+    vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vshrq_n_s32(prod_lo, 7)), vqmovn_s32(vshrq_n_s32(prod_hi, 7))));
+  }
+  scale_s16_c(dst + i, src + i, samples - i, volume);
+}
+
+void scale_flt_neon(float* dst, const float* src, size_t samples, int volume) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float fvolume = static_cast<float>(volume);
+  const float fmaxvolume = 1.0f / AUDIO_MIX_MAX_VOLUME;
+  size_t i = 0;
+  for (; i + 4 <= samples; i += 4) {
+    const float32x4_t s = vld1q_f32(src + i);
+    vst1q_f32(dst + i, vaddq_f32(vmulq_n_f32(vmulq_n_f32(s, fvolume), fmaxvolume), zero));
+  }
+  scale_flt_c(dst + i, src + i, samples - i, volume);
+}
+#endif
+
+struct ScaleKernels {
+  scale_s16_t s16;
+  scale_flt_t flt;
+};
+
+ScaleKernels GetScaleKernels(AudioMixKernel kernel) {
+  if (kernel == AUDIO_MIX_KERNEL_AUTO) {
+    kernel = GetBestAudioMixKernel();
+  } else if (!IsAudioMixKernelSupported(kernel)) {
+    kernel = AUDIO_MIX_KERNEL_C;
+  }
+
+#if defined(HAVE_MIX_AVX2)
+  if (kernel == AUDIO_MIX_KERNEL_AVX2) {
+    return {scale_s16_avx2, scale_flt_avx2};
+  }
+#endif
+#if defined(HAVE_MIX_SSE2)
+  if (kernel == AUDIO_MIX_KERNEL_SSE2) {
+    return {scale_s16_sse2, scale_flt_sse2};
+  }
+#endif
+#if defined(HAVE_MIX_NEON)
+  if (kernel == AUDIO_MIX_KERNEL_NEON) {
+    return {scale_s16_neon, scale_flt_neon};
+  }
+#endif
+  return {scale_s16_c, scale_flt_c};
+}
+
+const ScaleKernels& GetBestScaleKernels() {
+  static const ScaleKernels kernels = GetScaleKernels(GetBestAudioMixKernel());
+  return kernels;
+}
+
+}  // namespace
+
+bool IsAudioMixKernelSupported(AudioMixKernel kernel) {
+  switch (kernel) {
+    case AUDIO_MIX_KERNEL_AUTO:
+    case AUDIO_MIX_KERNEL_C:
+      return true;
+#if defined(HAVE_MIX_SSE2)
+    case AUDIO_MIX_KERNEL_SSE2:
+      return true;
+#endif
+#if defined(HAVE_MIX_AVX2)
+    case AUDIO_MIX_KERNEL_AVX2:
+      return av_get_cpu_flags() & AV_CPU_FLAG_AVX2;
+#endif
+#if defined(HAVE_MIX_NEON)
+    case AUDIO_MIX_KERNEL_NEON:
+      return av_get_cpu_flags() & AV_CPU_FLAG_NEON;
+#endif
+    default:
+      return false;
+  }
+}
+
+AudioMixKernel GetBestAudioMixKernel() {
+  static const AudioMixKernel kernels[] = {AUDIO_MIX_KERNEL_AVX2, AUDIO_MIX_KERNEL_NEON, AUDIO_MIX_KERNEL_SSE2};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i) {
+    if (IsAudioMixKernelSupported(kernels[i])) {
+      return kernels[i];
+    }
+  }
+
+  return AUDIO_MIX_KERNEL_C;
+}
+
+const char* ConvertAudioMixKernelToString(AudioMixKernel kernel) {
+  switch (kernel) {
+    case AUDIO_MIX_KERNEL_AUTO:
+      return "auto";
+    case AUDIO_MIX_KERNEL_C:
+      return "c";
+    case AUDIO_MIX_KERNEL_SSE2:
+      return "sse2";
+    case AUDIO_MIX_KERNEL_AVX2:
+      return "avx2";
+    case AUDIO_MIX_KERNEL_NEON:
+      return "neon";
+  }
+
+  return "unknown";
+}
+
+int ConvertToMixVolume(int volume) {
+  if (volume <= 0) {
+    return 0;
+  }
+  if (volume >= 100) {
+    return AUDIO_MIX_MAX_VOLUME;
+  }
+
+  return AUDIO_MIX_MAX_VOLUME * volume / 100;
+}
+
+void ScaleAudioS16(int16_t* dst, const int16_t* src, size_t samples, int volume, AudioMixKernel kernel) {
+  if (kernel == AUDIO_MIX_KERNEL_AUTO) {
+    GetBestScaleKernels().s16(dst, src, samples, volume);
+    return;
+  }
+
+  GetScaleKernels(kernel).s16(dst, src, samples, volume);
+}
+
+void ScaleAudioFlt(float* dst, const float* src, size_t samples, int volume, AudioMixKernel kernel) {
+  if (kernel == AUDIO_MIX_KERNEL_AUTO) {
+    GetBestScaleKernels().flt(dst, src, samples, volume);
+    return;
+  }
+
+  GetScaleKernels(kernel).flt(dst, src, samples, volume);
+}
+
+bool ScaleAudio(uint8_t* dst, const uint8_t* src, size_t len, AVSampleFormat fmt, int volume) {
+  if (fmt == AV_SAMPLE_FMT_S16) {
+    ScaleAudioS16(reinterpret_cast<int16_t*>(dst), reinterpret_cast<const int16_t*>(src), len / sizeof(int16_t),
+                  volume);
+    return true;
+  } else if (fmt == AV_SAMPLE_FMT_FLT) {
+    ScaleAudioFlt(reinterpret_cast<float*>(dst), reinterpret_cast<const float*>(src), len / sizeof(float), volume);
+    return true;
+  }
+
+  return false;
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
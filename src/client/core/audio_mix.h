@@ -0,0 +1,69 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for int16_t, uint8_t
+
+extern "C" {
+#include <libavutil/samplefmt.h>  // for AVSampleFormat
+}
+
+#define AUDIO_MIX_MAX_VOLUME 128  // same scale as SDL_MIX_MAXVOLUME
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+enum AudioMixKernel {
+  AUDIO_MIX_KERNEL_AUTO = 0,  // best one supported by cpu
+  AUDIO_MIX_KERNEL_C,
+  AUDIO_MIX_KERNEL_SSE2,
+  AUDIO_MIX_KERNEL_AVX2,
+  AUDIO_MIX_KERNEL_NEON
+};
+
+bool IsAudioMixKernelSupported(AudioMixKernel kernel);
+AudioMixKernel GetBestAudioMixKernel();
+const char* ConvertAudioMixKernelToString(AudioMixKernel kernel);
+
+// volume in percents [0, 100] to [0, AUDIO_MIX_MAX_VOLUME]
+int ConvertToMixVolume(int volume);
+
+/*
+ * dst = src * volume / AUDIO_MIX_MAX_VOLUME, dst can be equal to src.
+ * Output is bit exact with SDL_MixAudioFormat into silent buffer (float ones
+ * while result isn't denormal), so callback doesn't need to clear output before mixing.
+ * Unsupported kernel falls back to AUDIO_MIX_KERNEL_C.
+ */
+void ScaleAudioS16(int16_t* dst,
+                   const int16_t* src,
+                   size_t samples,
+                   int volume,
+                   AudioMixKernel kernel = AUDIO_MIX_KERNEL_AUTO);
+void ScaleAudioFlt(float* dst, const float* src, size_t samples, int volume, AudioMixKernel kernel = AUDIO_MIX_KERNEL_AUTO);
+
+// len in bytes, false if format isn't supported
+bool ScaleAudio(uint8_t* dst, const uint8_t* src, size_t len, AVSampleFormat fmt, int volume);
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
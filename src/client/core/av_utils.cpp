@@ -44,6 +44,15 @@ double q2d_diff(AVRational a) {
   return div * 1000.0;
 }
 
+clock64_t packet_clock(int64_t pts, int64_t dts, AVRational time_base) {
+  const int64_t ts = pts != AV_NOPTS_VALUE ? pts : dts;
+  if (ts == AV_NOPTS_VALUE) {
+    return invalid_clock();
+  }
+
+  return ts * q2d_diff(time_base);
+}
+
 AVRational guess_sample_aspect_ratio(AVStream* stream, AVFrame* frame) {
   AVRational undef = {0, 1};
   AVRational stream_sample_aspect_ratio = stream ? stream->sample_aspect_ratio : undef;
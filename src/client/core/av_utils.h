@@ -29,12 +29,16 @@ extern "C" {
 #include <libavutil/rational.h>    // for AVRational
 }
 
+#include "client/core/types.h"  // for clock64_t
+
 namespace fasto {
 namespace fastotv {
 namespace client {
 namespace core {
 
 double q2d_diff(AVRational a);
+// msec, pts or dts if pts is unknown, invalid_clock() without timestamps
+clock64_t packet_clock(int64_t pts, int64_t dts, AVRational time_base);
 
 AVRational guess_sample_aspect_ratio(AVStream* stream, AVFrame* frame);
 
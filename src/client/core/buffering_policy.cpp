@@ -0,0 +1,96 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/buffering_policy.h"
+
+#include <algorithm>  // for std::max
+
+#include <common/macros.h>  // for SIZEOFMASS
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+BufferWatermarks::BufferWatermarks() : low(0), high(0) {}
+
+BufferWatermarks::BufferWatermarks(clock64_t low, clock64_t high) : low(low), high(high) {}
+
+BufferWatermarks CalcBufferWatermarks(const AppOptions& opt, bool realtime) {
+  BufferWatermarks result = realtime ? BufferWatermarks(BUFFERING_LIVE_LOW_MSEC, BUFFERING_LIVE_HIGH_MSEC)
+                                     : BufferWatermarks(BUFFERING_VOD_LOW_MSEC, BUFFERING_VOD_HIGH_MSEC);
+  if (opt.buffer_low > 0) {
+    result.low = opt.buffer_low;
+  }
+  if (opt.buffer_high > 0) {
+    result.high = opt.buffer_high;
+  }
+  if (realtime && opt.live_latency > 0) {
+    // demuxed data is what keeps us behind live, stopping below target would fight latency controller
+    result.high = std::max(result.high, static_cast<clock64_t>(opt.live_latency) + result.low);
+  }
+  result.high = std::max(result.high, result.low);
+  return result;
+}
+
+BufferingPolicy::BufferingPolicy(const BufferWatermarks& watermarks) : watermarks_(watermarks), full_(false) {}
+
+bool BufferingPolicy::IsFull(clock64_t video_buffered, clock64_t audio_buffered, int64_t size) {
+  if (size > BUFFERING_MAX_SIZE) {
+    return true;
+  }
+
+  const clock64_t buffered[] = {video_buffered, audio_buffered};
+  bool measured = false;
+  bool above_high = true;
+  bool below_low = false;
+  for (size_t i = 0; i < SIZEOFMASS(buffered); ++i) {
+    if (!IsValidClock(buffered[i])) {
+      continue;
+    }
+
+    measured = true;
+    if (buffered[i] < watermarks_.high) {
+      above_high = false;
+    }
+    if (buffered[i] < watermarks_.low) {
+      below_low = true;
+    }
+  }
+
+  if (!measured) {  // only size limit works
+    full_ = false;
+    return false;
+  }
+
+  if (full_) {
+    full_ = !below_low;
+  } else {
+    full_ = above_high;
+  }
+  return full_;
+}
+
+BufferWatermarks BufferingPolicy::GetWatermarks() const {
+  return watermarks_;
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
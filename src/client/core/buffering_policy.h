@@ -0,0 +1,71 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>  // for int64_t
+
+#include "client/core/app_options.h"  // for AppOptions
+#include "client/core/types.h"        // for clock64_t
+
+#define BUFFERING_VOD_LOW_MSEC 2000
+#define BUFFERING_VOD_HIGH_MSEC 8000
+#define BUFFERING_LIVE_LOW_MSEC 1000
+#define BUFFERING_LIVE_HIGH_MSEC 4000
+#define BUFFERING_MAX_SIZE (64 * 1024 * 1024)  // bytes, safety net for packets without duration
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+struct BufferWatermarks {
+  BufferWatermarks();
+  BufferWatermarks(clock64_t low, clock64_t high);
+
+  clock64_t low;   // msec, reading resumes when some stream drained below
+  clock64_t high;  // msec, reading stops when all streams reached
+};
+
+// options or live/vod defaults, live high watermark always leaves room for latency target
+BufferWatermarks CalcBufferWatermarks(const AppOptions& opt, bool realtime);
+
+/*
+ * Decides when read thread has enough demuxed data,
+ * buffering is measured in msec of media per stream instead of bytes or packets.
+ * Reading stops once every measured stream reached high watermark
+ * and resumes when any of them drained below low watermark.
+ */
+class BufferingPolicy {
+ public:
+  explicit BufferingPolicy(const BufferWatermarks& watermarks);
+
+  // buffered msec per stream, invalid clock if stream is not used or its packets have no duration,
+  // size - bytes in both queues
+  bool IsFull(clock64_t video_buffered, clock64_t audio_buffered, int64_t size);
+  BufferWatermarks GetWatermarks() const;
+
+ private:
+  const BufferWatermarks watermarks_;
+  bool full_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
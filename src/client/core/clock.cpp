@@ -43,7 +43,7 @@ clock64_t Clock::GetPts() const {
 }
 
 clock64_t Clock::GetClock() const {
-  if (paused_) {
+  if (paused_ || !IsValidClock(pts_)) {
     return pts_;
   }
 
@@ -59,6 +59,21 @@ void Clock::SetPaused(bool paused) {
   paused_ = paused;
 }
 
+void Clock::SetSpeed(double speed) {
+  if (speed == speed_) {
+    return;
+  }
+
+  if (IsValidClock(pts_)) {
+    SetClock(GetClock());
+  }
+  speed_ = speed;
+}
+
+double Clock::GetSpeed() const {
+  return speed_;
+}
+
 }  // namespace core
 }  // namespace client
 }  // namespace fastotv
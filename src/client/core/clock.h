@@ -39,6 +39,10 @@ class Clock {
 
   void SetPaused(bool paused);
 
+  // playback rate, clock is rebased so that time already elapsed keeps the previous rate
+  void SetSpeed(double speed);
+  double GetSpeed() const;
+
  private:
   bool paused_;
   clock64_t pts_;       /* clock base */
@@ -29,14 +29,23 @@ extern "C" {
 #include <common/logger.h>  // for COMPACT_LOG_ERROR, COMPACT_LOG...
 #include <common/macros.h>  // for CHECK, NOTREACHED
 
+#include "client/core/av_utils.h"      // for packet_clock
 #include "client/core/packet_queue.h"  // for PacketQueue
+#include "client/core/trace.h"         // for TRACE_BEGIN, TRACE_END
 
 namespace fasto {
 namespace fastotv {
 namespace client {
 namespace core {
 
-Decoder::Decoder(AVCodecContext* avctx, PacketQueue* queue) : avctx_(avctx), queue_(queue), finished_(false) {
+Decoder::Decoder(AVCodecContext* avctx, PacketQueue* queue)
+    : avctx_(avctx),
+      queue_(queue),
+      finished_(false),
+      flushes_(0),
+      pending_packets_(),
+      pending_pos_(0),
+      pending_count_(0) {
   CHECK(queue);
 }
 
@@ -46,10 +55,12 @@ void Decoder::Start() {
 
 void Decoder::Abort() {
   queue_->Abort();
-  queue_->Flush();
 }
 
 Decoder::~Decoder() {
+  // decoder thread already joined, so we are the queue consumer now
+  DropPendingPackets();
+  queue_->Flush();
   avcodec_free_context(&avctx_);
 }
 
@@ -69,9 +80,40 @@ AVCodecContext* Decoder::GetAvCtx() const {
   return avctx_;
 }
 
+size_t Decoder::GetFlushesCount() const {
+  return flushes_;
+}
+
 void Decoder::Flush() {
+  DropPendingPackets();
   queue_->Flush();
   avcodec_flush_buffers(avctx_);
+  flushes_++;
+}
+
+bool Decoder::GetPacket(AVPacket* packet) {
+  if (queue_->IsAborted()) {
+    return false;
+  }
+
+  if (pending_pos_ == pending_count_ || queue_->IsFlushRequested()) {
+    DropPendingPackets();
+    pending_count_ = queue_->GetBatch(pending_packets_, packets_batch_size);
+    if (pending_count_ == 0) {
+      return false;
+    }
+  }
+
+  *packet = pending_packets_[pending_pos_++];
+  return true;
+}
+
+void Decoder::DropPendingPackets() {
+  for (size_t i = pending_pos_; i < pending_count_; ++i) {
+    av_packet_unref(&pending_packets_[i]);
+  }
+  pending_pos_ = 0;
+  pending_count_ = 0;
 }
 
 IFrameDecoder::IFrameDecoder(AVCodecContext* avctx, PacketQueue* queue) : Decoder(avctx, queue) {}
@@ -89,10 +131,13 @@ void AudioDecoder::SetStartPts(int64_t start_pts, AVRational start_pts_tb) {
 int AudioDecoder::DecodeFrame(AVFrame* frame) {
   int got_frame = 0;
   do {
+    TRACE_BEGIN(get_start);
     AVPacket packet;
-    if (!queue_->Get(&packet)) {
+    if (!GetPacket(&packet)) {
       return -1;
     }
+    TRACE_END(get_start, "audio", "packet_get",
+              packet_clock(packet.pts, packet.dts, av_codec_get_pkt_timebase(avctx_)));
 
     if (packet.data == NULL) {  // flush packet
       SetFinished(false);
@@ -100,7 +145,10 @@ int AudioDecoder::DecodeFrame(AVFrame* frame) {
       return 0;
     }
 
+    TRACE_BEGIN(decode_start);
+    const clock64_t codec_start = GetRealClockTime();
     int retcd = avcodec_send_packet(avctx_, &packet);
+    av_packet_unref(&packet);  // decoder keeps own reference
     if (retcd < 0) {
       if (retcd == AVERROR(EAGAIN)) {
         goto read;
@@ -130,13 +178,14 @@ int AudioDecoder::DecodeFrame(AVFrame* frame) {
     } else {
       WARNING_LOG() << "Invalid audio pts: " << frame->pts;
     }
+    TRACE_END(decode_start, "audio", "decode", packet_clock(frame->pts, AV_NOPTS_VALUE, tb));
     got_frame = 1;
   } while (!got_frame && !IsFinished());
 
   return got_frame;
 }
 
-VideoDecoder::VideoDecoder(AVCodecContext* avctx, PacketQueue* queue) : IFrameDecoder(avctx, queue) {
+VideoDecoder::VideoDecoder(AVCodecContext* avctx, PacketQueue* queue) : IFrameDecoder(avctx, queue), decode_time_(0) {
   CHECK(GetCodecType() == AVMEDIA_TYPE_VIDEO);
 }
 
@@ -148,13 +197,21 @@ int VideoDecoder::GetHeight() const {
   return avctx_->height;
 }
 
+clock64_t VideoDecoder::GetDecodeTime() const {
+  return decode_time_;
+}
+
 int VideoDecoder::DecodeFrame(AVFrame* frame) {
+  decode_time_ = 0;
   int got_frame = 0;
   do {
+    TRACE_BEGIN(get_start);
     AVPacket packet;
-    if (!queue_->Get(&packet)) {
+    if (!GetPacket(&packet)) {
       return -1;
     }
+    TRACE_END(get_start, "video", "packet_get",
+              packet_clock(packet.pts, packet.dts, av_codec_get_pkt_timebase(avctx_)));
 
     if (packet.data == NULL) {  // flush packet
       SetFinished(false);
@@ -162,7 +219,9 @@ int VideoDecoder::DecodeFrame(AVFrame* frame) {
       return 0;
     }
 
+    TRACE_BEGIN(decode_start);
     int retcd = avcodec_send_packet(avctx_, &packet);
+    av_packet_unref(&packet);  // decoder keeps own reference
     if (retcd < 0) {
       if (retcd == AVERROR(EAGAIN)) {
         goto read;
@@ -175,6 +234,7 @@ int VideoDecoder::DecodeFrame(AVFrame* frame) {
 
   read:
     retcd = avcodec_receive_frame(avctx_, frame);
+    decode_time_ += GetRealClockTime() - codec_start;
     if (retcd < 0) {
       if (retcd == AVERROR(EAGAIN)) {
         continue;
@@ -186,6 +246,8 @@ int VideoDecoder::DecodeFrame(AVFrame* frame) {
     }
 
     frame->pts = av_frame_get_best_effort_timestamp(frame);
+    TRACE_END(decode_start, "video", "decode",
+              packet_clock(frame->pts, AV_NOPTS_VALUE, av_codec_get_pkt_timebase(avctx_)));
     got_frame = 1;
   } while (!got_frame && !IsFinished());
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <stddef.h>  // for size_t
 #include <stdint.h>  // for int64_t
 
 extern "C" {
@@ -46,9 +47,13 @@ class Decoder {
 
   AVMediaType GetCodecType() const;
   AVCodecContext* GetAvCtx() const;
+  // flush packets handled so far, lets decoder thread owner notice seeks
+  size_t GetFlushesCount() const;
 
  protected:
   void Flush();
+  // packets are taken from queue by batches, return false if queue aborted
+  bool GetPacket(AVPacket* packet);
 
   Decoder(AVCodecContext* avctx, PacketQueue* queue);
 
@@ -56,7 +61,14 @@ class Decoder {
   PacketQueue* const queue_;
 
  private:
+  enum { packets_batch_size = 8 };
+  void DropPendingPackets();
+
   bool finished_;
+  size_t flushes_;
+  AVPacket pending_packets_[packets_batch_size];
+  size_t pending_pos_;
+  size_t pending_count_;
 };
 
 class IFrameDecoder : public Decoder {
@@ -83,8 +95,13 @@ class VideoDecoder : public IFrameDecoder {
 
   int GetWidth() const;
   int GetHeight() const;
+  // msec spent in codec by last DecodeFrame, waiting for packets excluded
+  clock64_t GetDecodeTime() const;
 
   int DecodeFrame(AVFrame* frame) override;
+
+ private:
+  clock64_t decode_time_;
 };
 }  // namespace core
 }  // namespace client
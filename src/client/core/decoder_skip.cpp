@@ -0,0 +1,121 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/decoder_skip.h"
+
+#include <math.h>  // for lround
+
+#define DECODER_SKIP_MAX_GAP_FRAMES 250  // larger pts gaps are discontinuities, not skipping
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+AVDiscard ConvertDecoderSkipLevelToDiscard(DECODER_SKIP_LEVEL level) {
+  if (level == DECODER_SKIP_NONREF) {
+    return AVDISCARD_NONREF;
+  } else if (level == DECODER_SKIP_BIDIR) {
+    return AVDISCARD_BIDIR;
+  } else if (level == DECODER_SKIP_NONKEY) {
+    return AVDISCARD_NONKEY;
+  }
+  return AVDISCARD_DEFAULT;
+}
+
+std::string ConvertDecoderSkipLevelToString(DECODER_SKIP_LEVEL level) {
+  if (level == DECODER_SKIP_NONREF) {
+    return "nonref";
+  } else if (level == DECODER_SKIP_BIDIR) {
+    return "bidir";
+  } else if (level == DECODER_SKIP_NONKEY) {
+    return "nonkey";
+  }
+  return "none";
+}
+
+DecoderSkipController::DecoderSkipController()
+    : level_(DECODER_SKIP_NONE),
+      overload_since_(invalid_clock()),
+      recover_since_(invalid_clock()),
+      last_pts_(invalid_clock()),
+      skipped_frames_(0) {}
+
+DECODER_SKIP_LEVEL DecoderSkipController::Update(clock64_t lag, clock64_t now) {
+  int level = level_;
+  if (!IsValidClock(lag)) {
+    return static_cast<DECODER_SKIP_LEVEL>(level);
+  }
+
+  if (lag > DECODER_SKIP_LAG_MSEC) {
+    recover_since_ = invalid_clock();
+    if (!IsValidClock(overload_since_)) {
+      overload_since_ = now;
+    } else if (now - overload_since_ >= DECODER_SKIP_ESCALATE_MSEC && level < DECODER_SKIP_NONKEY) {
+      level++;
+      overload_since_ = now;
+    }
+  } else if (lag < DECODER_SKIP_RECOVER_MSEC) {
+    overload_since_ = invalid_clock();
+    if (!IsValidClock(recover_since_)) {
+      recover_since_ = now;
+    } else if (now - recover_since_ >= DECODER_SKIP_BACKOFF_MSEC && level > DECODER_SKIP_NONE) {
+      level--;
+      recover_since_ = now;
+    }
+  } else {  // between thresholds, keep level but restart both periods
+    overload_since_ = invalid_clock();
+    recover_since_ = invalid_clock();
+  }
+
+  level_ = level;
+  return static_cast<DECODER_SKIP_LEVEL>(level);
+}
+
+void DecoderSkipController::RegisterFrame(clock64_t pts, clock64_t frame_duration) {
+  const clock64_t last_pts = last_pts_;
+  last_pts_ = pts;
+  if (level_ == DECODER_SKIP_NONE || !IsValidClock(last_pts) || !IsValidClock(pts) || frame_duration <= 0) {
+    return;
+  }
+
+  const long missing = lround(static_cast<double>(pts - last_pts) / frame_duration) - 1;
+  if (missing > 0 && missing < DECODER_SKIP_MAX_GAP_FRAMES) {
+    skipped_frames_ += missing;
+  }
+}
+
+void DecoderSkipController::Reset() {
+  level_ = DECODER_SKIP_NONE;
+  overload_since_ = invalid_clock();
+  recover_since_ = invalid_clock();
+  last_pts_ = invalid_clock();
+}
+
+DECODER_SKIP_LEVEL DecoderSkipController::GetLevel() const {
+  return static_cast<DECODER_SKIP_LEVEL>(level_.load());
+}
+
+size_t DecoderSkipController::GetSkippedFrames() const {
+  return skipped_frames_;
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,85 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <string>  // for string
+
+extern "C" {
+#include <libavcodec/avcodec.h>  // for AVDiscard
+}
+
+#include <common/threads/types.h>  // for atomic
+
+#include "client/core/types.h"  // for clock64_t
+
+#define DECODER_SKIP_LAG_MSEC 80        // video decoded this much after master clock means overload
+#define DECODER_SKIP_RECOVER_MSEC 20    // and this much means decoder keeps up again
+#define DECODER_SKIP_ESCALATE_MSEC 500  // overload period before the next skip level
+#define DECODER_SKIP_BACKOFF_MSEC 3000  // recovery period before the previous skip level
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+enum DECODER_SKIP_LEVEL {
+  DECODER_SKIP_NONE = 0,
+  DECODER_SKIP_NONREF = 1,  // non reference frames
+  DECODER_SKIP_BIDIR = 2,   // all B frames
+  DECODER_SKIP_NONKEY = 3   // everything except keyframes
+};
+
+// applied to both AVCodecContext::skip_frame and skip_loop_filter
+AVDiscard ConvertDecoderSkipLevelToDiscard(DECODER_SKIP_LEVEL level);
+std::string ConvertDecoderSkipLevelToString(DECODER_SKIP_LEVEL level);
+
+/*
+ * Escalates decoder skipping while decoded frames are late comparing to master clock,
+ * dropping decoded frames can't help when decoding itself is what can't keep up.
+ * Each level needs steady overload to escalate and longer steady recovery to back off.
+ * Update and RegisterFrame are called from video decoder thread, getters from anywhere.
+ */
+class DecoderSkipController {
+ public:
+  DecoderSkipController();
+
+  // lag - msec decoded frame is behind master clock, invalid if unknown; returns level decoder should use
+  DECODER_SKIP_LEVEL Update(clock64_t lag, clock64_t now);
+  // counts frames missing between consecutive pts while some level is active
+  void RegisterFrame(clock64_t pts, clock64_t frame_duration);
+  // after seek or stream switch, lag and pts measured before don't apply to new position
+  void Reset();
+
+  DECODER_SKIP_LEVEL GetLevel() const;
+  size_t GetSkippedFrames() const;
+
+ private:
+  common::atomic<int> level_;
+  clock64_t overload_since_;
+  clock64_t recover_since_;
+  clock64_t last_pts_;
+  common::atomic<size_t> skipped_frames_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,97 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/decoder_threading.h"
+
+#include <algorithm>  // for std::min, std::max
+
+#include <common/sprintf.h>  // for MemSPrintf
+
+extern "C" {
+#include <libavutil/cpu.h>  // for av_cpu_count
+}
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+namespace {
+// same as libavcodec threads=auto, small pictures are not capped since no measurement showed a gain of it
+int auto_thread_count() {
+  return std::min(std::max(av_cpu_count(), 1), DECODER_MAX_THREADS);
+}
+
+// frames which can be decoded in parallel without exceeding latency budget
+int max_frame_threads(const AppOptions& opt, AVRational frame_rate) {
+  if (opt.decoder_max_latency <= 0 || frame_rate.num <= 0 || frame_rate.den <= 0) {
+    return DECODER_MAX_THREADS;
+  }
+
+  const int64_t frames = static_cast<int64_t>(opt.decoder_max_latency) * frame_rate.num / (frame_rate.den * 1000);
+  return static_cast<int>(std::min<int64_t>(frames + 1, DECODER_MAX_THREADS));
+}
+}  // namespace
+
+DecoderThreading::DecoderThreading() : thread_count(1), thread_type(0) {}
+
+DecoderThreading::DecoderThreading(int thread_count, int thread_type)
+    : thread_count(thread_count), thread_type(thread_type) {}
+
+DecoderThreading CalcDecoderThreading(const AppOptions& opt, const AVCodec* codec, AVRational frame_rate) {
+  const bool frame_capable = codec && (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS);
+  const bool slice_capable = codec && (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS);
+  int count = opt.decoder_thread_count > 0 ? std::min(opt.decoder_thread_count, DECODER_MAX_THREADS)
+                                           : auto_thread_count();
+  if (count <= 1 || (!frame_capable && !slice_capable)) {
+    return DecoderThreading();
+  }
+
+  if (opt.decoder_thread_type == DECODER_THREAD_FRAME && frame_capable) {
+    return DecoderThreading(count, FF_THREAD_FRAME);
+  } else if (opt.decoder_thread_type == DECODER_THREAD_SLICE && slice_capable) {
+    return DecoderThreading(count, FF_THREAD_SLICE);
+  }
+
+  // auto or requested type not supported by codec
+  const int max_frame_count = max_frame_threads(opt, frame_rate);
+  if (frame_capable && (count <= max_frame_count || !slice_capable)) {
+    count = std::min(count, max_frame_count);
+    if (count <= 1) {
+      return DecoderThreading();
+    }
+    return DecoderThreading(count, FF_THREAD_FRAME);
+  }
+
+  return DecoderThreading(count, FF_THREAD_SLICE);
+}
+
+std::string ConvertDecoderThreadingToString(int thread_count, int thread_type) {
+  if (thread_type & FF_THREAD_FRAME) {
+    return common::MemSPrintf("%d FRAME", thread_count);
+  } else if (thread_type & FF_THREAD_SLICE) {
+    return common::MemSPrintf("%d SLICE", thread_count);
+  }
+
+  return "OFF";
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
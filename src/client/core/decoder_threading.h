@@ -0,0 +1,58 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>  // for string
+
+extern "C" {
+#include <libavcodec/avcodec.h>  // for AVCodec
+#include <libavutil/rational.h>  // for AVRational
+}
+
+#include "client/core/app_options.h"  // for AppOptions
+
+#define DECODER_MAX_THREADS 16  // libavcodec limit for threads=auto
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+struct DecoderThreading {
+  DecoderThreading();
+  DecoderThreading(int thread_count, int thread_type);
+
+  int thread_count;  // 1 - threading off
+  int thread_type;   // FF_THREAD_FRAME, FF_THREAD_SLICE
+};
+
+/*
+ * Frame threading scales with cores for any stream but delays output by
+ * (threads - 1) frames, slice threading adds no delay but scales only with
+ * slices/tiles of picture, so in auto mode frame threading is chosen unless
+ * its delay exceeds decoder_max_latency.
+ */
+DecoderThreading CalcDecoderThreading(const AppOptions& opt, const AVCodec* codec, AVRational frame_rate);
+
+std::string ConvertDecoderThreadingToString(int thread_count, int thread_type);
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
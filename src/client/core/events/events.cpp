@@ -26,7 +26,28 @@ namespace client {
 namespace core {
 namespace events {
 
-TimeInfo::TimeInfo() : time_millisecond(common::time::current_mstime()) {}
+TimerDeadline::TimerDeadline(common::time64_t deadline) : deadline_(deadline) {}
+
+void TimerDeadline::Request(common::time64_t ts) {
+  if (ts < deadline_) {
+    deadline_ = ts;
+  }
+}
+
+common::time64_t TimerDeadline::GetTime() const {
+  return deadline_;
+}
+
+TimeInfo::TimeInfo() : time_millisecond(common::time::current_mstime()), next_timer(NULL) {}
+
+TimeInfo::TimeInfo(TimerDeadline* next_timer)
+    : time_millisecond(common::time::current_mstime()), next_timer(next_timer) {}
+
+void TimeInfo::RequestNextTimer(common::time64_t ts) const {
+  if (next_timer) {
+    next_timer->Request(ts);
+  }
+}
 
 PreExecInfo::PreExecInfo(int code) : code(code) {}
 
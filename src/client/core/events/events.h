@@ -35,10 +35,26 @@ namespace client {
 namespace core {
 namespace events {
 
+// earliest time at which timer listeners want to be called again
+class TimerDeadline {
+ public:
+  explicit TimerDeadline(common::time64_t deadline);
+
+  void Request(common::time64_t ts);  // keeps the earliest one
+  common::time64_t GetTime() const;
+
+ private:
+  common::time64_t deadline_;
+};
+
 struct TimeInfo {
   TimeInfo();
+  explicit TimeInfo(TimerDeadline* next_timer);
+
+  void RequestNextTimer(common::time64_t ts) const;
 
   common::time64_t time_millisecond;
+  TimerDeadline* next_timer;  // NULL if sender ticks with fixed interval
 };
 
 struct QuitInfo {};
@@ -0,0 +1,197 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/frame_queue_policy.h"
+
+#if defined(OS_POSIX)
+#include <unistd.h>  // for sysconf
+#else
+#include <windows.h>  // for GlobalMemoryStatusEx
+#endif
+
+#include <algorithm>  // for std::min, std::max
+#include <cmath>      // for ceil
+
+extern "C" {
+#include <libavutil/imgutils.h>  // for av_image_get_buffer_size
+}
+
+#include <common/logger.h>  // for WARNING_LOG
+
+#include "client/core/av_utils.h"            // for q2d_diff
+#include "client/core/frames/ring_buffer.h"  // for RING_BUFFER_MIN_CAPACITY
+
+#define VIDEO_QUEUE_MEMORY_PART 8  // part of available memory which decoded pictures can take
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+namespace {
+size_t clamp_size(size_t value, size_t min_value, size_t max_value) {
+  return std::max(min_value, std::min(value, max_value));
+}
+
+size_t frames_for_msec(clock64_t msec, clock64_t frame_duration) {
+  if (frame_duration <= 0) {
+    return 0;
+  }
+
+  return static_cast<size_t>(std::ceil(static_cast<double>(msec) / static_cast<double>(frame_duration)));
+}
+
+// ring buffer preallocates every slot, so size from user is not trusted
+size_t fixed_queue_size(int user_size, size_t default_size, size_t min_size, size_t max_size, const char* name) {
+  if (user_size <= 0) {
+    return default_size;
+  }
+
+  const size_t size = static_cast<size_t>(user_size);
+  if (size < min_size) {
+    WARNING_LOG() << name << " queue size " << size << " clamped to " << min_size;
+    return min_size;
+  }
+  if (size > max_size) {
+    WARNING_LOG() << name << " queue size " << size << " clamped to " << max_size;
+    return max_size;
+  }
+  return size;
+}
+}  // namespace
+
+FrameQueueLimits::FrameQueueLimits() : min_size(0), initial_size(0), max_size(0) {}
+
+FrameQueueLimits::FrameQueueLimits(size_t min_size, size_t initial_size, size_t max_size)
+    : min_size(min_size), initial_size(initial_size), max_size(max_size) {}
+
+size_t GetAvailableMemory() {
+#if defined(OS_POSIX)
+#if defined(_SC_AVPHYS_PAGES)
+  long pages = sysconf(_SC_AVPHYS_PAGES);
+#else
+  long pages = sysconf(_SC_PHYS_PAGES);
+#endif
+  long page_size = sysconf(_SC_PAGESIZE);
+  if (pages <= 0 || page_size <= 0) {
+    return 0;
+  }
+  return static_cast<size_t>(pages) * static_cast<size_t>(page_size);
+#else
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if (!GlobalMemoryStatusEx(&status)) {
+    return 0;
+  }
+  return static_cast<size_t>(status.ullAvailPhys);
+#endif
+}
+
+FrameQueueLimits CalcVideoFrameQueueLimits(const AppOptions& opt,
+                                           int width,
+                                           int height,
+                                           AVPixelFormat pix_fmt,
+                                           AVRational frame_rate) {
+  if (opt.frame_queue_strategy == FRAME_QUEUE_FIXED) {
+    const size_t size = fixed_queue_size(opt.video_frame_queue_size, VIDEO_PICTURE_QUEUE_SIZE, VIDEO_PICTURE_QUEUE_SIZE,
+                                         VIDEO_PICTURE_QUEUE_MAX_SIZE, "Video");
+    return FrameQueueLimits(size, size, size);
+  }
+
+  size_t max_size = VIDEO_PICTURE_QUEUE_MAX_SIZE;
+  const size_t available = GetAvailableMemory();
+  if (available && width > 0 && height > 0) {
+    int frame_bytes = pix_fmt != AV_PIX_FMT_NONE ? av_image_get_buffer_size(pix_fmt, width, height, 1) : -1;
+    if (frame_bytes <= 0) {
+      frame_bytes = width * height * 3 / 2;  // yuv420p
+    }
+    const size_t by_memory = available / VIDEO_QUEUE_MEMORY_PART / static_cast<size_t>(frame_bytes);
+    max_size = clamp_size(by_memory, RING_BUFFER_MIN_CAPACITY, max_size);
+  }
+
+  const size_t min_size = std::min(static_cast<size_t>(VIDEO_PICTURE_QUEUE_SIZE), max_size);
+  size_t initial_size = min_size;
+  if (opt.video_frame_queue_size > 0) {
+    initial_size = opt.video_frame_queue_size;
+  } else if (frame_rate.num && frame_rate.den) {
+    AVRational fr = {frame_rate.den, frame_rate.num};
+    initial_size = frames_for_msec(FRAME_QUEUE_BUFFER_MSEC, q2d_diff(fr));
+  }
+  return FrameQueueLimits(min_size, clamp_size(initial_size, min_size, max_size), max_size);
+}
+
+FrameQueueLimits CalcAudioFrameQueueLimits(const AppOptions& opt, int sample_rate, int frame_size) {
+  if (opt.frame_queue_strategy == FRAME_QUEUE_FIXED) {
+    const size_t size = fixed_queue_size(opt.audio_frame_queue_size, SAMPLE_QUEUE_SIZE, RING_BUFFER_MIN_CAPACITY,
+                                         SAMPLE_QUEUE_MAX_SIZE, "Audio");
+    return FrameQueueLimits(size, size, size);
+  }
+
+  size_t initial_size = SAMPLE_QUEUE_SIZE;
+  if (opt.audio_frame_queue_size > 0) {
+    initial_size = opt.audio_frame_queue_size;
+  } else if (sample_rate > 0 && frame_size > 0) {
+    const clock64_t frame_duration = static_cast<clock64_t>(frame_size) * 1000 / sample_rate;
+    initial_size = frames_for_msec(FRAME_QUEUE_BUFFER_MSEC * 2, frame_duration);
+  }
+  initial_size = clamp_size(initial_size, SAMPLE_QUEUE_SIZE, SAMPLE_QUEUE_MAX_SIZE);
+  return FrameQueueLimits(initial_size, initial_size, initial_size);
+}
+
+FrameQueueAdapter::FrameQueueAdapter(const FrameQueueLimits& limits)
+    : limits_(limits), capacity_(limits.initial_size), jitter_(0), frames_since_change_(0) {}
+
+size_t FrameQueueAdapter::RegisterFrame(clock64_t decode_time, clock64_t frame_duration) {
+  if (frame_duration <= 0 || limits_.min_size == limits_.max_size) {
+    return capacity_;
+  }
+
+  // peak follower: jumps to new lateness, decays slowly
+  const double late = static_cast<double>(std::max(decode_time - frame_duration, static_cast<clock64_t>(0)));
+  if (late > jitter_) {
+    jitter_ = late;
+  } else {
+    jitter_ -= (jitter_ - late) / 64;
+  }
+
+  frames_since_change_++;
+  const size_t wanted =
+      clamp_size(frames_for_msec(static_cast<clock64_t>(jitter_) + FRAME_QUEUE_BUFFER_MSEC, frame_duration),
+                 limits_.min_size, limits_.max_size);
+  if (wanted > capacity_) {
+    capacity_ = wanted;
+    frames_since_change_ = 0;
+  } else if (wanted < capacity_ && frames_since_change_ >= shrink_after_frames) {
+    capacity_--;
+    frames_since_change_ = 0;
+  }
+  return capacity_;
+}
+
+size_t FrameQueueAdapter::GetCapacity() const {
+  return capacity_;
+}
+
+clock64_t FrameQueueAdapter::GetJitter() const {
+  return static_cast<clock64_t>(jitter_);
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,86 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+extern "C" {
+#include <libavutil/pixfmt.h>    // for AVPixelFormat
+#include <libavutil/rational.h>  // for AVRational
+}
+
+#include "client/core/app_options.h"  // for AppOptions
+#include "client/core/types.h"        // for clock64_t
+
+#define VIDEO_PICTURE_QUEUE_SIZE 3  // fixed strategy default and adaptive minimum
+#define VIDEO_PICTURE_QUEUE_MAX_SIZE 16
+#define SAMPLE_QUEUE_SIZE 9
+#define SAMPLE_QUEUE_MAX_SIZE 64
+#define FRAME_QUEUE_BUFFER_MSEC 100  // decoded data which should be ready on steady stream
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+struct FrameQueueLimits {
+  FrameQueueLimits();
+  FrameQueueLimits(size_t min_size, size_t initial_size, size_t max_size);
+
+  size_t min_size;
+  size_t initial_size;
+  size_t max_size;
+};
+
+// bytes, 0 if unknown
+size_t GetAvailableMemory();
+
+FrameQueueLimits CalcVideoFrameQueueLimits(const AppOptions& opt,
+                                           int width,
+                                           int height,
+                                           AVPixelFormat pix_fmt,
+                                           AVRational frame_rate);
+FrameQueueLimits CalcAudioFrameQueueLimits(const AppOptions& opt, int sample_rate, int frame_size);
+
+/*
+ * Tracks how much longer than frame duration decoding of a frame takes
+ * and recommends queue capacity which covers that jitter.
+ * Grows immediately, shrinks by one frame after steady period.
+ */
+class FrameQueueAdapter {
+ public:
+  enum { shrink_after_frames = 50 };
+
+  explicit FrameQueueAdapter(const FrameQueueLimits& limits);
+
+  size_t RegisterFrame(clock64_t decode_time, clock64_t frame_duration);
+  size_t GetCapacity() const;
+  clock64_t GetJitter() const;
+
+ private:
+  const FrameQueueLimits limits_;
+  size_t capacity_;
+  double jitter_;  // msec
+  size_t frames_since_change_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
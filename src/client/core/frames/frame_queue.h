@@ -20,7 +20,9 @@
 
 #include <stdint.h>  // for int64_t
 
+#include "client/core/frames/audio_frame.h"  // for AudioFrame
 #include "client/core/frames/ring_buffer.h"  // for RingBuffer
+#include "client/core/frames/video_frame.h"  // for VideoFrame
 
 namespace fasto {
 namespace fastotv {
@@ -28,15 +30,14 @@ namespace client {
 namespace core {
 namespace frames {
 
-struct AudioFrame;
-struct VideoFrame;
-
-template <typename T, size_t buffer_size>
-class BaseFrameQueue : public RingBuffer<T, buffer_size> {
+template <typename T>
+class BaseFrameQueue : public RingBuffer<T> {
  public:
-  typedef RingBuffer<T, buffer_size> base_class;
+  typedef RingBuffer<T> base_class;
   typedef typename base_class::pointer_type pointer_type;
 
+  BaseFrameQueue(size_t max_capacity, size_t capacity) : base_class(max_capacity, capacity) {}
+
   void Pop() {
     pointer_type fp = base_class::MoveToNext();
     if (!fp) {
@@ -57,18 +58,20 @@ class BaseFrameQueue : public RingBuffer<T, buffer_size> {
   }
 };
 
-template <size_t buffer_size>
-class VideoFrameQueue : public BaseFrameQueue<frames::VideoFrame, buffer_size> {
+class VideoFrameQueue : public BaseFrameQueue<frames::VideoFrame> {
  public:
-  typedef BaseFrameQueue<frames::VideoFrame, buffer_size> base_class;
-  typedef typename base_class::pointer_type pointer_type;
+  typedef BaseFrameQueue<frames::VideoFrame> base_class;
+  typedef base_class::pointer_type pointer_type;
+
+  VideoFrameQueue(size_t max_capacity, size_t capacity) : base_class(max_capacity, capacity) {}
 };
 
-template <size_t buffer_size>
-class AudioFrameQueue : public BaseFrameQueue<frames::AudioFrame, buffer_size> {
+class AudioFrameQueue : public BaseFrameQueue<frames::AudioFrame> {
  public:
-  typedef BaseFrameQueue<frames::AudioFrame, buffer_size> base_class;
-  typedef typename base_class::pointer_type pointer_type;
+  typedef BaseFrameQueue<frames::AudioFrame> base_class;
+  typedef base_class::pointer_type pointer_type;
+
+  AudioFrameQueue(size_t max_capacity, size_t capacity) : base_class(max_capacity, capacity) {}
 };
 
 }  // namespace frames
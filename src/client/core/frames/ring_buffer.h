@@ -23,65 +23,96 @@
 #include <common/threads/types.h>  // for condition_variable, mutex
 #include <common/types.h>
 
+#define RING_BUFFER_MIN_CAPACITY 2  // last shown frame stays in ring, so one slot is never writable
+
 namespace fasto {
 namespace fastotv {
 namespace client {
 namespace core {
 namespace frames {
 
-template <typename T, size_t buffer_size>
+/*
+ * Single producer/single consumer ring of preallocated frames.
+ * Indexes are monotonic counters, slot is counter % max_capacity,
+ * mutex and condition variable used only for parking when ring is full or empty.
+ * Capacity can be changed at runtime in range [RING_BUFFER_MIN_CAPACITY, max_capacity].
+ */
+template <typename T>
 class RingBuffer {
  public:
   typedef T* pointer_type;
 
-  RingBuffer()
-      : queue_cond_(), queue_mutex_(), queue_(), rindex_shown_(0), rindex_(0), windex_(0), size_(0), stoped_(false) {
-    for (size_t i = 0; i < buffer_size; i++) {
+  RingBuffer(size_t max_capacity, size_t capacity)
+      : max_capacity_(max_capacity < RING_BUFFER_MIN_CAPACITY ? RING_BUFFER_MIN_CAPACITY : max_capacity),
+        queue_(new pointer_type[max_capacity_]),
+        capacity_(stable_capacity(capacity)),
+        rindex_(0),
+        rindex_shown_(0),
+        windex_(0),
+        stoped_(false),
+        reader_waiting_(false),
+        writer_waiting_(false),
+        queue_cond_(),
+        queue_mutex_() {
+    for (size_t i = 0; i < max_capacity_; i++) {
       queue_[i] = new T;
     }
   }
 
   ~RingBuffer() {
-    for (size_t i = 0; i < buffer_size; i++) {
+    for (size_t i = 0; i < max_capacity_; i++) {
       delete queue_[i];
     }
+    delete[] queue_;
   }
 
-  bool IsStoped() {
-    lock_t lock(queue_mutex_);
-    return stoped_;
+  size_t GetMaxCapacity() const { return max_capacity_; }
+  size_t GetCapacity() const { return capacity_; }
+
+  // frames already queued above new capacity stay until consumed
+  void SetCapacity(size_t capacity) {
+    capacity_ = stable_capacity(capacity);
+    Signal();
   }
 
+  size_t Size() const { return windex_.load() - rindex_.load(); }
+
+  bool IsStoped() const { return stoped_; }
+
   pointer_type GetPeekReadable() {
     /* wait until we have a readable a new frame */
-    {
+    if (IsEmpty() && !stoped_) {
       lock_t lock(queue_mutex_);
+      reader_waiting_ = true;
       while (IsEmpty() && !stoped_) {
         queue_cond_.wait(lock);
       }
+      reader_waiting_ = false;
+    }
 
-      if (stoped_) {
-        return nullptr;
-      }
+    if (stoped_) {
+      return nullptr;
     }
 
-    return queue_[(rindex_ + rindex_shown_) % buffer_size];
+    return Peek();
   }
 
   pointer_type GetPeekWritable() {
     /* wait until we have space to put a new frame */
-    {
+    if (IsFull() && !stoped_) {
       lock_t lock(queue_mutex_);
+      writer_waiting_ = true;
       while (IsFull() && !stoped_) {
         queue_cond_.wait(lock);
       }
+      writer_waiting_ = false;
+    }
 
-      if (stoped_) {
-        return nullptr;
-      }
+    if (stoped_) {
+      return nullptr;
     }
 
-    return queue_[windex_];
+    return queue_[windex_.load(std::memory_order_relaxed) % max_capacity_];
   }
 
   void Push() {
@@ -89,68 +120,84 @@ class RingBuffer {
     Signal();
   }
 
+  // wakes up other side, only if it is parked
   void Signal() {
-    lock_t lock(queue_mutex_);
-    queue_cond_.notify_one();
+    if (reader_waiting_ || writer_waiting_) {
+      lock_t lock(queue_mutex_);
+      queue_cond_.notify_all();
+    }
   }
 
   void Stop() {
     lock_t lock(queue_mutex_);
     stoped_ = true;
-    queue_cond_.notify_one();
+    queue_cond_.notify_all();
   }
 
-  pointer_type PeekLast() const { return queue_[rindex_]; }
+  pointer_type PeekLast() const { return queue_[rindex_.load(std::memory_order_relaxed) % max_capacity_]; }
 
-  pointer_type Peek() const { return queue_[(rindex_ + rindex_shown_) % buffer_size]; }
+  pointer_type Peek() const {
+    return queue_[(rindex_.load(std::memory_order_relaxed) + rindex_shown_.load(std::memory_order_relaxed)) %
+                  max_capacity_];
+  }
 
   pointer_type PeekNextOrNull() const {
-    if (IsEmpty()) {
+    if (Remaining() <= 1) {
       return nullptr;
     }
-    return queue_[(rindex_ + rindex_shown_ + 1) % buffer_size];
+    return queue_[(rindex_.load(std::memory_order_relaxed) + rindex_shown_.load(std::memory_order_relaxed) + 1) %
+                  max_capacity_];
   }
 
-  bool IsEmpty() const { return size_ - rindex_shown_ <= 0; }
-  bool IsFull() const { return size_ >= buffer_size; }
+  bool IsEmpty() const { return Remaining() == 0; }
+  bool IsFull() const { return Size() >= capacity_; }
 
-  size_t RindexShown() const { return rindex_shown_; }
+  size_t RindexShown() const { return rindex_shown_.load(std::memory_order_relaxed); }
 
  protected:
-  pointer_type MoveToNext() const {
-    if (!rindex_shown_) {
-      rindex_shown_ = 1;
+  pointer_type MoveToNext() {
+    if (!rindex_shown_.load(std::memory_order_relaxed)) {
+      rindex_shown_.store(1, std::memory_order_relaxed);
       return nullptr;
     }
 
     return PeekLast();
   }
 
-  void RindexUpInner() {
-    if (++rindex_ == buffer_size) {
-      rindex_ = 0;
+  void RindexUpInner() { rindex_.store(rindex_.load(std::memory_order_relaxed) + 1); }
+
+  void WindexUpInner() { windex_.store(windex_.load(std::memory_order_relaxed) + 1); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(RingBuffer);
+
+  size_t stable_capacity(size_t capacity) const {
+    if (capacity < RING_BUFFER_MIN_CAPACITY) {
+      return RING_BUFFER_MIN_CAPACITY;
     }
-    size_--;
+    return capacity > max_capacity_ ? max_capacity_ : capacity;
   }
 
-  void WindexUpInner() {
-    if (++windex_ == buffer_size) {
-      windex_ = 0;
-    }
-    size_++;
+  // not shown frames
+  size_t Remaining() const {
+    const size_t size = Size();
+    const size_t shown = rindex_shown_.load(std::memory_order_relaxed);
+    return size > shown ? size - shown : 0;
   }
 
- private:
   typedef common::unique_lock<common::mutex> lock_t;
+
+  const size_t max_capacity_;
+  pointer_type* const queue_;
+  common::atomic<size_t> capacity_;
+  alignas(64) common::atomic<size_t> rindex_;  // owned by reader
+  common::atomic<size_t> rindex_shown_;        // owned by reader
+  alignas(64) common::atomic<size_t> windex_;  // owned by writer
+  alignas(64) common::atomic<bool> stoped_;
+  common::atomic<bool> reader_waiting_;
+  common::atomic<bool> writer_waiting_;
   common::condition_variable queue_cond_;
   common::mutex queue_mutex_;
-
-  pointer_type queue_[buffer_size];
-  mutable size_t rindex_shown_;  // in mostly const
-  size_t rindex_;
-  common::atomic<size_t> windex_;
-  common::atomic<size_t> size_;
-  bool stoped_;
 };
 
 }  // namespace frames
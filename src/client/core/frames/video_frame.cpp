@@ -24,7 +24,7 @@ namespace client {
 namespace core {
 namespace frames {
 
-VideoFrame::VideoFrame() : BaseFrame(), width(0), height(0), format(AV_PIX_FMT_NONE), sar{0, 0} {}
+VideoFrame::VideoFrame() : BaseFrame(), width(0), height(0), format(AV_PIX_FMT_NONE), sar{0, 0}, picture_id(0) {}
 
 clock64_t CalcDurationBetweenVideoFrames(VideoFrame* vp, VideoFrame* nextvp, clock64_t max_frame_duration) {
   clock64_t duration = nextvp->pts - vp->pts;
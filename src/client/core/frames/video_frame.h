@@ -34,6 +34,7 @@ struct VideoFrame : public BaseFrame {
   int height;
   AVPixelFormat format;  // pixel format in mostly AV_PIX_FMT_YUV420P
   AVRational sar;        // aspect ratio
+  uint64_t picture_id;   // unique for every queued picture, renderer skips upload of already shown one
 
  private:
   DISALLOW_COPY_AND_ASSIGN(VideoFrame);
@@ -0,0 +1,126 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/latency_controller.h"
+
+#include <algorithm>  // for std::min, std::max
+#include <cstdlib>    // for std::abs
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+LatencyController::LatencyController(clock64_t target)
+    : target_(target),
+      tolerance_(std::max(target / 10, static_cast<clock64_t>(LIVE_LATENCY_MIN_TOLERANCE_MSEC))),
+      jump_threshold_(target + std::max(target, static_cast<clock64_t>(LIVE_LATENCY_MIN_JUMP_MSEC))),
+      latency_avg_(0),
+      last_update_(invalid_clock()),
+      settle_until_(0),
+      correcting_(false),
+      latency_(invalid_clock()),
+      speed_(1.0),
+      jump_request_(false),
+      reset_request_(true),
+      jumps_(0) {}
+
+double LatencyController::Update(clock64_t latency, clock64_t now) {
+  if (reset_request_.exchange(false)) {
+    Reset(now);
+  }
+
+  if (!IsValidClock(latency) || std::abs(latency) > LIVE_LATENCY_NOSYNC_MSEC) {
+    Reset(now);
+    return speed_;
+  }
+
+  if (!IsValidClock(last_update_)) {
+    latency_avg_ = latency;
+  } else {
+    const double dt = static_cast<double>(std::max(now - last_update_, static_cast<clock64_t>(0)));
+    latency_avg_ += (latency - latency_avg_) * dt / (LIVE_LATENCY_SMOOTH_MSEC + dt);
+  }
+  last_update_ = now;
+  latency_ = static_cast<clock64_t>(latency_avg_);
+
+  if (now >= settle_until_ && latency_avg_ > jump_threshold_) {
+    jump_request_ = true;
+  }
+
+  // hysteresis: correction starts out of tolerance and stops close to the target
+  const double error = latency_avg_ - target_;
+  if (std::abs(error) > tolerance_) {
+    correcting_ = true;
+  } else if (std::abs(error) < tolerance_ / 4) {
+    correcting_ = false;
+  }
+
+  double speed = 1.0;
+  if (correcting_) {
+    speed = 1.0 + error / LIVE_LATENCY_CONVERGE_MSEC * (LIVE_LATENCY_MAX_SPEED - 1.0);
+    speed = std::max(LIVE_LATENCY_MIN_SPEED, std::min(speed, LIVE_LATENCY_MAX_SPEED));
+  }
+  speed_ = speed;
+  return speed;
+}
+
+bool LatencyController::IsJumpRequested() const {
+  return jump_request_;
+}
+
+bool LatencyController::TakeJumpRequest() {
+  if (!jump_request_.exchange(false)) {
+    return false;
+  }
+
+  reset_request_ = true;
+  jumps_++;
+  return true;
+}
+
+clock64_t LatencyController::GetTarget() const {
+  return target_;
+}
+
+clock64_t LatencyController::GetLatency() const {
+  return latency_;
+}
+
+double LatencyController::GetSpeed() const {
+  return speed_;
+}
+
+size_t LatencyController::GetJumpsCount() const {
+  return jumps_;
+}
+
+void LatencyController::Reset(clock64_t now) {
+  latency_avg_ = 0;
+  last_update_ = invalid_clock();
+  settle_until_ = now + LIVE_LATENCY_SETTLE_MSEC;
+  correcting_ = false;
+  latency_ = invalid_clock();
+  jump_request_ = false;
+  speed_ = 1.0;
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
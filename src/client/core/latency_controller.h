@@ -0,0 +1,85 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <common/macros.h>         // for DISALLOW_COPY_AND_ASSIGN
+#include <common/threads/types.h>  // for atomic
+
+#include "client/core/types.h"  // for clock64_t
+
+#define LIVE_LATENCY_MIN_SPEED 0.95
+#define LIVE_LATENCY_MAX_SPEED 1.05
+#define LIVE_LATENCY_SMOOTH_MSEC 500
+#define LIVE_LATENCY_MIN_TOLERANCE_MSEC 40
+#define LIVE_LATENCY_CONVERGE_MSEC 1000  // error which gets max speed change
+#define LIVE_LATENCY_MIN_JUMP_MSEC 3000  // minimal distance over target before jump to live edge
+#define LIVE_LATENCY_SETTLE_MSEC 2000    // no jumps while measurement is not stable
+#define LIVE_LATENCY_NOSYNC_MSEC 60000   // timestamps discontinuity, measurement restarts
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+/*
+ * Keeps realtime stream playback at target distance behind the live edge.
+ * Latency (last demuxed pts minus master clock) is smoothed and mapped to playback speed
+ * in [LIVE_LATENCY_MIN_SPEED, LIVE_LATENCY_MAX_SPEED], far behind target a jump is requested.
+ * Update is called from master clock thread, TakeJumpRequest from read thread, getters from anywhere.
+ */
+class LatencyController {
+ public:
+  explicit LatencyController(clock64_t target);
+
+  double Update(clock64_t latency, clock64_t now);  // returns playback speed
+  bool TakeJumpRequest();                           // measurement restarts after jump
+  bool IsJumpRequested() const;
+
+  clock64_t GetTarget() const;
+  clock64_t GetLatency() const;  // smoothed, invalid until measured
+  double GetSpeed() const;
+  size_t GetJumpsCount() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LatencyController);
+
+  void Reset(clock64_t now);
+
+  const clock64_t target_;
+  const clock64_t tolerance_;
+  const clock64_t jump_threshold_;
+
+  double latency_avg_;
+  clock64_t last_update_;
+  clock64_t settle_until_;
+  bool correcting_;
+
+  common::atomic<clock64_t> latency_;
+  common::atomic<double> speed_;
+  common::atomic<bool> jump_request_;
+  common::atomic<bool> reset_request_;
+  common::atomic<size_t> jumps_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
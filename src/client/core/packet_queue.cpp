@@ -20,20 +20,63 @@
 
 #include <stddef.h>  // for NULL
 
+#include <algorithm>  // for std::min
+
+#include <common/macros.h>  // for DCHECK
+
+#include "client/core/wakeup_event.h"  // for WakeupEvent
+
 namespace fasto {
 namespace fastotv {
 namespace client {
 namespace core {
 
-PacketQueue::PacketQueue() : queue_(), size_(0), duration_(0), abort_request_(true), cond_(), mutex_() {}
+namespace {
+size_t round_up_to_power_of_two(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+}  // namespace
+
+PacketQueue::PacketQueue(size_t capacity)
+    : capacity_(round_up_to_power_of_two(capacity)),
+      mask_(capacity_ - 1),
+      packets_(new AVPacket[capacity_]),
+      head_(0),
+      cached_tail_(0),
+      popped_size_(0),
+      popped_duration_(0),
+      tail_(0),
+      cached_head_(0),
+      pushed_size_(0),
+      pushed_duration_(0),
+      abort_request_(true),
+      flush_request_(false),
+      flush_stream_index_(-1),
+      flush_tail_(0),
+      flush_until_(0),
+      flush_taken_(false),
+      consumer_waiting_(false),
+      producer_waiting_(false),
+      drain_wakeup_(NULL),
+      drain_duration_(0),
+      mutex_(),
+      readable_cond_(),
+      writable_cond_() {}
 
 int PacketQueue::PutNullpacket(int stream_index) {
-  AVPacket pkt1, *pkt = &pkt1;
-  av_init_packet(pkt);
-  pkt->data = NULL;
-  pkt->size = 0;
-  pkt->stream_index = stream_index;
-  return PushFront(pkt);
+  if (abort_request_) {
+    return -1;
+  }
+
+  flush_stream_index_ = stream_index;
+  flush_tail_ = tail_.load(std::memory_order_relaxed);
+  flush_request_ = true;
+  NotifyReadable();
+  return 0;
 }
 
 bool PacketQueue::Get(AVPacket* pkt) {
@@ -41,96 +84,222 @@ bool PacketQueue::Get(AVPacket* pkt) {
     return false;
   }
 
-  lock_t lock(mutex_);
-  while (queue_.empty() && !abort_request_) {
-    cond_.wait(lock);
+  return GetBatch(pkt, 1) == 1;
+}
+
+size_t PacketQueue::GetBatch(AVPacket* pkts, size_t max_count) {
+  if (!pkts || max_count == 0) {
+    return 0;
   }
-  if (abort_request_) {
-    return false;
+
+  if (!WaitReadable()) {
+    return 0;
   }
 
-  *pkt = queue_[0];
-  queue_.pop_front();
-  size_ -= pkt->size;
-  duration_ -= pkt->duration;
-  return true;
+  // checked after WaitReadable loaded tail, so packets queued behind the flush packet are never returned before it
+  if (TakeFlushRequest(pkts)) {
+    return 1;
+  }
+
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (cached_tail_ == head) {
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+  }
+  const size_t count = std::min(cached_tail_ - head, max_count);
+  DCHECK(count);
+  int64_t bytes = 0;
+  int64_t duration = 0;
+  for (size_t i = 0; i < count; ++i) {
+    pkts[i] = packets_[(head + i) & mask_];
+    bytes += pkts[i].size;
+    duration += pkts[i].duration;
+  }
+  popped_size_.store(popped_size_.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+  popped_duration_.store(popped_duration_.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+  head_.store(head + count);
+  NotifyWritable();
+  NotifyDrained();
+  return count;
 }
 
-bool PacketQueue::IsAborted() {
-  lock_t lock(mutex_);
+bool PacketQueue::IsAborted() const {
   return abort_request_;
 }
 
-size_t PacketQueue::GetNbPackets() {
-  lock_t lock(mutex_);
-  return queue_.size();
+bool PacketQueue::IsFlushRequested() const {
+  return flush_request_;
 }
 
-int PacketQueue::GetSize() const {
-  return size_;
+size_t PacketQueue::GetNbPackets() const {
+  const size_t head = head_.load(std::memory_order_acquire);
+  const size_t tail = tail_.load(std::memory_order_acquire);
+  return tail - head;
+}
+
+size_t PacketQueue::GetCapacity() const {
+  return capacity_;
+}
+
+int64_t PacketQueue::GetSize() const {
+  return static_cast<int64_t>(pushed_size_.load(std::memory_order_relaxed) -
+                              popped_size_.load(std::memory_order_relaxed));
 }
 
 int64_t PacketQueue::GetDuration() const {
-  return duration_;
+  return pushed_duration_.load(std::memory_order_relaxed) - popped_duration_.load(std::memory_order_relaxed);
+}
+
+void PacketQueue::SetDrainWakeup(WakeupEvent* wakeup, int64_t low_duration) {
+  drain_duration_ = low_duration;
+  drain_wakeup_ = wakeup;
 }
 
 void PacketQueue::Start() {
   lock_t lock(mutex_);
   abort_request_ = false;
-  cond_.notify_one();
+  readable_cond_.notify_all();
+  writable_cond_.notify_all();
 }
 
 int PacketQueue::Put(AVPacket* pkt) {
-  return PushBack(pkt);
-}
-
-int PacketQueue::PushFront(AVPacket* pkt) {
-  lock_t lock(mutex_);
-  if (abort_request_) {
+  if (!WaitWritable()) {
     av_packet_unref(pkt);
     return -1;
   }
 
-  queue_.push_front(*pkt);
-  size_ += pkt->size;
-  duration_ += pkt->duration;
-  cond_.notify_one();
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  packets_[tail & mask_] = *pkt;
+  pushed_size_.store(pushed_size_.load(std::memory_order_relaxed) + pkt->size, std::memory_order_relaxed);
+  pushed_duration_.store(pushed_duration_.load(std::memory_order_relaxed) + pkt->duration, std::memory_order_relaxed);
+  tail_.store(tail + 1);
+  NotifyReadable();
   return 0;
 }
 
-int PacketQueue::PushBack(AVPacket* pkt) {
-  lock_t lock(mutex_);
-  if (abort_request_) {
+void PacketQueue::Flush() {
+  size_t head = head_.load(std::memory_order_relaxed);
+  size_t tail = 0;
+  if (flush_taken_) {
+    // keep packets which producer queued after the flush packet
+    flush_taken_ = false;
+    tail = flush_until_;
+    DCHECK(tail - head <= capacity_);
+  } else {
+    flush_request_ = false;
+    tail = tail_.load(std::memory_order_acquire);
+  }
+  int64_t bytes = 0;
+  int64_t duration = 0;
+  for (; head != tail; ++head) {
+    AVPacket* pkt = &packets_[head & mask_];
+    bytes += pkt->size;
+    duration += pkt->duration;
     av_packet_unref(pkt);
-    return -1;
   }
+  if (cached_tail_ - tail > capacity_) {  // cached tail is behind new head
+    cached_tail_ = tail;
+  }
+  popped_size_.store(popped_size_.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+  popped_duration_.store(popped_duration_.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+  head_.store(tail);
+  NotifyWritable();
+  NotifyDrained();
+}
 
-  queue_.push_back(*pkt);
-  size_ += pkt->size;
-  duration_ += pkt->duration;
-  cond_.notify_one();
-  return 0;
+void PacketQueue::Abort() {
+  lock_t lock(mutex_);
+  abort_request_ = true;
+  readable_cond_.notify_all();
+  writable_cond_.notify_all();
 }
 
-void PacketQueue::Flush() {
+bool PacketQueue::WaitReadable() {
+  if (abort_request_) {
+    return false;
+  }
+
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (cached_tail_ != head || flush_request_) {
+    return true;
+  }
+
+  cached_tail_ = tail_.load(std::memory_order_acquire);
+  if (cached_tail_ != head) {
+    return true;
+  }
+
   lock_t lock(mutex_);
-  for (auto it = queue_.begin(); it != queue_.end(); ++it) {
-    AVPacket pkt = *it;
-    av_packet_unref(&pkt);
+  consumer_waiting_ = true;
+  while (!abort_request_ && !flush_request_ && (cached_tail_ = tail_.load()) == head) {
+    readable_cond_.wait(lock);
   }
-  queue_.clear();
-  size_ = 0;
-  duration_ = 0;
+  consumer_waiting_ = false;
+  return !abort_request_;
 }
 
-void PacketQueue::Abort() {
+bool PacketQueue::WaitWritable() {
+  if (abort_request_) {
+    return false;
+  }
+
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - cached_head_ < capacity_) {
+    return true;
+  }
+
+  cached_head_ = head_.load(std::memory_order_acquire);
+  if (tail - cached_head_ < capacity_) {
+    return true;
+  }
+
   lock_t lock(mutex_);
-  abort_request_ = true;
-  cond_.notify_one();
+  producer_waiting_ = true;
+  while (!abort_request_ && tail - (cached_head_ = head_.load()) >= capacity_) {
+    writable_cond_.wait(lock);
+  }
+  producer_waiting_ = false;
+  return !abort_request_;
+}
+
+void PacketQueue::NotifyReadable() {
+  // pairs with consumer_waiting_ store in WaitReadable, both seq_cst
+  if (consumer_waiting_) {
+    lock_t lock(mutex_);
+    readable_cond_.notify_one();
+  }
+}
+
+void PacketQueue::NotifyWritable() {
+  if (producer_waiting_) {
+    lock_t lock(mutex_);
+    writable_cond_.notify_one();
+  }
+}
+
+void PacketQueue::NotifyDrained() {
+  WakeupEvent* wakeup = drain_wakeup_;
+  if (wakeup && GetDuration() < drain_duration_) {
+    wakeup->Notify();
+  }
+}
+
+bool PacketQueue::TakeFlushRequest(AVPacket* pkt) {
+  if (!flush_request_.exchange(false)) {
+    return false;
+  }
+
+  av_init_packet(pkt);
+  pkt->data = NULL;
+  pkt->size = 0;
+  pkt->stream_index = flush_stream_index_;
+  flush_until_ = flush_tail_;
+  flush_taken_ = true;
+  return true;
 }
 
 PacketQueue::~PacketQueue() {
   Flush();
+  delete[] packets_;
 }
 
 }  // namespace core
@@ -18,10 +18,9 @@
 
 #pragma once
 
+#include <stddef.h>  // for size_t
 #include <stdint.h>  // for int64_t
 
-#include <queue>
-
 #include "ffmpeg_config.h"
 
 extern "C" {
@@ -37,36 +36,86 @@ namespace fastotv {
 namespace client {
 namespace core {
 
+class WakeupEvent;
+
+/*
+ * Bounded single-producer/single-consumer queue of compressed packets.
+ * Producer side (Put, PutNullpacket) is the read thread, consumer side (Get, GetBatch, Flush)
+ * is the decoder thread or anybody after the decoder thread was joined.
+ * Fast path is lock free, mutex/condition variables are used only to park on empty/full queue.
+ */
 class PacketQueue {  // compressed queue data
  public:
-  PacketQueue();
+  enum { default_capacity = 2048 };  // must be power of two
+
+  explicit PacketQueue(size_t capacity = default_capacity);
   ~PacketQueue();
 
+  // drops packets queued before the last flush packet returned by Get, everything if there was none
   void Flush();
   void Abort();
   int Put(AVPacket* pkt);
+  // flush packet, will be returned by Get ahead of queued packets, packets queued after it survive Flush
   int PutNullpacket(int stream_index);
-  /* return < 0 if aborted, 0 if no packet and > 0 if packet.  */
+  /* return false if aborted, blocks until packet available */
   bool Get(AVPacket* pkt);
+  /* return 0 if aborted, otherwise count of packets (at least one) stored into pkts */
+  size_t GetBatch(AVPacket* pkts, size_t max_count);
   void Start();
 
-  bool IsAborted();
-  size_t GetNbPackets();
-  int GetSize() const;
+  bool IsAborted() const;
+  bool IsFlushRequested() const;
+  size_t GetNbPackets() const;
+  size_t GetCapacity() const;
+  int64_t GetSize() const;
   int64_t GetDuration() const;
 
+  // consumer notifies wakeup whenever queued duration (stream time base) is below low_duration,
+  // so producer parked on its own watermarks does not need to poll
+  void SetDrainWakeup(WakeupEvent* wakeup, int64_t low_duration);
+
  private:
-  int PushFront(AVPacket* pkt);
-  int PushBack(AVPacket* pkt);
   DISALLOW_COPY_AND_ASSIGN(PacketQueue);
 
-  std::deque<AVPacket> queue_;
-  common::atomic<int> size_;
-  common::atomic<int64_t> duration_;
-  bool abort_request_;
+  bool WaitReadable();
+  bool WaitWritable();
+  void NotifyReadable();
+  void NotifyWritable();
+  void NotifyDrained();
+  bool TakeFlushRequest(AVPacket* pkt);
+
   typedef common::unique_lock<common::mutex> lock_t;
-  common::condition_variable cond_;
+
+  const size_t capacity_;
+  const size_t mask_;
+  AVPacket* const packets_;
+
+  // consumer cache line, size/duration are counted separately per side to avoid shared read-modify-write
+  alignas(64) common::atomic<size_t> head_;
+  size_t cached_tail_;
+  common::atomic<int64_t> popped_size_;
+  common::atomic<int64_t> popped_duration_;
+
+  // producer cache line
+  alignas(64) common::atomic<size_t> tail_;
+  size_t cached_head_;
+  common::atomic<int64_t> pushed_size_;
+  common::atomic<int64_t> pushed_duration_;
+
+  alignas(64) common::atomic<bool> abort_request_;
+  common::atomic<bool> flush_request_;
+  common::atomic<int> flush_stream_index_;
+  common::atomic<size_t> flush_tail_;  // tail when flush was requested, written by producer
+  size_t flush_until_;                 // consumer copy of flush_tail_ for the taken flush packet
+  bool flush_taken_;
+  common::atomic<bool> consumer_waiting_;
+  common::atomic<bool> producer_waiting_;
+  common::atomic<WakeupEvent*> drain_wakeup_;
+  common::atomic<int64_t> drain_duration_;
+
   common::mutex mutex_;
+  common::condition_variable readable_cond_;
+  common::condition_variable writable_cond_;
 };
 
 }  // namespace core
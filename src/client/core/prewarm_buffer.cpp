@@ -0,0 +1,173 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/prewarm_buffer.h"
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+PrewarmBuffer::PrewarmBuffer(size_t max_bytes, bandwidth_t max_bandwidth)
+    : max_bytes_(max_bytes),
+      max_bandwidth_(max_bandwidth),
+      video_stream_index_(-1),
+      audio_stream_index_(-1),
+      packets_(),
+      size_(0),
+      have_keyframe_(false),
+      interval_start_(0),
+      interval_bytes_(0),
+      lag_(0),
+      throttle_start_(0),
+      drops_(0) {}
+
+PrewarmBuffer::~PrewarmBuffer() {
+  Clear();
+}
+
+void PrewarmBuffer::SetStreams(int video_stream_index, int audio_stream_index) {
+  Clear();
+  video_stream_index_ = video_stream_index;
+  audio_stream_index_ = audio_stream_index;
+}
+
+void PrewarmBuffer::Push(AVPacket* pkt, msec_t cur_time) {
+  if (interval_start_ == 0) {
+    interval_start_ = cur_time;
+  }
+  interval_bytes_ += pkt->size;
+
+  const bool have_video = video_stream_index_ >= 0;
+  const bool is_video = have_video && pkt->stream_index == video_stream_index_;
+  const bool is_audio = audio_stream_index_ >= 0 && pkt->stream_index == audio_stream_index_;
+  if (!is_video && !is_audio) {
+    av_packet_unref(pkt);
+    return;
+  }
+
+  if (is_video && (pkt->flags & AV_PKT_FLAG_KEY)) {  // new gop, older packets are useless
+    Clear();
+    have_keyframe_ = true;
+  }
+  if (have_video && !have_keyframe_) {
+    av_packet_unref(pkt);
+    return;
+  }
+
+  packets_.push_back(*pkt);
+  size_ += pkt->size;
+  if (size_ > max_bytes_) {
+    if (have_video) {  // gop doesn't fit, wait for the next keyframe
+      Clear();
+    } else {
+      while (size_ > max_bytes_) {
+        PopFront();
+      }
+    }
+  }
+}
+
+msec_t PrewarmBuffer::GetThrottleDelay(msec_t cur_time) {
+  if (!max_bandwidth_ || interval_start_ == 0) {
+    return 0;
+  }
+
+  if (GetLag(cur_time) > max_lag_msec) {
+    DropLagged();
+  }
+  if (video_stream_index_ >= 0 && !have_keyframe_) {  // catching up with live, not counted against budget
+    interval_start_ = cur_time;
+    interval_bytes_ = 0;
+    return 0;
+  }
+
+  // time which bytes read in current interval are allowed to take
+  const msec_t budget_time = static_cast<msec_t>(interval_bytes_ * 1000 / max_bandwidth_);
+  const msec_t elapsed = cur_time - interval_start_;
+  if (budget_time > elapsed) {
+    if (throttle_start_ == 0) {
+      throttle_start_ = cur_time;
+    }
+    return budget_time - elapsed;
+  }
+
+  if (throttle_start_ != 0) {
+    lag_ += cur_time - throttle_start_;
+    throttle_start_ = 0;
+  }
+
+  if (elapsed >= bandwidth_check_interval_msec) {  // start new interval, so old idle time isn't a credit
+    interval_start_ = cur_time;
+    interval_bytes_ = 0;
+  }
+  return 0;
+}
+
+msec_t PrewarmBuffer::GetLag(msec_t cur_time) const {
+  return throttle_start_ ? lag_ + cur_time - throttle_start_ : lag_;
+}
+
+size_t PrewarmBuffer::GetDropsCount() const {
+  return drops_;
+}
+
+bool PrewarmBuffer::Pop(AVPacket* pkt) {
+  if (packets_.empty()) {
+    return false;
+  }
+
+  *pkt = packets_.front();
+  size_ -= pkt->size;
+  packets_.pop_front();
+  return true;
+}
+
+void PrewarmBuffer::Clear() {
+  while (!packets_.empty()) {
+    PopFront();
+  }
+  have_keyframe_ = false;
+}
+
+size_t PrewarmBuffer::GetSize() const {
+  return size_;
+}
+
+size_t PrewarmBuffer::GetPacketsCount() const {
+  return packets_.size();
+}
+
+void PrewarmBuffer::DropLagged() {
+  Clear();
+  lag_ = 0;
+  throttle_start_ = 0;
+  drops_++;
+}
+
+void PrewarmBuffer::PopFront() {
+  AVPacket pkt = packets_.front();
+  size_ -= pkt.size;
+  packets_.pop_front();
+  av_packet_unref(&pkt);
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
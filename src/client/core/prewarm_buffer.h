@@ -0,0 +1,95 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <deque>  // for deque
+
+extern "C" {
+#include <libavcodec/avcodec.h>  // for AVPacket
+}
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "client/core/types.h"  // for msec_t, bandwidth_t
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+/*
+ * Packets of not yet played stream, always starts from the last video keyframe
+ * (audio only streams keep the newest packets), so decoding can start right after promotion.
+ * Reading is throttled to the bandwidth budget instead of being stopped, so buffer keeps following the stream.
+ * Throttled reading falls behind live, once it is max_lag_msec behind buffer is dropped and reading goes on
+ * without throttling till the next keyframe, so promoted stream never starts far behind live.
+ */
+class PrewarmBuffer {
+ public:
+  enum { bandwidth_check_interval_msec = 2000, max_lag_msec = 2000 /* about one gop */ };
+
+  // max_bandwidth == 0 means unlimited
+  PrewarmBuffer(size_t max_bytes, bandwidth_t max_bandwidth);
+  ~PrewarmBuffer();
+
+  void SetStreams(int video_stream_index, int audio_stream_index);
+
+  // takes packet payload
+  void Push(AVPacket* pkt, msec_t cur_time);
+  // msec to pause reading to get back under bandwidth budget, 0 if reading can go on
+  msec_t GetThrottleDelay(msec_t cur_time);
+  // msec spent throttled since buffer was last dropped
+  msec_t GetLag(msec_t cur_time) const;
+  size_t GetDropsCount() const;
+  bool Pop(AVPacket* pkt);
+  void Clear();
+
+  size_t GetSize() const;
+  size_t GetPacketsCount() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PrewarmBuffer);
+
+  void PopFront();
+  void DropLagged();
+
+  const size_t max_bytes_;
+  const bandwidth_t max_bandwidth_;
+
+  int video_stream_index_;
+  int audio_stream_index_;
+
+  std::deque<AVPacket> packets_;
+  size_t size_;
+  bool have_keyframe_;
+
+  msec_t interval_start_;
+  size_t interval_bytes_;
+
+  msec_t lag_;
+  msec_t throttle_start_;  // 0 if not throttled now
+  size_t drops_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,438 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/probe_info.h"
+
+#include <string.h>  // for memcpy
+
+extern "C" {
+#include <libavutil/mem.h>  // for av_mallocz
+}
+
+#include <common/logger.h>   // for DCHECK
+#include <common/sprintf.h>  // for MemSPrintf
+
+#include "third-party/json-c/json-c/json_util.h"  // for json_object_from_file, json_object_to_file
+
+#define PROBE_INFO_BIT_RATE_FIELD "bit_rate"
+#define PROBE_INFO_PROBE_SIZE_FIELD "probe_size"
+#define PROBE_INFO_ANALYZE_DURATION_FIELD "analyze_duration"
+#define PROBE_INFO_STREAMS_FIELD "streams"
+
+#define STREAM_PROBE_INFO_ID_FIELD "id"
+#define STREAM_PROBE_INFO_CODEC_TYPE_FIELD "codec_type"
+#define STREAM_PROBE_INFO_CODEC_ID_FIELD "codec_id"
+#define STREAM_PROBE_INFO_FORMAT_FIELD "format"
+#define STREAM_PROBE_INFO_BIT_RATE_FIELD "bit_rate"
+#define STREAM_PROBE_INFO_PROFILE_FIELD "profile"
+#define STREAM_PROBE_INFO_LEVEL_FIELD "level"
+#define STREAM_PROBE_INFO_EXTRADATA_FIELD "extradata"
+#define STREAM_PROBE_INFO_WIDTH_FIELD "width"
+#define STREAM_PROBE_INFO_HEIGHT_FIELD "height"
+#define STREAM_PROBE_INFO_SAR_FIELD "sar"
+#define STREAM_PROBE_INFO_R_FRAME_RATE_FIELD "r_frame_rate"
+#define STREAM_PROBE_INFO_AVG_FRAME_RATE_FIELD "avg_frame_rate"
+#define STREAM_PROBE_INFO_SAMPLE_RATE_FIELD "sample_rate"
+#define STREAM_PROBE_INFO_CHANNELS_FIELD "channels"
+#define STREAM_PROBE_INFO_CHANNEL_LAYOUT_FIELD "channel_layout"
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+namespace {
+
+std::string HexEncode(const std::string& data) {
+  static const char hex[] = "0123456789abcdef";
+  std::string result;
+  result.reserve(data.size() * 2);
+  for (size_t i = 0; i < data.size(); ++i) {
+    uint8_t c = static_cast<uint8_t>(data[i]);
+    result += hex[c >> 4];
+    result += hex[c & 0x0f];
+  }
+  return result;
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool HexDecode(const std::string& hex, std::string* data) {
+  if (hex.size() % 2) {
+    return false;
+  }
+
+  std::string result;
+  result.reserve(hex.size() / 2);
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    int hi = HexValue(hex[i]);
+    int lo = HexValue(hex[i + 1]);
+    if (hi < 0 || lo < 0) {
+      return false;
+    }
+    result += static_cast<char>((hi << 4) | lo);
+  }
+  *data = result;
+  return true;
+}
+
+json_object* MakeRational(AVRational r) {
+  json_object* jr = json_object_new_array();
+  json_object_array_add(jr, json_object_new_int(r.num));
+  json_object_array_add(jr, json_object_new_int(r.den));
+  return jr;
+}
+
+AVRational GetRational(json_object* jr) {
+  if (json_object_array_length(jr) != 2) {
+    return {0, 1};
+  }
+  return {json_object_get_int(json_object_array_get_idx(jr, 0)), json_object_get_int(json_object_array_get_idx(jr, 1))};
+}
+
+int64_t GetInt64Field(json_object* obj, const char* field, int64_t def) {
+  json_object* jval = NULL;
+  if (!json_object_object_get_ex(obj, field, &jval)) {
+    return def;
+  }
+  return json_object_get_int64(jval);
+}
+
+json_object* SerializeStream(const StreamProbeInfo& stream) {
+  json_object* obj = json_object_new_object();
+  json_object_object_add(obj, STREAM_PROBE_INFO_ID_FIELD, json_object_new_int(stream.id));
+  json_object_object_add(obj, STREAM_PROBE_INFO_CODEC_TYPE_FIELD, json_object_new_int(stream.codec_type));
+  json_object_object_add(obj, STREAM_PROBE_INFO_CODEC_ID_FIELD, json_object_new_int(stream.codec_id));
+  json_object_object_add(obj, STREAM_PROBE_INFO_FORMAT_FIELD, json_object_new_int(stream.format));
+  json_object_object_add(obj, STREAM_PROBE_INFO_BIT_RATE_FIELD, json_object_new_int64(stream.bit_rate));
+  json_object_object_add(obj, STREAM_PROBE_INFO_PROFILE_FIELD, json_object_new_int(stream.profile));
+  json_object_object_add(obj, STREAM_PROBE_INFO_LEVEL_FIELD, json_object_new_int(stream.level));
+  const std::string extradata = HexEncode(stream.extradata);
+  json_object_object_add(obj, STREAM_PROBE_INFO_EXTRADATA_FIELD, json_object_new_string(extradata.c_str()));
+  if (stream.codec_type == AVMEDIA_TYPE_VIDEO) {
+    json_object_object_add(obj, STREAM_PROBE_INFO_WIDTH_FIELD, json_object_new_int(stream.width));
+    json_object_object_add(obj, STREAM_PROBE_INFO_HEIGHT_FIELD, json_object_new_int(stream.height));
+    json_object_object_add(obj, STREAM_PROBE_INFO_SAR_FIELD, MakeRational(stream.sample_aspect_ratio));
+    json_object_object_add(obj, STREAM_PROBE_INFO_R_FRAME_RATE_FIELD, MakeRational(stream.r_frame_rate));
+    json_object_object_add(obj, STREAM_PROBE_INFO_AVG_FRAME_RATE_FIELD, MakeRational(stream.avg_frame_rate));
+  } else if (stream.codec_type == AVMEDIA_TYPE_AUDIO) {
+    json_object_object_add(obj, STREAM_PROBE_INFO_SAMPLE_RATE_FIELD, json_object_new_int(stream.sample_rate));
+    json_object_object_add(obj, STREAM_PROBE_INFO_CHANNELS_FIELD, json_object_new_int(stream.channels));
+    json_object_object_add(obj, STREAM_PROBE_INFO_CHANNEL_LAYOUT_FIELD,
+                           json_object_new_int64(static_cast<int64_t>(stream.channel_layout)));
+  }
+  return obj;
+}
+
+bool DeSerializeStream(json_object* obj, StreamProbeInfo* stream) {
+  json_object* jtype = NULL;
+  json_object* jcodec = NULL;
+  if (!json_object_object_get_ex(obj, STREAM_PROBE_INFO_CODEC_TYPE_FIELD, &jtype) ||
+      !json_object_object_get_ex(obj, STREAM_PROBE_INFO_CODEC_ID_FIELD, &jcodec)) {
+    return false;
+  }
+
+  StreamProbeInfo res;
+  res.id = GetInt64Field(obj, STREAM_PROBE_INFO_ID_FIELD, 0);
+  res.codec_type = static_cast<AVMediaType>(json_object_get_int(jtype));
+  res.codec_id = static_cast<AVCodecID>(json_object_get_int(jcodec));
+  res.format = GetInt64Field(obj, STREAM_PROBE_INFO_FORMAT_FIELD, -1);
+  res.bit_rate = GetInt64Field(obj, STREAM_PROBE_INFO_BIT_RATE_FIELD, 0);
+  res.profile = GetInt64Field(obj, STREAM_PROBE_INFO_PROFILE_FIELD, FF_PROFILE_UNKNOWN);
+  res.level = GetInt64Field(obj, STREAM_PROBE_INFO_LEVEL_FIELD, FF_LEVEL_UNKNOWN);
+  json_object* jextradata = NULL;
+  if (json_object_object_get_ex(obj, STREAM_PROBE_INFO_EXTRADATA_FIELD, &jextradata)) {
+    if (!HexDecode(json_object_get_string(jextradata), &res.extradata)) {
+      return false;
+    }
+  }
+
+  res.width = GetInt64Field(obj, STREAM_PROBE_INFO_WIDTH_FIELD, 0);
+  res.height = GetInt64Field(obj, STREAM_PROBE_INFO_HEIGHT_FIELD, 0);
+  json_object* jrational = NULL;
+  if (json_object_object_get_ex(obj, STREAM_PROBE_INFO_SAR_FIELD, &jrational)) {
+    res.sample_aspect_ratio = GetRational(jrational);
+  }
+  if (json_object_object_get_ex(obj, STREAM_PROBE_INFO_R_FRAME_RATE_FIELD, &jrational)) {
+    res.r_frame_rate = GetRational(jrational);
+  }
+  if (json_object_object_get_ex(obj, STREAM_PROBE_INFO_AVG_FRAME_RATE_FIELD, &jrational)) {
+    res.avg_frame_rate = GetRational(jrational);
+  }
+
+  res.sample_rate = GetInt64Field(obj, STREAM_PROBE_INFO_SAMPLE_RATE_FIELD, 0);
+  res.channels = GetInt64Field(obj, STREAM_PROBE_INFO_CHANNELS_FIELD, 0);
+  res.channel_layout = GetInt64Field(obj, STREAM_PROBE_INFO_CHANNEL_LAYOUT_FIELD, 0);
+  *stream = res;
+  return true;
+}
+
+}  // namespace
+
+StreamProbeInfo::StreamProbeInfo()
+    : id(0),
+      codec_type(AVMEDIA_TYPE_UNKNOWN),
+      codec_id(AV_CODEC_ID_NONE),
+      format(-1),
+      bit_rate(0),
+      profile(FF_PROFILE_UNKNOWN),
+      level(FF_LEVEL_UNKNOWN),
+      extradata(),
+      width(0),
+      height(0),
+      sample_aspect_ratio{0, 1},
+      r_frame_rate{0, 1},
+      avg_frame_rate{0, 1},
+      sample_rate(0),
+      channels(0),
+      channel_layout(0) {}
+
+StreamProbeInfo::StreamProbeInfo(const AVStream* st)
+    : id(st->id),
+      codec_type(st->codecpar->codec_type),
+      codec_id(st->codecpar->codec_id),
+      format(st->codecpar->format),
+      bit_rate(st->codecpar->bit_rate),
+      profile(st->codecpar->profile),
+      level(st->codecpar->level),
+      extradata(),
+      width(st->codecpar->width),
+      height(st->codecpar->height),
+      sample_aspect_ratio(st->codecpar->sample_aspect_ratio),
+      r_frame_rate(st->r_frame_rate),
+      avg_frame_rate(st->avg_frame_rate),
+      sample_rate(st->codecpar->sample_rate),
+      channels(st->codecpar->channels),
+      channel_layout(st->codecpar->channel_layout) {
+  if (st->codecpar->extradata && st->codecpar->extradata_size > 0) {
+    extradata.assign(reinterpret_cast<const char*>(st->codecpar->extradata), st->codecpar->extradata_size);
+  }
+}
+
+ProbeInfo::ProbeInfo() : bit_rate_(0), probe_size_(0), analyze_duration_(0), streams_() {}
+
+ProbeInfo::ProbeInfo(const AVFormatContext* ic, int64_t probe_size)
+    : bit_rate_(ic->bit_rate), probe_size_(probe_size), analyze_duration_(0), streams_() {
+  for (unsigned int i = 0; i < ic->nb_streams; ++i) {
+    streams_.push_back(StreamProbeInfo(ic->streams[i]));
+  }
+  if (bit_rate_ > 0) {
+    analyze_duration_ = av_rescale(probe_size_ * 8, AV_TIME_BASE, bit_rate_);
+  }
+}
+
+bool ProbeInfo::IsValid() const {
+  return !streams_.empty();
+}
+
+bool ProbeInfo::IsSameLayout(const AVFormatContext* ic) const {
+  if (ic->nb_streams != streams_.size()) {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < ic->nb_streams; ++i) {
+    const AVStream* st = ic->streams[i];
+    const StreamProbeInfo& cached = streams_[i];
+    if (st->id != cached.id || st->codecpar->codec_type != cached.codec_type) {
+      return false;
+    }
+    if (st->codecpar->codec_id != AV_CODEC_ID_NONE && st->codecpar->codec_id != cached.codec_id) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ProbeInfo::Seed(AVFormatContext* ic) const {
+  DCHECK(IsSameLayout(ic));
+  for (unsigned int i = 0; i < ic->nb_streams; ++i) {
+    AVStream* st = ic->streams[i];
+    AVCodecParameters* par = st->codecpar;
+    const StreamProbeInfo& cached = streams_[i];
+    if (par->codec_id == AV_CODEC_ID_NONE) {
+      par->codec_id = cached.codec_id;
+    }
+    if (!par->bit_rate) {
+      par->bit_rate = cached.bit_rate;
+    }
+    if (par->profile == FF_PROFILE_UNKNOWN) {
+      par->profile = cached.profile;
+    }
+    if (par->level == FF_LEVEL_UNKNOWN) {
+      par->level = cached.level;
+    }
+    if (!par->extradata && !cached.extradata.empty()) {
+      const size_t size = cached.extradata.size();
+      par->extradata = static_cast<uint8_t*>(av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+      if (par->extradata) {
+        memcpy(par->extradata, cached.extradata.data(), size);
+        par->extradata_size = size;
+      }
+    }
+    if (par->format == -1) {
+      par->format = cached.format;
+    }
+
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+      if (!par->width || !par->height) {
+        par->width = cached.width;
+        par->height = cached.height;
+      }
+      if (!par->sample_aspect_ratio.num) {
+        par->sample_aspect_ratio = cached.sample_aspect_ratio;
+      }
+      // known frame rate stops fps analysis in avformat_find_stream_info
+      if (!st->r_frame_rate.num) {
+        st->r_frame_rate = cached.r_frame_rate;
+      }
+      if (!st->avg_frame_rate.num) {
+        st->avg_frame_rate = cached.avg_frame_rate;
+      }
+    } else if (par->codec_type == AVMEDIA_TYPE_AUDIO) {
+      if (!par->sample_rate) {
+        par->sample_rate = cached.sample_rate;
+      }
+      if (!par->channels) {
+        par->channels = cached.channels;
+        par->channel_layout = cached.channel_layout;
+      }
+    }
+  }
+
+  // never probe more than user asked
+  if (probe_size_ > 0) {
+    const int64_t probe_size = FFMAX(probe_size_ * 2, static_cast<int64_t>(min_probe_size));
+    ic->probesize = FFMIN(ic->probesize, probe_size);
+  }
+  if (analyze_duration_ > 0) {
+    const int64_t analyze_duration = FFMAX(analyze_duration_ * 2, static_cast<int64_t>(min_analyze_duration));
+    ic->max_analyze_duration =
+        ic->max_analyze_duration ? FFMIN(ic->max_analyze_duration, analyze_duration) : analyze_duration;
+  }
+}
+
+int64_t ProbeInfo::GetProbeSize() const {
+  return probe_size_;
+}
+
+int64_t ProbeInfo::GetAnalyzeDuration() const {
+  return analyze_duration_;
+}
+
+ProbeInfo::streams_t ProbeInfo::GetStreams() const {
+  return streams_;
+}
+
+common::Error ProbeInfo::SerializeImpl(serialize_type* deserialized) const {
+  if (!IsValid()) {
+    return common::make_error_value("Invalid input argument(s)", common::Value::E_ERROR);
+  }
+
+  json_object* obj = json_object_new_object();
+  json_object_object_add(obj, PROBE_INFO_BIT_RATE_FIELD, json_object_new_int64(bit_rate_));
+  json_object_object_add(obj, PROBE_INFO_PROBE_SIZE_FIELD, json_object_new_int64(probe_size_));
+  json_object_object_add(obj, PROBE_INFO_ANALYZE_DURATION_FIELD, json_object_new_int64(analyze_duration_));
+  json_object* jstreams = json_object_new_array();
+  for (const StreamProbeInfo& stream : streams_) {
+    json_object_array_add(jstreams, SerializeStream(stream));
+  }
+  json_object_object_add(obj, PROBE_INFO_STREAMS_FIELD, jstreams);
+  *deserialized = obj;
+  return common::Error();
+}
+
+common::Error ProbeInfo::DeSerialize(const serialize_type& serialized, value_type* obj) {
+  if (!serialized || !obj) {
+    return common::make_error_value("Invalid input argument(s)", common::Value::E_ERROR);
+  }
+
+  json_object* jstreams = NULL;
+  json_bool jstreams_exists = json_object_object_get_ex(serialized, PROBE_INFO_STREAMS_FIELD, &jstreams);
+  if (!jstreams_exists) {
+    return common::make_error_value("Invalid input argument(s)", common::Value::E_ERROR);
+  }
+
+  ProbeInfo inf;
+  size_t len = json_object_array_length(jstreams);
+  for (size_t i = 0; i < len; ++i) {
+    StreamProbeInfo stream;
+    if (!DeSerializeStream(json_object_array_get_idx(jstreams, i), &stream)) {
+      return common::make_error_value("Invalid stream probe info", common::Value::E_ERROR);
+    }
+    inf.streams_.push_back(stream);
+  }
+  if (!inf.IsValid()) {
+    return common::make_error_value("Invalid input argument(s)", common::Value::E_ERROR);
+  }
+
+  inf.bit_rate_ = GetInt64Field(serialized, PROBE_INFO_BIT_RATE_FIELD, 0);
+  inf.probe_size_ = GetInt64Field(serialized, PROBE_INFO_PROBE_SIZE_FIELD, 0);
+  inf.analyze_duration_ = GetInt64Field(serialized, PROBE_INFO_ANALYZE_DURATION_FIELD, 0);
+  *obj = inf;
+  return common::Error();
+}
+
+common::Error LoadProbeInfo(const std::string& path, ProbeInfo* info) {
+  if (path.empty() || !info) {
+    return common::make_error_value("Invalid input argument(s)", common::Value::E_ERROR);
+  }
+
+  json_object* obj = json_object_from_file(path.c_str());
+  if (!obj) {
+    return common::make_error_value(common::MemSPrintf("Can't read probe cache: %s", path), common::Value::E_ERROR);
+  }
+
+  common::Error err = ProbeInfo::DeSerialize(obj, info);
+  json_object_put(obj);
+  return err;
+}
+
+common::Error SaveProbeInfo(const std::string& path, const ProbeInfo& info) {
+  if (path.empty()) {
+    return common::make_error_value("Invalid input argument(s)", common::Value::E_ERROR);
+  }
+
+  json_object* obj = NULL;
+  common::Error err = info.Serialize(&obj);
+  if (err && err->IsError()) {
+    return err;
+  }
+
+  int res = json_object_to_file(path.c_str(), obj);
+  json_object_put(obj);
+  if (res < 0) {
+    return common::make_error_value(common::MemSPrintf("Can't write probe cache: %s", path), common::Value::E_ERROR);
+  }
+  return common::Error();
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
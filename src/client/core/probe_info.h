@@ -0,0 +1,104 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>  // for int64_t, uint64_t
+
+#include <string>  // for string
+#include <vector>  // for vector
+
+extern "C" {
+#include <libavformat/avformat.h>  // for AVFormatContext
+}
+
+#include <common/error.h>   // for Error
+#include <common/macros.h>  // for WARN_UNUSED_RESULT
+
+#include "serializer/json_serializer.h"
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+struct StreamProbeInfo {
+  StreamProbeInfo();
+  explicit StreamProbeInfo(const AVStream* st);
+
+  int id;  // format specific, pid for mpegts
+  AVMediaType codec_type;
+  AVCodecID codec_id;
+  int format;
+  int64_t bit_rate;
+  int profile;
+  int level;
+  std::string extradata;
+
+  int width;
+  int height;
+  AVRational sample_aspect_ratio;
+  AVRational r_frame_rate;
+  AVRational avg_frame_rate;
+
+  int sample_rate;
+  int channels;
+  uint64_t channel_layout;
+};
+
+/*
+ * Result of avformat_find_stream_info for channel, lets reopen seed codec parameters
+ * and probe only up to the first packets instead of the default probesize/analyzeduration.
+ */
+class ProbeInfo : public JsonSerializer<ProbeInfo> {
+ public:
+  typedef std::vector<StreamProbeInfo> streams_t;
+  enum { min_probe_size = 32 * 1024, min_analyze_duration = AV_TIME_BASE / 2 };
+
+  ProbeInfo();
+  ProbeInfo(const AVFormatContext* ic, int64_t probe_size);  // ic after avformat_find_stream_info
+
+  bool IsValid() const;
+  // same streams as just opened input, codecs of not yet probed streams are ignored
+  bool IsSameLayout(const AVFormatContext* ic) const;
+  // fills unknown codec parameters and narrows probing, input must have the same layout
+  void Seed(AVFormatContext* ic) const;
+
+  int64_t GetProbeSize() const;
+  int64_t GetAnalyzeDuration() const;
+  streams_t GetStreams() const;
+
+  static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
+
+ protected:
+  virtual common::Error SerializeImpl(serialize_type* deserialized) const override;
+
+ private:
+  int64_t bit_rate_;
+  int64_t probe_size_;        // bytes which full probe read
+  int64_t analyze_duration_;  // AV_TIME_BASE units, estimated from probe_size and bitrate
+  streams_t streams_;
+};
+
+common::Error LoadProbeInfo(const std::string& path, ProbeInfo* info) WARN_UNUSED_RESULT;
+common::Error SaveProbeInfo(const std::string& path, const ProbeInfo& info) WARN_UNUSED_RESULT;
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,312 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/read_ahead_io.h"
+
+#include <errno.h>   // for EINVAL, ENOMEM
+#include <stdio.h>   // for SEEK_SET, SEEK_CUR, SEEK_END
+#include <string.h>  // for memcpy
+
+#include <algorithm>  // for std::min
+#include <chrono>     // for milliseconds
+
+extern "C" {
+#include <libavutil/error.h>  // for AVERROR
+#include <libavutil/mem.h>    // for av_malloc, av_freep
+}
+
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+ReadAheadIO::ReadAheadIO(size_t capacity, const AVIOInterruptCB& interrupt_cb)
+    : capacity_(capacity),
+      ring_(new uint8_t[capacity]),
+      interrupt_cb_(interrupt_cb),
+      source_(NULL),
+      context_(NULL),
+      size_(-1),
+      tid_(THREAD_MANAGER()->CreateThread(&ReadAheadIO::Run, this)),
+      mutex_(),
+      readable_cond_(),
+      writable_cond_(),
+      read_index_(0),
+      filled_(0),
+      position_(0),
+      seek_request_(-1),
+      seek_result_(0),
+      source_error_(0),
+      stop_(false),
+      opened_(false),
+      stall_msec_(0),
+      stalls_(0) {}
+
+ReadAheadIO::~ReadAheadIO() {
+  Close();
+  delete[] ring_;
+}
+
+bool ReadAheadIO::IsSupported(const std::string& url) {
+  if (url.find(".m3u8") != std::string::npos) {
+    return false;
+  }
+
+  const size_t scheme_end = url.find("://");
+  if (scheme_end == std::string::npos) {  // local path
+    return true;
+  }
+
+  static const char* const schemes[] = {"file", "http", "https", "udp", "tcp", "rtmp"};
+  const std::string scheme = url.substr(0, scheme_end);
+  for (size_t i = 0; i < SIZEOFMASS(schemes); ++i) {
+    if (scheme == schemes[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int ReadAheadIO::Open(const std::string& url, AVDictionary* options) {
+  if (opened_) {
+    return AVERROR(EINVAL);
+  }
+
+  AVDictionary* source_options = NULL;
+  av_dict_copy(&source_options, options, 0);
+  int ret = avio_open2(&source_, url.c_str(), AVIO_FLAG_READ, &interrupt_cb_, &source_options);
+  av_dict_free(&source_options);
+  if (ret < 0) {
+    return ret;
+  }
+
+  uint8_t* buffer = static_cast<uint8_t*>(av_malloc(READ_AHEAD_AVIO_BUFFER_SIZE));
+  if (!buffer) {
+    avio_closep(&source_);
+    return AVERROR(ENOMEM);
+  }
+
+  context_ = avio_alloc_context(buffer, READ_AHEAD_AVIO_BUFFER_SIZE, 0, this, &ReadAheadIO::read_packet, NULL,
+                                source_->seekable ? &ReadAheadIO::seek : NULL);
+  if (!context_) {
+    av_freep(&buffer);
+    avio_closep(&source_);
+    return AVERROR(ENOMEM);
+  }
+  context_->seekable = source_->seekable;
+  size_ = avio_size(source_);
+
+  stop_ = false;
+  if (!tid_->Start()) {
+    av_freep(&context_->buffer);
+    av_freep(&context_);
+    avio_closep(&source_);
+    return AVERROR(EAGAIN);
+  }
+
+  opened_ = true;
+  return 0;
+}
+
+void ReadAheadIO::Close() {
+  if (!opened_) {
+    return;
+  }
+
+  {
+    lock_t lock(mutex_);
+    stop_ = true;
+    writable_cond_.notify_all();
+    readable_cond_.notify_all();
+  }
+  tid_->Join();
+
+  av_freep(&context_->buffer);
+  av_freep(&context_);
+  avio_closep(&source_);
+  opened_ = false;
+}
+
+bool ReadAheadIO::IsOpened() const {
+  return opened_;
+}
+
+AVIOContext* ReadAheadIO::GetContext() const {
+  return context_;
+}
+
+size_t ReadAheadIO::GetCapacity() const {
+  return capacity_;
+}
+
+size_t ReadAheadIO::GetFilled() const {
+  return filled_;
+}
+
+msec_t ReadAheadIO::GetStallTime() const {
+  return stall_msec_;
+}
+
+size_t ReadAheadIO::GetStallsCount() const {
+  return stalls_;
+}
+
+int ReadAheadIO::read_packet(void* opaque, uint8_t* buf, int buf_size) {
+  ReadAheadIO* io = static_cast<ReadAheadIO*>(opaque);
+  return io->Read(buf, buf_size);
+}
+
+int64_t ReadAheadIO::seek(void* opaque, int64_t offset, int whence) {
+  ReadAheadIO* io = static_cast<ReadAheadIO*>(opaque);
+  return io->Seek(offset, whence);
+}
+
+bool ReadAheadIO::IsInterrupted() const {
+  return interrupt_cb_.callback && interrupt_cb_.callback(interrupt_cb_.opaque);
+}
+
+int ReadAheadIO::Read(uint8_t* buf, int buf_size) {
+  lock_t lock(mutex_);
+  msec_t stall_start = 0;
+  while (!filled_ && !source_error_ && !stop_) {
+    if (IsInterrupted()) {
+      return AVERROR_EXIT;
+    }
+    if (!stall_start) {
+      stall_start = GetCurrentMsec();
+    }
+    readable_cond_.wait_for(lock, std::chrono::milliseconds(READ_AHEAD_WAIT_MSEC));
+  }
+  if (stall_start) {
+    stall_msec_ += GetCurrentMsec() - stall_start;
+    stalls_++;
+  }
+
+  if (!filled_) {
+    return source_error_ ? source_error_ : AVERROR_EOF;
+  }
+
+  const size_t size = std::min(static_cast<size_t>(buf_size), static_cast<size_t>(filled_));
+  const size_t first = std::min(size, capacity_ - read_index_);
+  memcpy(buf, ring_ + read_index_, first);
+  memcpy(buf + first, ring_, size - first);
+  read_index_ = (read_index_ + size) % capacity_;
+  filled_ -= size;
+  position_ += size;
+  writable_cond_.notify_one();
+  return static_cast<int>(size);
+}
+
+int64_t ReadAheadIO::Seek(int64_t offset, int whence) {
+  whence &= ~AVSEEK_FORCE;
+  if (whence == AVSEEK_SIZE) {
+    return size_ >= 0 ? size_ : AVERROR(ENOSYS);
+  }
+
+  lock_t lock(mutex_);
+  int64_t target = offset;
+  if (whence == SEEK_CUR) {
+    target = position_ + offset;
+  } else if (whence == SEEK_END) {
+    if (size_ < 0) {
+      return AVERROR(ENOSYS);
+    }
+    target = size_ + offset;
+  } else if (whence != SEEK_SET) {
+    return AVERROR(EINVAL);
+  }
+  if (target < 0) {
+    return AVERROR(EINVAL);
+  }
+
+  // forward inside buffered data, just skip
+  if (target >= position_ && target - position_ <= static_cast<int64_t>(filled_)) {
+    const size_t skip = target - position_;
+    read_index_ = (read_index_ + skip) % capacity_;
+    filled_ -= skip;
+    position_ = target;
+    writable_cond_.notify_one();
+    return target;
+  }
+
+  seek_request_ = target;
+  writable_cond_.notify_one();
+  while (seek_request_ >= 0 && !stop_) {
+    if (IsInterrupted()) {
+      return AVERROR_EXIT;
+    }
+    readable_cond_.wait_for(lock, std::chrono::milliseconds(READ_AHEAD_WAIT_MSEC));
+  }
+  if (seek_request_ >= 0) {
+    return AVERROR_EXIT;
+  }
+  if (seek_result_ >= 0) {
+    position_ = target;
+  }
+  return seek_result_;
+}
+
+int ReadAheadIO::Run() {
+  lock_t lock(mutex_);
+  while (!stop_) {
+    if (seek_request_ >= 0) {
+      const int64_t target = seek_request_;
+      lock.unlock();
+      const int64_t result = avio_seek(source_, target, SEEK_SET);
+      lock.lock();
+      read_index_ = 0;
+      filled_ = 0;
+      source_error_ = result < 0 ? static_cast<int>(result) : 0;
+      seek_result_ = result;
+      seek_request_ = -1;
+      readable_cond_.notify_all();
+      continue;
+    }
+
+    if (source_error_ || filled_ == capacity_) {
+      writable_cond_.wait(lock);
+      continue;
+    }
+
+    // region after buffered data belongs to this thread until filled_ grows
+    const size_t write_index = (read_index_ + filled_) % capacity_;
+    const size_t space = std::min(capacity_ - filled_, capacity_ - write_index);
+    const int size = static_cast<int>(std::min(space, static_cast<size_t>(READ_AHEAD_CHUNK_SIZE)));
+    lock.unlock();
+    int ret = avio_read_partial(source_, ring_ + write_index, size);
+    lock.lock();
+    if (seek_request_ >= 0) {  // data is from old position
+      continue;
+    }
+
+    if (ret > 0) {
+      filled_ += ret;
+    } else if (ret < 0 || avio_feof(source_)) {
+      source_error_ = ret < 0 ? ret : AVERROR_EOF;
+    }
+    readable_cond_.notify_all();
+  }
+  return 0;
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,119 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for int64_t, uint8_t
+
+#include <string>  // for string
+
+extern "C" {
+#include <libavformat/avio.h>  // for AVIOContext, AVIOInterruptCB
+#include <libavutil/dict.h>    // for AVDictionary
+}
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+#include <common/smart_ptr.h>
+#include <common/threads/types.h>  // for condition_variable, mutex
+
+#include "client/core/types.h"  // for msec_t
+
+#define READ_AHEAD_CHUNK_SIZE (32 * 1024)        // bytes requested from source at once
+#define READ_AHEAD_AVIO_BUFFER_SIZE (32 * 1024)  // demuxer side AVIOContext buffer
+#define READ_AHEAD_WAIT_MSEC 100                 // interrupt callback is checked this often while waiting
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+/*
+ * Custom AVIOContext for demuxer backed by ring buffer, own I/O thread reads source ahead,
+ * so network stalls are absorbed by buffered data instead of blocking av_read_frame.
+ * Source is opened through FFmpeg protocols, the same way for network and file inputs.
+ * Forward seeks inside buffered data are served from the ring, others restart source.
+ */
+class ReadAheadIO {
+ public:
+  ReadAheadIO(size_t capacity, const AVIOInterruptCB& interrupt_cb);
+  ~ReadAheadIO();
+
+  // hls and demuxers with own protocols (rtsp) open nested inputs and can't use it
+  static bool IsSupported(const std::string& url);
+
+  // 0 or AVERROR, starts I/O thread
+  int Open(const std::string& url, AVDictionary* options);
+  void Close();
+  bool IsOpened() const;
+
+  // should be set as AVFormatContext::pb together with AVFMT_FLAG_CUSTOM_IO, owned by this object
+  AVIOContext* GetContext() const;
+
+  size_t GetCapacity() const;     // bytes
+  size_t GetFilled() const;       // bytes
+  msec_t GetStallTime() const;    // total msec demuxer waited for data
+  size_t GetStallsCount() const;  // reads which found the ring empty
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ReadAheadIO);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  static int read_packet(void* opaque, uint8_t* buf, int buf_size);
+  static int64_t seek(void* opaque, int64_t offset, int whence);
+
+  int Read(uint8_t* buf, int buf_size);
+  int64_t Seek(int64_t offset, int whence);
+  bool IsInterrupted() const;
+  int Run();  // I/O thread
+
+  const size_t capacity_;
+  uint8_t* const ring_;
+  const AVIOInterruptCB interrupt_cb_;
+  AVIOContext* source_;
+  AVIOContext* context_;
+  int64_t size_;  // source size, negative if unknown
+  common::shared_ptr<common::threads::Thread<int> > tid_;
+
+  common::mutex mutex_;
+  common::condition_variable readable_cond_;  // demuxer waits for data or seek result
+  common::condition_variable writable_cond_;  // I/O thread waits for space or seek request
+  size_t read_index_;
+  common::atomic<size_t> filled_;
+  int64_t position_;      // source offset of the next byte given to demuxer
+  int64_t seek_request_;  // source offset, negative if none
+  int64_t seek_result_;   // of last processed request
+  int source_error_;      // AVERROR_EOF or read error, reset by seek
+  bool stop_;
+  common::atomic<bool> opened_;
+
+  common::atomic<msec_t> stall_msec_;
+  common::atomic<size_t> stalls_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -241,6 +241,24 @@ bool create_window(Size window_size,
   return true;
 }
 
+clock64_t calculate_vsync_period(SDL_Renderer* renderer, SDL_Window* window) {
+  if (!renderer || !window) {  // invalid input
+    return 0;
+  }
+
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(renderer, &info) != 0 || !(info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+    return 0;
+  }
+
+  SDL_DisplayMode mode;
+  if (SDL_GetWindowDisplayMode(window, &mode) != 0 || mode.refresh_rate <= 0) {
+    return 0;
+  }
+
+  return 1000 / mode.refresh_rate;
+}
+
 }  // namespace core
 }  // namespace client
 }  // namespace fastotv
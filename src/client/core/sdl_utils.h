@@ -63,6 +63,9 @@ bool create_window(Size window_size,
                    SDL_Renderer** renderer,
                    SDL_Window** window) WARN_UNUSED_RESULT;
 
+// msec between display refreshes if renderer presents with vsync, 0 otherwise
+clock64_t calculate_vsync_period(SDL_Renderer* renderer, SDL_Window* window);
+
 }  // namespace core
 }  // namespace client
 }  // namespace fastotv
@@ -58,24 +58,6 @@ void Stream::Close() {
   stream_st_ = NULL;
 }
 
-bool Stream::HasEnoughPackets() const {
-  if (!IsOpened()) {
-    return false;
-  }
-
-  if (packet_queue_->IsAborted()) {
-    return false;
-  }
-
-  bool attach = stream_st_->disposition & AV_DISPOSITION_ATTACHED_PIC;
-  if (!attach) {
-    return false;
-  }
-
-  return (packet_queue_->GetNbPackets() > minimum_frames &&
-          (!packet_queue_->GetDuration() || q2d() * packet_queue_->GetDuration() > 1000));
-}
-
 Stream::~Stream() {
   stream_index_ = -1;
   stream_st_ = NULL;
@@ -122,6 +104,10 @@ void Stream::SetPaused(bool pause) {
   start_ts_ = 0;
 }
 
+void Stream::SetClockSpeed(double speed) {
+  clock_->SetSpeed(speed);
+}
+
 clock64_t Stream::LastUpdatedClock() const {
   return clock_->LastUpdated();
 }
@@ -134,6 +120,15 @@ PacketQueue* Stream::GetQueue() const {
   return packet_queue_;
 }
 
+clock64_t Stream::GetBufferedDuration() const {
+  const int64_t duration = packet_queue_->GetDuration();
+  if (!duration && packet_queue_->GetNbPackets()) {
+    return invalid_clock();
+  }
+
+  return q2d() * duration;
+}
+
 void Stream::RegisterPacket(const AVPacket* packet) {
   if (!packet || packet->size < 0) {
     return;
@@ -43,8 +43,6 @@ class PacketQueue;
 
 class Stream {
  public:
-  enum { minimum_frames = 25 };
-  bool HasEnoughPackets() const;
   virtual bool Open(int index, AVStream* av_stream_st);
   bool IsOpened() const;
   virtual void Close();
@@ -63,12 +61,15 @@ class Stream {
   void SetClockAt(clock64_t pts, clock64_t time);
   void SetClock(clock64_t pts);
   void SetPaused(bool pause);
+  void SetClockSpeed(double speed);
 
   clock64_t LastUpdatedClock() const;
 
   void SyncSerialClock();
 
   PacketQueue* GetQueue() const;
+  // msec of media in packet queue, invalid if queued packets have no duration
+  clock64_t GetBufferedDuration() const;
   bandwidth_t Bandwidth() const;
   DesireBytesPerSec DesireBandwith() const;
   size_t TotalDownloadedBytes() const;
@@ -0,0 +1,138 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/stream_reaper.h"
+
+#include <common/logger.h>                  // for INFO_LOG
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+#include "client/core/video_state.h"  // for VideoState
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+StreamReaper::StreamReaper()
+    : tid_(THREAD_MANAGER()->CreateThread(&StreamReaper::Run, this)),
+      mutex_(),
+      cond_(),
+      streams_(),
+      running_(false),
+      last_teardown_msec_(0),
+      max_teardown_msec_(0),
+      reaped_count_(0) {}
+
+StreamReaper::~StreamReaper() {
+  Stop();
+}
+
+bool StreamReaper::Start() {
+  {
+    common::unique_lock<common::mutex> lock(mutex_);
+    if (running_) {
+      return true;
+    }
+    running_ = true;
+  }
+
+  if (!tid_->Start()) {
+    common::unique_lock<common::mutex> lock(mutex_);
+    running_ = false;
+    return false;
+  }
+  return true;
+}
+
+void StreamReaper::Stop() {
+  {
+    common::unique_lock<common::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    cond_.notify_one();
+  }
+  tid_->Join();
+}
+
+void StreamReaper::Reap(VideoState* stream) {
+  if (!stream) {
+    return;
+  }
+
+  {
+    common::unique_lock<common::mutex> lock(mutex_);
+    if (running_) {
+      streams_.push_back(stream);
+      cond_.notify_one();
+      return;
+    }
+  }
+  Teardown(stream);
+}
+
+msec_t StreamReaper::GetLastTeardownTime() const {
+  return last_teardown_msec_;
+}
+
+msec_t StreamReaper::GetMaxTeardownTime() const {
+  return max_teardown_msec_;
+}
+
+size_t StreamReaper::GetReapedCount() const {
+  return reaped_count_;
+}
+
+int StreamReaper::Run() {
+  while (true) {
+    VideoState* stream = nullptr;
+    {
+      common::unique_lock<common::mutex> lock(mutex_);
+      while (running_ && streams_.empty()) {
+        cond_.wait(lock);
+      }
+      if (streams_.empty()) {  // stopped
+        return 0;
+      }
+      stream = streams_.front();
+      streams_.pop_front();
+    }
+    Teardown(stream);
+  }
+}
+
+void StreamReaper::Teardown(VideoState* stream) {
+  const msec_t start_ts = GetCurrentMsec();
+  const stream_id sid = stream->GetId();
+  stream->Abort();
+  delete stream;
+
+  const msec_t elapsed = GetCurrentMsec() - start_ts;
+  last_teardown_msec_ = elapsed;
+  if (elapsed > max_teardown_msec_) {
+    max_teardown_msec_ = elapsed;
+  }
+  reaped_count_++;
+  INFO_LOG() << "Stream " << sid << " teardown took " << elapsed << " msec.";
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,84 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <deque>  // for deque
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+#include <common/smart_ptr.h>
+#include <common/threads/types.h>  // for condition_variable, mutex
+
+#include "client/core/types.h"  // for msec_t
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+class VideoState;
+
+/*
+ * Aborts and frees streams on background thread,
+ * stalled inputs can take seconds to close and shouldn't block main loop on channel change.
+ */
+class StreamReaper {
+ public:
+  StreamReaper();
+  ~StreamReaper();
+
+  bool Start();
+  void Stop();  // frees not yet reaped streams
+
+  // takes ownership, frees in place if reaper isn't running
+  void Reap(VideoState* stream);
+
+  msec_t GetLastTeardownTime() const;
+  msec_t GetMaxTeardownTime() const;
+  size_t GetReapedCount() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(StreamReaper);
+
+  int Run();
+  void Teardown(VideoState* stream);
+
+  common::shared_ptr<common::threads::Thread<int> > tid_;
+  common::mutex mutex_;
+  common::condition_variable cond_;
+  std::deque<VideoState*> streams_;
+  bool running_;
+
+  common::atomic<msec_t> last_teardown_msec_;
+  common::atomic<msec_t> max_teardown_msec_;
+  common::atomic<size_t> reaped_count_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
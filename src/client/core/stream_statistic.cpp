@@ -18,6 +18,8 @@
 
 #include "client/core/stream_statistic.h"
 
+#include <cmath>  // for std::abs
+
 #define UNKNOWN_STREAM_TEXT "   "
 #define ONLY_VIDEO_TEXT "M-V"
 #define ONLY_AUDIO_TEXT "M-A"
@@ -32,6 +34,8 @@ Stats::Stats()
     : frame_drops_early(0),
       frame_drops_late(0),
       frame_processed(0),
+      frame_skips(0),
+      decoder_skip_level(0),
       master_pts(core::invalid_clock()),
       master_clock(core::invalid_clock()),
       audio_clock(core::invalid_clock()),
@@ -39,9 +43,25 @@ Stats::Stats()
       fmt(UNKNOWN_STREAM),
       audio_queue_size(0),
       video_queue_size(0),
+      audio_buffered(invalid_clock()),
+      video_buffered(invalid_clock()),
       video_bandwidth(0),
       audio_bandwidth(0),
       active_hwaccel(HWACCEL_NONE),
+      decoder_thread_count(0),
+      decoder_thread_type(0),
+      present_error(0),
+      present_error_avg(0),
+      live_latency(core::invalid_clock()),
+      live_latency_target(0),
+      live_speed(1.0),
+      live_jumps(0),
+      read_wakeups(0),
+      readahead_capacity(0),
+      readahead_filled(0),
+      readahead_stall_time(0),
+      readahead_stalls(0),
+      presented_count_(0),
       start_ts_(common::time::current_mstime()) {}
 
 clock64_t Stats::GetDiffStreams() const {
@@ -66,6 +86,12 @@ double Stats::GetFps() const {
   return fps_per_msec * 1000;
 }
 
+void Stats::RegisterPresentError(clock64_t error) {
+  present_error = error;
+  presented_count_++;
+  present_error_avg += (std::abs(static_cast<double>(error)) - present_error_avg) / presented_count_;
+}
+
 std::string ConvertStreamFormatToString(stream_format_t fmt) {
   if (fmt == (fasto::fastotv::client::core::HAVE_VIDEO_STREAM | fasto::fastotv::client::core::HAVE_AUDIO_STREAM)) {
     return VIDEO_AUDIO_TEXT;
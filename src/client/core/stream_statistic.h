@@ -18,7 +18,9 @@
 
 #pragma once
 
-#include "client/core/types.h"  // for clock64_t
+#include <stdint.h>  // for int64_t
+
+#include "client/core/types.h"  // for clock64_t, msec_t
 
 namespace fasto {
 namespace fastotv {
@@ -33,10 +35,13 @@ struct Stats {  // stream realtime statistic
 
   clock64_t GetDiffStreams() const;  // msec
   double GetFps() const;
+  void RegisterPresentError(clock64_t error);
 
   size_t frame_drops_early;
   size_t frame_drops_late;
   size_t frame_processed;
+  size_t frame_skips;       // not decoded at all, estimated from pts gaps
+  int decoder_skip_level;  // DECODER_SKIP_LEVEL
 
   clock64_t master_pts;
   clock64_t master_clock;  // msec
@@ -44,14 +49,34 @@ struct Stats {  // stream realtime statistic
   clock64_t video_clock;   // msec
   stream_format_t fmt;
 
-  int audio_queue_size;  // bytes
-  int video_queue_size;  // bytes
+  int64_t audio_queue_size;  // bytes
+  int64_t video_queue_size;  // bytes
+  clock64_t audio_buffered;  // msec of demuxed media, invalid if unknown
+  clock64_t video_buffered;  // msec of demuxed media, invalid if unknown
 
   bandwidth_t video_bandwidth;  // bytes/s
   bandwidth_t audio_bandwidth;  // bytes/s
   HWAccelID active_hwaccel;
+  int decoder_thread_count;  // video decoder
+  int decoder_thread_type;   // FF_THREAD_FRAME, FF_THREAD_SLICE, 0 - single thread
+
+  clock64_t present_error;   // msec, last picture on screen minus its deadline
+  double present_error_avg;  // msec, mean of absolute errors
+
+  clock64_t live_latency;         // msec behind last demuxed packet, invalid if not controlled
+  clock64_t live_latency_target;  // msec, 0 if not controlled
+  double live_speed;
+  size_t live_jumps;
+
+  size_t read_wakeups;  // read thread returns from parking, since stream open
+
+  size_t readahead_capacity;    // bytes, 0 if read ahead isn't used
+  size_t readahead_filled;      // bytes
+  msec_t readahead_stall_time;  // total msec demuxer waited for input
+  size_t readahead_stalls;
 
  private:
+  size_t presented_count_;
   const common::time64_t start_ts_;
 };
 
@@ -0,0 +1,92 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "client/core/swr_context_cache.h"
+
+extern "C" {
+#include <libswresample/swresample.h>  // for swr_alloc_set_opts, swr_free
+}
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+SwrContextCache::SwrContextCache(const AudioParams& target, size_t capacity)
+    : target_(target), capacity_(capacity ? capacity : 1), entries_(), tick_(0) {
+  entries_.reserve(capacity_);
+}
+
+SwrContextCache::~SwrContextCache() {
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    swr_free(&entries_[i].ctx);
+  }
+}
+
+SwrContext* SwrContextCache::Get(int64_t channel_layout, AVSampleFormat fmt, int freq) {
+  tick_++;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    Entry& entry = entries_[i];
+    if (entry.channel_layout == channel_layout && entry.fmt == fmt && entry.freq == freq) {
+      entry.last_used = tick_;
+      // samples buffered from previous activation belong to old segment
+      int64_t delay = swr_get_delay(entry.ctx, target_.freq);
+      if (delay > 0) {
+        swr_drop_output(entry.ctx, static_cast<int>(delay));
+      }
+      return entry.ctx;
+    }
+  }
+
+  SwrContext* ctx = swr_alloc_set_opts(NULL, target_.channel_layout, target_.fmt, target_.freq, channel_layout, fmt,
+                                       freq, 0, NULL);
+  if (!ctx || swr_init(ctx) < 0) {
+    swr_free(&ctx);
+    return NULL;
+  }
+
+  Entry entry = {channel_layout, fmt, freq, ctx, tick_};
+  if (entries_.size() < capacity_) {
+    entries_.push_back(entry);
+    return ctx;
+  }
+
+  size_t lru = 0;
+  for (size_t i = 1; i < entries_.size(); ++i) {
+    if (entries_[i].last_used < entries_[lru].last_used) {
+      lru = i;
+    }
+  }
+  swr_free(&entries_[lru].ctx);
+  entries_[lru] = entry;
+  return ctx;
+}
+
+void SwrContextCache::Remove(SwrContext* ctx) {
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (entries_[i].ctx == ctx) {
+      swr_free(&entries_[i].ctx);
+      entries_.erase(entries_.begin() + i);
+      return;
+    }
+  }
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,76 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for int64_t
+
+#include <vector>  // for vector
+
+extern "C" {
+#include <libavutil/samplefmt.h>  // for AVSampleFormat
+}
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+#include "client/core/audio_params.h"  // for AudioParams
+
+struct SwrContext;
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+/*
+ * Keeps initialized resamplers for the last few source formats, all converting to the same target,
+ * so streams which flip between stereo and 5.1 (ad breaks) switch converters without allocation.
+ * Owns returned contexts, they are valid until Remove or cache destruction.
+ */
+class SwrContextCache {
+ public:
+  enum { DEFAULT_CAPACITY = 4 };
+
+  explicit SwrContextCache(const AudioParams& target, size_t capacity = DEFAULT_CAPACITY);
+  ~SwrContextCache();
+
+  // NULL if converter can't be created, least recently used one is evicted when cache is full
+  SwrContext* Get(int64_t channel_layout, AVSampleFormat fmt, int freq);
+  void Remove(SwrContext* ctx);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SwrContextCache);
+
+  struct Entry {
+    int64_t channel_layout;
+    AVSampleFormat fmt;
+    int freq;
+    SwrContext* ctx;
+    size_t last_used;
+  };
+
+  const AudioParams target_;
+  const size_t capacity_;
+  std::vector<Entry> entries_;
+  size_t tick_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
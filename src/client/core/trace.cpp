@@ -0,0 +1,215 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/trace.h"
+
+#include <chrono>  // for steady_clock
+#include <vector>  // for vector
+
+#include <common/file_system.h>    // for ANSIFile
+#include <common/macros.h>         // for DISALLOW_COPY_AND_ASSIGN
+#include <common/threads/types.h>  // for mutex, atomic
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+namespace trace {
+
+namespace {
+
+struct Event {
+  const char* category;
+  const char* name;
+  int64_t ts;        // usec
+  int64_t duration;  // usec, < 0 for instant event
+  clock64_t pts;
+};
+
+// written only by owner thread, readers copy it and drop entries which could be overwritten meanwhile
+class ThreadBuffer {
+ public:
+  ThreadBuffer() : events_(new Event[TRACE_BUFFER_EVENTS]), written_(0), tid_(0), name_() {}
+  ~ThreadBuffer() { delete[] events_; }
+
+  void Add(const Event& event) {
+    const uint64_t index = written_.load(std::memory_order_relaxed);
+    events_[index % TRACE_BUFFER_EVENTS] = event;
+    written_.store(index + 1, std::memory_order_release);
+  }
+
+  void Copy(std::vector<Event>* out) const {
+    const uint64_t end = written_.load(std::memory_order_acquire);
+    const uint64_t begin = end > TRACE_BUFFER_EVENTS ? end - TRACE_BUFFER_EVENTS : 0;
+    std::vector<Event> events;
+    events.reserve(end - begin);
+    for (uint64_t i = begin; i < end; ++i) {
+      events.push_back(events_[i % TRACE_BUFFER_EVENTS]);
+    }
+
+    const uint64_t written = written_.load(std::memory_order_acquire);
+    const uint64_t valid_from = written >= TRACE_BUFFER_EVENTS ? written - TRACE_BUFFER_EVENTS + 1 : 0;
+    for (uint64_t i = begin; i < end; ++i) {
+      if (i >= valid_from) {
+        out->push_back(events[i - begin]);
+      }
+    }
+  }
+
+  void Reset(int tid) {
+    written_ = 0;
+    tid_ = tid;
+    name_.clear();
+  }
+
+  int GetTid() const { return tid_; }
+  const std::string& GetName() const { return name_; }
+  void SetName(const std::string& name) { name_ = name; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ThreadBuffer);
+
+  Event* const events_;
+  common::atomic<uint64_t> written_;
+  int tid_;           // guarded by registry mutex
+  std::string name_;  // guarded by registry mutex
+};
+
+// buffers of finished threads are kept for dump until new thread takes them
+class Registry {
+ public:
+  Registry() : mutex_(), buffers_(), free_buffers_(), last_tid_(0) {}
+
+  ThreadBuffer* Acquire() {
+    lock_t lock(mutex_);
+    ThreadBuffer* buffer = nullptr;
+    if (free_buffers_.empty()) {
+      buffer = new ThreadBuffer;
+      buffers_.push_back(buffer);
+    } else {
+      buffer = free_buffers_.front();
+      free_buffers_.erase(free_buffers_.begin());
+    }
+    buffer->Reset(++last_tid_);
+    return buffer;
+  }
+
+  void Release(ThreadBuffer* buffer) {
+    lock_t lock(mutex_);
+    free_buffers_.push_back(buffer);
+  }
+
+  void SetName(ThreadBuffer* buffer, const char* name) {
+    lock_t lock(mutex_);
+    buffer->SetName(name);
+  }
+
+  common::Error Dump(const std::string& path) {
+    common::file_system::ascii_string_path trace_path(path);
+    common::file_system::ANSIFile trace_file(trace_path);
+    common::ErrnoError err = trace_file.Open("w");
+    if (err && err->IsError()) {
+      return err;
+    }
+
+    lock_t lock(mutex_);
+    trace_file.Write("{\"traceEvents\":[\n");
+    bool first = true;
+    std::vector<Event> events;
+    for (ThreadBuffer* buffer : buffers_) {
+      const int tid = buffer->GetTid();
+      const std::string name = buffer->GetName().empty() ? "thread " + std::to_string(tid) : buffer->GetName();
+      trace_file.WriteFormated("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,",
+                               first ? "" : ",\n", tid);
+      trace_file.WriteFormated("\"args\":{\"name\":\"%s\"}}", name.c_str());
+      first = false;
+
+      events.clear();
+      buffer->Copy(&events);
+      for (const Event& event : events) {
+        trace_file.WriteFormated(",\n{\"cat\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%lld", event.category,
+                                 event.name, tid, static_cast<long long>(event.ts));
+        if (event.duration < 0) {
+          trace_file.Write(",\"ph\":\"i\",\"s\":\"t\"");
+        } else {
+          trace_file.WriteFormated(",\"ph\":\"X\",\"dur\":%lld", static_cast<long long>(event.duration));
+        }
+        if (IsValidClock(event.pts)) {
+          trace_file.WriteFormated(",\"args\":{\"pts\":%lld}", static_cast<long long>(event.pts));
+        }
+        trace_file.Write("}");
+      }
+    }
+    trace_file.Write("\n]}\n");
+    trace_file.Close();
+    return common::Error();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(Registry);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  common::mutex mutex_;
+  std::vector<ThreadBuffer*> buffers_;
+  std::vector<ThreadBuffer*> free_buffers_;
+  int last_tid_;
+};
+
+Registry* GetRegistry() {
+  static Registry* registry = new Registry;  // never destroyed, threads can outlive statics
+  return registry;
+}
+
+struct ThreadSlot {
+  ThreadSlot() : buffer(GetRegistry()->Acquire()) {}
+  ~ThreadSlot() { GetRegistry()->Release(buffer); }
+
+  ThreadBuffer* const buffer;
+};
+
+ThreadBuffer* GetThreadBuffer() {
+  static thread_local ThreadSlot slot;
+  return slot.buffer;
+}
+
+const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+}  // namespace
+
+int64_t GetTraceTime() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+void SetThreadName(const char* name) {
+  GetRegistry()->SetName(GetThreadBuffer(), name);
+}
+
+void AddEvent(const char* category, const char* name, int64_t ts, int64_t duration, clock64_t pts) {
+  Event event = {category, name, ts, duration, pts};
+  GetThreadBuffer()->Add(event);
+}
+
+common::Error DumpTrace(const std::string& path) {
+  return GetRegistry()->Dump(path);
+}
+
+}  // namespace trace
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,70 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>  // for int64_t
+
+#include <string>  // for std::string
+
+#include <common/error.h>  // for Error
+
+#include "client/core/types.h"  // for clock64_t
+
+#define TRACE_BUFFER_EVENTS 16384  // per thread, the oldest events are overwritten
+
+/*
+ * Pipeline trace points, compiled in only with HAVE_TRACING (DEVELOPER_ENABLE_TRACING cmake option).
+ * Every thread writes into own ring buffer without locks, DumpTrace writes all buffers
+ * in Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+ *
+ * TRACE_BEGIN(start);
+ * int ret = av_read_frame(ic, pkt);
+ * TRACE_END(start, "demux", "read_frame", pts);
+ */
+#if defined(HAVE_TRACING)
+#define TRACE_NS fasto::fastotv::client::core::trace
+#define TRACE_THREAD_NAME(name) TRACE_NS::SetThreadName(name)
+#define TRACE_BEGIN(var) const int64_t var = TRACE_NS::GetTraceTime()
+#define TRACE_END(var, category, name, pts) TRACE_NS::AddEvent(category, name, var, TRACE_NS::GetTraceTime() - var, pts)
+#define TRACE_INSTANT(category, name, pts) TRACE_NS::AddEvent(category, name, TRACE_NS::GetTraceTime(), -1, pts)
+#else
+#define TRACE_THREAD_NAME(name)
+#define TRACE_BEGIN(var)
+#define TRACE_END(var, category, name, pts)
+#define TRACE_INSTANT(category, name, pts)
+#endif
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+namespace trace {
+
+int64_t GetTraceTime();  // usec
+void SetThreadName(const char* name);
+// category and name should be string literals, duration < 0 for instant event
+void AddEvent(const char* category, const char* name, int64_t ts, int64_t duration, clock64_t pts);
+
+common::Error DumpTrace(const std::string& path);
+
+}  // namespace trace
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
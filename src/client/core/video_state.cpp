@@ -21,7 +21,7 @@
 #include <errno.h>             // for ENOMEM, EINVAL, EAGAIN
 #include <inttypes.h>          // for PRIx64
 #include <math.h>              // for fabs, exp, log
-#include <stdio.h>             // for snprintf
+#include <stdio.h>             // for snprintf, remove
 #include <stdlib.h>            // for NULL, abs, calloc, free
 #include <string.h>            // for memset, strcmp, strlen
 #include <condition_variable>  // for cv_status, cv_status::...
@@ -34,6 +34,7 @@ extern "C" {
 #include <libavutil/avutil.h>          // for AVMediaType::AVMEDIA_T...
 #include <libavutil/buffer.h>          // for av_buffer_ref
 #include <libavutil/channel_layout.h>  // for av_get_channel_layout_...
+#include <libavutil/cpu.h>             // for av_cpu_count
 #include <libavutil/dict.h>            // for av_dict_free, av_dict_get
 #include <libavutil/error.h>           // for AVERROR, AVERROR_EOF
 #include <libavutil/mathematics.h>     // for av_compare_ts, av_resc...
@@ -44,6 +45,7 @@ extern "C" {
 #include <libavutil/rational.h>        // for AVRational
 #include <libavutil/samplefmt.h>       // for AVSampleFormat, av_sam...
 #include <libswresample/swresample.h>  // for swr_free, swr_init
+#include <libswscale/version.h>        // for LIBSWSCALE_VERSION_INT
 
 #if CONFIG_AVFILTER
 #include <libavfilter/avfilter.h>    // for avfilter_graph_free
@@ -62,14 +64,25 @@ extern "C" {
 #include "ffmpeg_internal.h"
 
 #include "client/core/app_options.h"  // for ComplexOptions, AppOpt...
+#include "client/core/audio_mix.h"    // for ScaleAudio
 #include "client/core/av_utils.h"
 #include "client/core/bandwidth_estimation.h"  // for DesireBytesPerSec
+#include "client/core/buffering_policy.h"      // for BufferingPolicy
 #include "client/core/decoder.h"               // for VideoDecoder, AudioDec...
+#include "client/core/decoder_skip.h"          // for DecoderSkipController
+#include "client/core/decoder_threading.h"     // for CalcDecoderThreading
 #include "client/core/events/stream_events.h"  // for QuitStreamEvent, Alloc...
+#include "client/core/frame_queue_policy.h"    // for FrameQueueAdapter
+#include "client/core/latency_controller.h"    // for LatencyController
 #include "client/core/packet_queue.h"          // for PacketQueue
+#include "client/core/prewarm_buffer.h"        // for PrewarmBuffer
+#include "client/core/probe_info.h"            // for ProbeInfo
+#include "client/core/read_ahead_io.h"         // for ReadAheadIO
 #include "client/core/sdl_utils.h"
-#include "client/core/stream.h"  // for AudioStream, VideoStream
-#include "client/core/types.h"   // for clock64_t, IsValidClock
+#include "client/core/stream.h"             // for AudioStream, VideoStream
+#include "client/core/swr_context_cache.h"  // for SwrContextCache
+#include "client/core/trace.h"              // for TRACE_BEGIN, TRACE_END
+#include "client/core/types.h"              // for clock64_t, IsValidClock
 #include "client/core/video_state_handler.h"
 
 #include "client/core/frames/audio_frame.h"  // for AudioFrame
@@ -89,10 +102,11 @@ extern "C" {
 #define SAMPLE_CORRECTION_PERCENT_MAX 10
 /* we use about AUDIO_DIFF_AVG_NB A-V differences to make the average */
 #define AUDIO_DIFF_AVG_NB 20
+/* resampled audio buffer is allocated once for this many output samples, bigger frames grow it */
+#define AUDIO_BUFFER_ARENA_SAMPLES 16384
 
-/* NOTE: the size must be big enough to compensate the hardware audio buffersize size */
-/* TODO: We assume that a decoded and resampled frame fits into this buffer */
-#define MAX_QUEUE_SIZE (15 * 1024 * 1024)
+/* read thread is notified by queues, seek, pause and abort, this only covers the rest */
+#define READ_IDLE_WAKEUP_MSEC 1000
 
 #define EXIT_LOOKUP_IF_HWACCEL_FAILED 0
 
@@ -122,6 +136,31 @@ namespace core {
 
 namespace {
 
+// process wide, video threads of switched channels may overlap
+common::atomic<uint64_t> last_picture_id(0);
+
+uint64_t pack_size(const Size& size) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(size.width)) << 32) | static_cast<uint32_t>(size.height);
+}
+
+#if CONFIG_AVFILTER
+#define SCALE_MAX_THREADS 4
+
+Size unpack_size(uint64_t packed) {
+  return Size(static_cast<int32_t>(packed >> 32), static_cast<int32_t>(packed & 0xFFFFFFFF));
+}
+
+// vf_scale expressions which fit picture into display like calculate_display_rect, but never upscale;
+// scale keeps display aspect ratio by adjusting sar of output frames
+std::string make_scale_width_expr(const Size& display_size) {
+  return common::MemSPrintf("min(iw,max(2,trunc(min(%d,%d*dar)/2)*2))", display_size.width, display_size.height);
+}
+
+std::string make_scale_height_expr(const Size& display_size) {
+  return common::MemSPrintf("min(ih,max(2,trunc(min(%d,%d/dar)/2)*2))", display_size.height, display_size.width);
+}
+#endif
+
 enum AVPixelFormat get_format(AVCodecContext* s, const enum AVPixelFormat* pix_fmts) {
   InputStream* ist = static_cast<InputStream*>(s->opaque);
   const enum AVPixelFormat* p;
@@ -194,12 +233,18 @@ VideoState::VideoState(stream_id id,
       read_pause_return_(0),
       ic_(NULL),
       realtime_(false),
+      live_latency_(nullptr),
+      read_ahead_(nullptr),
+      decoder_skip_(nullptr),
+      decoder_skip_flushes_(0),
+      last_read_pts_(invalid_clock()),
       vstream_(new VideoStream),
       astream_(new AudioStream),
       viddec_(nullptr),
       auddec_(nullptr),
       video_frame_queue_(nullptr),
       audio_frame_queue_(nullptr),
+      video_queue_adapter_(nullptr),
       audio_clock_(0),
       audio_diff_cum_(0),
       audio_diff_avg_coef_(0),
@@ -217,8 +262,12 @@ VideoState::VideoState(stream_id id,
       audio_filter_src_(),
 #endif
       audio_tgt_(),
+      swr_cache_(NULL),
       swr_ctx_(NULL),
       frame_timer_(0),
+      next_frame_deadline_(invalid_clock()),
+      present_deadline_(invalid_clock()),
+      present_lead_(0),
       frame_last_returned_time_(0),
       frame_last_filter_delay_(0),
       max_frame_duration_(0),
@@ -226,6 +275,7 @@ VideoState::VideoState(stream_id id,
 #if CONFIG_AVFILTER
       in_video_filter_(NULL),
       out_video_filter_(NULL),
+      scale_video_filter_(NULL),
       in_audio_filter_(NULL),
       out_audio_filter_(NULL),
       agraph_(NULL),
@@ -238,15 +288,21 @@ VideoState::VideoState(stream_id id,
       last_paused_(false),
       eof_(false),
       abort_request_(false),
+      warm_(false),
+      warm_max_buffer_bytes_(0),
+      warm_max_bandwidth_(0),
+      decoder_thread_count_(0),
+      decoder_thread_type_(0),
       stats_(new Stats),
+      render_pix_fmts_({AV_PIX_FMT_YUV420P, AV_PIX_FMT_BGRA, AV_PIX_FMT_NONE}),
+      display_size_(0),
       handler_(handler),
       input_st_(static_cast<InputStream*>(calloc(1, sizeof(InputStream)))),
       seek_req_(false),
       seek_pos_(0),
       seek_rel_(0),
       seek_flags_(0),
-      read_thread_cond_(),
-      read_thread_mutex_() {
+      read_wakeup_() {
   CHECK(handler_);
   CHECK(id_ != invalid_stream_id);
 
@@ -261,9 +317,24 @@ VideoState::VideoState(stream_id id,
   } else {
     input_st_->hwaccel_output_format = AV_PIX_FMT_NONE;
   }
+
+  if (opt_.live_latency > 0) {
+    live_latency_ = new LatencyController(opt_.live_latency);
+  }
+  if (opt_.decoder_skip) {
+    decoder_skip_ = new DecoderSkipController;
+  }
+  if (opt_.readahead_size > 0) {
+    const AVIOInterruptCB interrupt_cb = {decode_interrupt_callback, this};
+    read_ahead_ = new ReadAheadIO(static_cast<size_t>(opt_.readahead_size) * 1024, interrupt_cb);
+  }
 }
 
 VideoState::~VideoState() {
+  destroy(&read_ahead_);
+  destroy(&decoder_skip_);
+  destroy(&swr_cache_);
+  destroy(&live_latency_);
   destroy(&astream_);
   destroy(&vstream_);
 
@@ -344,10 +415,14 @@ int VideoState::StreamComponentOpen(int stream_index) {
     avctx->get_format = get_format;
     avctx->get_buffer2 = get_buffer;
     avctx->thread_safe_callbacks = 1;
+    const DecoderThreading threading = CalcDecoderThreading(opt_, codec, av_guess_frame_rate(ic_, stream, NULL));
+    avctx->thread_count = threading.thread_count;
+    avctx->thread_type = threading.thread_type;
   }
 
   AVDictionary* opts = filter_codec_opts(copt_.codec_opts, avctx->codec_id, ic_, stream, codec);
-  if (!av_dict_get(opts, "threads", NULL, 0)) {
+  // "threads" from codec options still overrides video threading policy
+  if (avctx->codec_type != AVMEDIA_TYPE_VIDEO && !av_dict_get(opts, "threads", NULL, 0)) {
     av_dict_set(&opts, "threads", "auto", 0);
   }
   if (stream_lowres) {
@@ -377,10 +452,18 @@ int VideoState::StreamComponentOpen(int stream_index) {
   stream->discard = AVDISCARD_DEFAULT;
   if (avctx->codec_type == AVMEDIA_TYPE_VIDEO) {
     AVRational frame_rate = av_guess_frame_rate(ic_, stream, NULL);
+    decoder_thread_count_ = avctx->thread_count;
+    decoder_thread_type_ = avctx->active_thread_type;
+    DEBUG_LOG() << "Video decoder threads: " << avctx->thread_count << ", type: " << avctx->active_thread_type;
     bool opened = vstream_->Open(stream_index, stream, frame_rate);
     UNUSED(opened);
     PacketQueue* packet_queue = vstream_->GetQueue();
-    video_frame_queue_ = new video_frame_queue_t;
+    const FrameQueueLimits limits =
+        CalcVideoFrameQueueLimits(opt_, avctx->width, avctx->height, avctx->pix_fmt, frame_rate);
+    DEBUG_LOG() << "Video frame queue size: " << limits.initial_size << " [" << limits.min_size << ", "
+                << limits.max_size << "]";
+    video_frame_queue_ = new video_frame_queue_t(limits.max_size, limits.initial_size);
+    video_queue_adapter_ = new FrameQueueAdapter(limits);
     viddec_ = new VideoDecoder(avctx, packet_queue);
     viddec_->Start();
     if (!vdecoder_tid_->Start()) {
@@ -424,6 +507,12 @@ int VideoState::StreamComponentOpen(int stream_index) {
     audio_src_ = audio_tgt_;
     audio_buf_size_ = 0;
     audio_buf_index_ = 0;
+    swr_cache_ = new SwrContextCache(audio_tgt_);
+    int arena_size =
+        av_samples_get_buffer_size(NULL, audio_tgt_.channels, AUDIO_BUFFER_ARENA_SAMPLES, audio_tgt_.fmt, 0);
+    if (arena_size > 0) {
+      av_fast_malloc(&audio_buf1_, &audio_buf1_size_, arena_size);
+    }
 
     /* init averaging filter */
     audio_diff_avg_coef_ = exp(log(0.01) / AUDIO_DIFF_AVG_NB);
@@ -436,7 +525,8 @@ int VideoState::StreamComponentOpen(int stream_index) {
     bool opened = astream_->Open(stream_index, stream);
     UNUSED(opened);
     PacketQueue* packet_queue = astream_->GetQueue();
-    audio_frame_queue_ = new audio_frame_queue_t;
+    const FrameQueueLimits limits = CalcAudioFrameQueueLimits(opt_, sample_rate, avctx->frame_size);
+    audio_frame_queue_ = new audio_frame_queue_t(limits.max_size, limits.initial_size);
     auddec_ = new AudioDecoder(avctx, packet_queue);
     if ((ic_->iformat->flags & (AVFMT_NOBINSEARCH | AVFMT_NOGENSEARCH | AVFMT_NO_BYTE_SEEK)) &&
         !ic_->iformat->read_seek) {
@@ -477,6 +567,7 @@ void VideoState::StreamComponentClose(int stream_index) {
     }
     destroy(&viddec_);
     destroy(&video_frame_queue_);
+    destroy(&video_queue_adapter_);
   } else if (codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
     if (audio_frame_queue_) {
       audio_frame_queue_->Stop();
@@ -488,7 +579,8 @@ void VideoState::StreamComponentClose(int stream_index) {
     }
     destroy(&auddec_);
     destroy(&audio_frame_queue_);
-    swr_free(&swr_ctx_);
+    swr_ctx_ = NULL;
+    destroy(&swr_cache_);
     av_freep(&audio_buf1_);
     audio_buf1_size_ = 0;
     audio_buf_ = NULL;
@@ -562,7 +654,7 @@ void VideoState::StreamSeek(int64_t pos, int64_t rel, bool seek_by_bytes) {
     seek_flags_ |= AVSEEK_FLAG_BYTE;
   }
   seek_req_ = true;
-  read_thread_cond_.notify_one();
+  read_wakeup_.Notify();
 }
 
 void VideoState::Seek(clock64_t msec) {
@@ -658,6 +750,30 @@ clock64_t VideoState::GetMasterClock() const {
   return astream_->GetClock();
 }
 
+bool VideoState::IsLiveLatencyControlled() const {
+  return live_latency_ && realtime_;
+}
+
+double VideoState::UpdateLiveLatency() {
+  const clock64_t master_clock = GetMasterClock();
+  const clock64_t last_read_pts = last_read_pts_;
+  clock64_t latency = invalid_clock();
+  if (IsValidClock(master_clock) && IsValidClock(last_read_pts)) {
+    latency = last_read_pts - master_clock;
+  }
+
+  const double speed = live_latency_->Update(latency, GetRealClockTime());
+  if (live_latency_->IsJumpRequested()) {
+    read_wakeup_.Notify();
+  }
+  if (GetMasterSyncType() == AV_SYNC_VIDEO_MASTER) {
+    vstream_->SetClockSpeed(speed);
+  } else {
+    astream_->SetClockSpeed(speed);
+  }
+  return speed;
+}
+
 int VideoState::Exec() {
   bool started = read_tid_->Start();
   if (!started) {
@@ -669,9 +785,20 @@ int VideoState::Exec() {
 
 void VideoState::Abort() {
   abort_request_ = true;
+  // read thread can be parked on full packet queue
+  if (vstream_) {
+    vstream_->GetQueue()->Abort();
+  }
+  if (astream_) {
+    astream_->GetQueue()->Abort();
+  }
+  read_wakeup_.Notify();
   read_tid_->Join();
   Close();
   avformat_close_input(&ic_);
+  if (read_ahead_) {  // demuxer doesn't close custom I/O
+    read_ahead_->Close();
+  }
 }
 
 bool VideoState::IsReadThread() const {
@@ -726,6 +853,7 @@ void VideoState::RefreshRequest() {
 void VideoState::TogglePause() {
   StreamTogglePause();
   step_ = false;
+  read_wakeup_.Notify();
 }
 
 bool VideoState::IsPaused() const {
@@ -823,9 +951,48 @@ bool VideoState::RequestVideo(int width, int height, int av_pixel_format, AVRati
   return handler_->HandleRequestVideo(this, width, height, av_pixel_format, aspect_ratio);
 }
 
+void VideoState::SetRenderPixelFormats(const std::vector<AVPixelFormat>& pix_fmts) {
+  if (pix_fmts.empty()) {
+    return;
+  }
+
+  render_pix_fmts_ = pix_fmts;
+  if (render_pix_fmts_.back() != AV_PIX_FMT_NONE) {
+    render_pix_fmts_.push_back(AV_PIX_FMT_NONE);
+  }
+}
+
+void VideoState::SetDisplaySize(const Size& size) {
+  display_size_ = pack_size(size);
+}
+
+void VideoState::SetWarm(size_t max_buffer_bytes, bandwidth_t max_bandwidth) {
+  warm_max_buffer_bytes_ = max_buffer_bytes;
+  warm_max_bandwidth_ = max_bandwidth;
+  warm_ = true;
+}
+
+bool VideoState::IsWarm() const {
+  return warm_;
+}
+
+void VideoState::Promote() {
+  warm_ = false;
+  // WakeupEvent keeps the signal if read thread is not parked yet, and notifies under its mutex if it is
+  read_wakeup_.Notify();
+}
+
 int VideoState::SynchronizeAudio(int nb_samples) {
   int wanted_nb_samples = nb_samples;
 
+  /* if master on live stream, then resample to play faster or slower and keep distance to the live edge */
+  if (GetMasterSyncType() == AV_SYNC_AUDIO_MASTER && IsLiveLatencyControlled()) {
+    const double speed = UpdateLiveLatency();
+    if (speed != 1.0) {
+      wanted_nb_samples = static_cast<int>(nb_samples / speed);
+    }
+  }
+
   /* if not master, then we try to remove or add samples to correct the clock */
   if (GetMasterSyncType() != AV_SYNC_AUDIO_MASTER) {
     clock64_t diff = astream_->GetClock() - GetMasterClock();
@@ -884,15 +1051,12 @@ int VideoState::AudioDecodeFrame() {
 
   if (af->frame->format != audio_src_.fmt || dec_channel_layout != audio_src_.channel_layout ||
       af->frame->sample_rate != audio_src_.freq || (wanted_nb_samples != af->frame->nb_samples && !swr_ctx_)) {
-    swr_free(&swr_ctx_);
-    swr_ctx_ = swr_alloc_set_opts(NULL, audio_tgt_.channel_layout, audio_tgt_.fmt, audio_tgt_.freq, dec_channel_layout,
-                                  sample_fmt, af->frame->sample_rate, 0, NULL);
-    if (!swr_ctx_ || swr_init(swr_ctx_) < 0) {
+    swr_ctx_ = swr_cache_->Get(dec_channel_layout, sample_fmt, af->frame->sample_rate);
+    if (!swr_ctx_) {
       ERROR_LOG() << "Cannot create sample rate converter for conversion of " << af->frame->sample_rate << " Hz "
                   << av_get_sample_fmt_name(sample_fmt) << " " << av_frame_get_channels(af->frame) << " channels to "
                   << audio_tgt_.freq << " Hz " << av_get_sample_fmt_name(audio_tgt_.fmt) << " " << audio_tgt_.channels
                   << " channels!";
-      swr_free(&swr_ctx_);
       return ERROR_RESULT_VALUE;
     }
     audio_src_.channel_layout = dec_channel_layout;
@@ -931,7 +1095,8 @@ int VideoState::AudioDecodeFrame() {
     if (len2 == out_count) {
       WARNING_LOG() << "audio buffer is probably too small";
       if (swr_init(swr_ctx_) < 0) {
-        swr_free(&swr_ctx_);
+        swr_cache_->Remove(swr_ctx_);
+        swr_ctx_ = NULL;
       }
     }
     audio_buf_ = audio_buf1_;
@@ -953,6 +1118,7 @@ int VideoState::AudioDecodeFrame() {
 }
 
 frames::VideoFrame* VideoState::GetVideoFrame() {
+  next_frame_deadline_ = invalid_clock();
 retry:
   if (video_frame_queue_->IsEmpty()) {
     return nullptr;
@@ -972,10 +1138,15 @@ retry:
 
   /* compute nominal last_duration */
   clock64_t last_duration = CalcDurationBetweenVideoFrames(lastvp, firstvp, max_frame_duration_);
+  if (IsLiveLatencyControlled()) {
+    const double speed = GetMasterSyncType() == AV_SYNC_VIDEO_MASTER ? UpdateLiveLatency() : live_latency_->GetSpeed();
+    last_duration = last_duration / speed;
+  }
   clock64_t delay = ComputeTargetDelay(last_duration);
-  clock64_t time = GetRealClockTime();
+  clock64_t time = GetRealClockTime() + present_lead_;  // when picture selected now will be on the screen
   clock64_t next_frame_ts = frame_timer_ + delay;
   if (time < next_frame_ts) {
+    next_frame_deadline_ = next_frame_ts - present_lead_;
     return SelectVideoFrame();
   }
 
@@ -1005,9 +1176,12 @@ retry:
         goto retry;
       }
     }
+    // nominal, corrected by sync on the next call
+    next_frame_deadline_ = frame_timer_ + duration - present_lead_;
   }
 
   video_frame_queue_->Pop();
+  present_deadline_ = frame_timer_;
   force_refresh_ = true;
   if (step_ && !paused_) {
     StreamTogglePause();
@@ -1039,7 +1213,7 @@ frames::VideoFrame* VideoState::TryToGetVideoFrame() {
   PacketQueue* video_packet_queue = vstream_->GetQueue();
   PacketQueue* audio_packet_queue = astream_->GetQueue();
 
-  int aqsize = 0, vqsize = 0;
+  int64_t aqsize = 0, vqsize = 0;
   bandwidth_t video_bandwidth = 0, audio_bandwidth = 0;
   if (is_video_open) {
     vqsize = video_packet_queue->GetSize();
@@ -1059,9 +1233,29 @@ frames::VideoFrame* VideoState::TryToGetVideoFrame() {
                     : (is_video_open ? HAVE_VIDEO_STREAM : (is_audio_open ? HAVE_AUDIO_STREAM : UNKNOWN_STREAM));
   stats_->audio_queue_size = aqsize;
   stats_->video_queue_size = vqsize;
+  stats_->audio_buffered = is_audio_open ? astream_->GetBufferedDuration() : invalid_clock();
+  stats_->video_buffered = is_video_open ? vstream_->GetBufferedDuration() : invalid_clock();
   stats_->audio_bandwidth = audio_bandwidth;
   stats_->video_bandwidth = video_bandwidth;
   stats_->active_hwaccel = input_st_->active_hwaccel_id;
+  stats_->decoder_thread_count = decoder_thread_count_;
+  stats_->decoder_thread_type = decoder_thread_type_;
+  if (IsLiveLatencyControlled()) {
+    stats_->live_latency = live_latency_->GetLatency();
+    stats_->live_latency_target = live_latency_->GetTarget();
+    stats_->live_speed = live_latency_->GetSpeed();
+    stats_->live_jumps = live_latency_->GetJumpsCount();
+  }
+  if (decoder_skip_) {
+    stats_->decoder_skip_level = decoder_skip_->GetLevel();
+    stats_->frame_skips = decoder_skip_->GetSkippedFrames();
+  }
+  if (read_ahead_ && read_ahead_->IsOpened()) {
+    stats_->readahead_capacity = read_ahead_->GetCapacity();
+    stats_->readahead_filled = read_ahead_->GetFilled();
+    stats_->readahead_stall_time = read_ahead_->GetStallTime();
+    stats_->readahead_stalls = read_ahead_->GetStallsCount();
+  }
 
   if (is_video_open && video_frame_queue_) {
     frames::VideoFrame* fr = GetVideoFrame();
@@ -1072,6 +1266,27 @@ frames::VideoFrame* VideoState::TryToGetVideoFrame() {
   return nullptr;
 }
 
+clock64_t VideoState::GetNextFrameDeadline() const {
+  if (paused_) {
+    return invalid_clock();
+  }
+
+  return next_frame_deadline_;
+}
+
+void VideoState::SetPresentLead(clock64_t lead) {
+  present_lead_ = lead;
+}
+
+void VideoState::RegisterPresentation(clock64_t present_time) {
+  if (!IsValidClock(present_deadline_)) {
+    return;
+  }
+
+  stats_->RegisterPresentError(present_time - present_deadline_);
+  present_deadline_ = invalid_clock();
+}
+
 VideoState::stats_t VideoState::GetStatistic() const {
   return stats_;
 }
@@ -1085,6 +1300,7 @@ void VideoState::UpdateAudioBuffer(uint8_t* stream, int len, int audio_volume) {
     return;
   }
 
+  TRACE_BEGIN(callback_start);
   const clock64_t audio_callback_time = GetRealClockTime();
   while (len > 0) {
     if (audio_buf_index_ >= audio_buf_size_) {
@@ -1102,13 +1318,13 @@ void VideoState::UpdateAudioBuffer(uint8_t* stream, int len, int audio_volume) {
     if (len1 > len) {
       len1 = len;
     }
-    if (audio_buf_ && audio_volume == 100) {
+    if (!audio_buf_) {
+      memset(stream, 0, len1);
+    } else if (audio_volume == 100) {
       memcpy(stream, audio_buf_ + audio_buf_index_, len1);
-    } else {
+    } else if (!ScaleAudio(stream, audio_buf_ + audio_buf_index_, len1, audio_tgt_.fmt,
+                           ConvertToMixVolume(audio_volume))) {
       memset(stream, 0, len1);
-      if (audio_buf_) {
-        handler_->HanleAudioMix(stream, audio_buf_ + audio_buf_index_, len1, audio_volume);
-      }
     }
     len -= len1;
     stream += len1;
@@ -1122,9 +1338,11 @@ void VideoState::UpdateAudioBuffer(uint8_t* stream, int len, int audio_volume) {
     const clock64_t pts = audio_clock_ - clc;
     astream_->SetClockAt(pts, audio_callback_time);
   }
+  TRACE_END(callback_start, "audio", "audio_callback", audio_clock_);
 }
 
 int VideoState::QueuePicture(AVFrame* src_frame, clock64_t pts, clock64_t duration, int64_t pos) {
+  TRACE_BEGIN(queue_start);
   frames::VideoFrame* vp = video_frame_queue_->GetPeekWritable();
   if (!vp) {
     return ERROR_RESULT_VALUE;
@@ -1144,9 +1362,11 @@ int VideoState::QueuePicture(AVFrame* src_frame, clock64_t pts, clock64_t durati
   vp->pts = pts;
   vp->duration = duration;
   vp->pos = pos;
+  vp->picture_id = ++last_picture_id;
 
   av_frame_move_ref(vp->frame, src_frame);
   video_frame_queue_->Push();
+  TRACE_END(queue_start, "video", "queue_picture", pts);
   return SUCCESS_RESULT_VALUE;
 }
 
@@ -1156,9 +1376,48 @@ int VideoState::GetVideoFrame(AVFrame* frame) {
     return ERROR_RESULT_VALUE;
   }
 
+  if (decoder_skip_ && decoder_skip_flushes_ != viddec_->GetFlushesCount()) {  // seek or live jump
+    decoder_skip_flushes_ = viddec_->GetFlushesCount();
+    decoder_skip_->Reset();
+    AVCodecContext* avctx = viddec_->GetAvCtx();
+    avctx->skip_frame = ConvertDecoderSkipLevelToDiscard(DECODER_SKIP_NONE);
+    avctx->skip_loop_filter = avctx->skip_frame;
+  }
+
   if (got_picture) {
+    AVRational frame_rate = vstream_->GetFrameRate();
+    clock64_t frame_duration = 0;
+    if (frame_rate.num && frame_rate.den) {
+      AVRational fr = {frame_rate.den, frame_rate.num};
+      frame_duration = q2d_diff(fr);
+      const size_t capacity = video_queue_adapter_->RegisterFrame(viddec_->GetDecodeTime(), frame_duration);
+      if (capacity != video_frame_queue_->GetCapacity()) {
+        DEBUG_LOG() << "Video frame queue resized to: " << capacity
+                    << ", decode jitter: " << video_queue_adapter_->GetJitter() << " msec";
+        video_frame_queue_->SetCapacity(capacity);
+      }
+    }
     frame->sample_aspect_ratio = vstream_->StableAspectRatio(frame);
 
+    if (decoder_skip_ && IsValidPts(frame->pts) && GetMasterSyncType() != AV_SYNC_VIDEO_MASTER) {
+      const clock64_t dpts = vstream_->q2d() * frame->pts;
+      const clock64_t master_clock = GetMasterClock();
+      clock64_t lag = invalid_clock();
+      if (IsValidClock(master_clock) && std::abs(master_clock - dpts) < AV_NOSYNC_THRESHOLD_MSEC) {
+        lag = master_clock - dpts;
+      }
+      const DECODER_SKIP_LEVEL prev_level = decoder_skip_->GetLevel();
+      const DECODER_SKIP_LEVEL level = decoder_skip_->Update(lag, GetRealClockTime());
+      if (level != prev_level) {
+        AVCodecContext* avctx = viddec_->GetAvCtx();
+        avctx->skip_frame = ConvertDecoderSkipLevelToDiscard(level);
+        avctx->skip_loop_filter = avctx->skip_frame;
+        INFO_LOG() << "Video decoder of " << id_ << " skip level changed to: " << ConvertDecoderSkipLevelToString(level)
+                   << ", lag: " << lag << " msec.";
+      }
+      decoder_skip_->RegisterFrame(dpts, frame_duration);
+    }
+
     if (opt_.framedrop == FRAME_DROP_AUTO || (opt_.framedrop || GetMasterSyncType() != AV_SYNC_VIDEO_MASTER)) {
       if (IsValidPts(frame->pts)) {
         clock64_t dpts = vstream_->q2d() * frame->pts;
@@ -1179,6 +1438,7 @@ int VideoState::GetVideoFrame(AVFrame* frame) {
 
 /* this thread gets the stream from the disk or the network */
 int VideoState::ReadThread() {
+  TRACE_THREAD_NAME("read");
   AVFormatContext* ic = avformat_alloc_context();
   if (!ic) {
     const int av_errno = AVERROR(ENOMEM);
@@ -1203,6 +1463,17 @@ int VideoState::ReadThread() {
     scan_all_pmts_set = true;
   }
 
+  if (read_ahead_ && ReadAheadIO::IsSupported(uri_str)) {
+    int read_ahead_result = read_ahead_->Open(uri_str, copt_.format_opts);
+    if (read_ahead_result < 0) {
+      WARNING_LOG() << "Read ahead of " << id_ << " disabled, open error: "
+                    << ffmpeg_errno_to_string(read_ahead_result);
+    } else {
+      ic->pb = read_ahead_->GetContext();
+      ic->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+  }
+
   int open_result = avformat_open_input(&ic, in_filename, NULL, &copt_.format_opts);  // autodetect format
   if (open_result < 0) {
     std::string err_str = ffmpeg_errno_to_string(open_result);
@@ -1230,10 +1501,28 @@ int VideoState::ReadThread() {
 
   av_format_inject_global_side_data(ic);
 
+  const std::string& probe_cache_path = opt_.probe_cache_path;
+  bool probe_seeded = false;
+  ProbeInfo cached_probe;
+  if (!probe_cache_path.empty()) {
+    common::Error err = LoadProbeInfo(probe_cache_path, &cached_probe);
+    if (!err) {
+      if (cached_probe.IsSameLayout(ic)) {
+        cached_probe.Seed(ic);
+        probe_seeded = true;
+      } else {
+        INFO_LOG() << "Streams layout of " << id_ << " changed, probe cache invalidated.";
+        remove(probe_cache_path.c_str());
+      }
+    }
+  }
+
   AVDictionary** opts = setup_find_stream_info_opts(ic, copt_.codec_opts);
   unsigned int orig_nb_streams = ic->nb_streams;
 
+  const msec_t probe_start_ts = GetCurrentMsec();
   int find_stream_info_result = avformat_find_stream_info(ic, opts);
+  const msec_t probe_msec = GetCurrentMsec() - probe_start_ts;
 
   for (unsigned int i = 0; i < orig_nb_streams; i++) {
     av_dict_free(&opts[i]);
@@ -1242,12 +1531,29 @@ int VideoState::ReadThread() {
 
   AVPacket pkt1, *pkt = &pkt1;
   if (find_stream_info_result < 0) {
+    if (probe_seeded) {  // next open will probe from scratch
+      remove(probe_cache_path.c_str());
+    }
     std::string err_str = ffmpeg_errno_to_string(find_stream_info_result);
     common::Error err = common::make_error_value(err_str, common::Value::E_ERROR);
     handler_->HandleQuitStream(this, -1, err);
     return ERROR_RESULT_VALUE;
   }
 
+  if (probe_seeded) {
+    INFO_LOG() << "Probe of " << id_ << " seeded from cache took " << probe_msec << " msec.";
+    if (!cached_probe.IsSameLayout(ic)) {  // probe found new streams
+      remove(probe_cache_path.c_str());
+    }
+  } else if (!probe_cache_path.empty()) {
+    INFO_LOG() << "Full probe of " << id_ << " took " << probe_msec << " msec.";
+    const int64_t probe_size = ic->pb ? avio_tell(ic->pb) : 0;
+    common::Error err = SaveProbeInfo(probe_cache_path, ProbeInfo(ic, probe_size));
+    if (err && err->IsError()) {
+      DEBUG_MSG_ERROR(err);
+    }
+  }
+
   if (ic->pb) {
     ic->pb->eof_reached = 0;  // FIXME hack, ffplay maybe should not use avio_feof() to test for the end
   }
@@ -1288,6 +1594,17 @@ int VideoState::ReadThread() {
   st_index[AVMEDIA_TYPE_AUDIO] =
       av_find_best_stream(ic, AVMEDIA_TYPE_AUDIO, st_index[AVMEDIA_TYPE_AUDIO], st_index[AVMEDIA_TYPE_VIDEO], NULL, 0);
 
+  PrewarmBuffer warm_buffer(warm_max_buffer_bytes_, warm_max_bandwidth_);
+  if (IsWarm()) {
+    ReadWarmPackets(ic, st_index[AVMEDIA_TYPE_VIDEO], st_index[AVMEDIA_TYPE_AUDIO], &warm_buffer);
+    if (IsAborted()) {
+      handler_->HandleQuitStream(this, 0, common::Error());
+      return SUCCESS_RESULT_VALUE;
+    }
+    DEBUG_LOG() << "Promoted stream " << id_ << " with " << warm_buffer.GetPacketsCount() << " buffered packets ("
+                << warm_buffer.GetSize() << " bytes), " << warm_buffer.GetDropsCount() << " drops for lag.";
+  }
+
   /* open the streams */
   if (st_index[AVMEDIA_TYPE_AUDIO] >= 0) {
     int res_audio = StreamComponentOpen(st_index[AVMEDIA_TYPE_AUDIO]);
@@ -1319,10 +1636,35 @@ int VideoState::ReadThread() {
                     << band.max << ").";
     }
   }
-  if (opt_.infinite_buffer < 0 && realtime_) {
-    opt_.infinite_buffer = 1;
+  BufferingPolicy buffering(CalcBufferWatermarks(opt_, realtime_));
+  const BufferWatermarks watermarks = buffering.GetWatermarks();
+  INFO_LOG() << "Stream " << id_ << " buffering watermarks low: " << watermarks.low
+             << " msec, high: " << watermarks.high << " msec.";
+  if (video_stream->IsOpened()) {
+    video_packet_queue->SetDrainWakeup(&read_wakeup_, watermarks.low / video_stream->q2d());
+  }
+  if (audio_stream->IsOpened()) {
+    audio_packet_queue->SetDrainWakeup(&read_wakeup_, watermarks.low / audio_stream->q2d());
   }
 
+  while (warm_buffer.Pop(pkt)) {
+    if (pkt->stream_index == audio_stream->Index()) {
+      audio_stream->RegisterPacket(pkt);
+      audio_packet_queue->Put(pkt);
+    } else if (pkt->stream_index == video_stream->Index() && !video_stream->HaveDispositionPicture()) {
+      video_stream->RegisterPacket(pkt);
+      video_packet_queue->Put(pkt);
+    } else {
+      av_packet_unref(pkt);
+    }
+  }
+
+  Stream* master_stream = audio_stream;
+  if (GetMasterSyncType() == AV_SYNC_VIDEO_MASTER || !audio_stream->IsOpened()) {
+    master_stream = video_stream;
+  }
+  bool live_wait_keyframe = false;
+
   ResetStats();
   while (!IsAborted()) {
     if (paused_ != last_paused_) {
@@ -1361,13 +1703,33 @@ int VideoState::ReadThread() {
       ResetStats();
     }
 
-    /* if the queue are full, no need to read more */
-    if (opt_.infinite_buffer < 1 && (video_packet_queue->GetSize() + audio_packet_queue->GetSize() > MAX_QUEUE_SIZE ||
-                                     (astream_->HasEnoughPackets() && vstream_->HasEnoughPackets()))) {
-      common::unique_lock<common::mutex> lock(read_thread_mutex_);
-      std::cv_status interrupt_status = read_thread_cond_.wait_for(lock, std::chrono::milliseconds(10));
-      if (interrupt_status == std::cv_status::no_timeout) {  // if notify
+    if (IsLiveLatencyControlled() && live_latency_->TakeJumpRequest()) {
+      // drop everything demuxed so far, audio goes on with the next packet and video with the next keyframe
+      INFO_LOG() << "Stream " << id_ << " is " << live_latency_->GetLatency() << " msec behind live, target "
+                 << live_latency_->GetTarget() << " msec, jumping to live edge.";
+      if (video_stream->IsOpened()) {
+        video_packet_queue->PutNullpacket(video_stream->Index());
+        live_wait_keyframe = !video_stream->HaveDispositionPicture();
       }
+      if (audio_stream->IsOpened()) {
+        audio_packet_queue->PutNullpacket(audio_stream->Index());
+      }
+      TRACE_INSTANT("demux", "live_jump", invalid_clock());
+    }
+
+    /* if the queue are full, no need to read more */
+    const clock64_t video_buffered = video_stream->IsOpened() && !video_stream->HaveDispositionPicture()
+                                         ? video_stream->GetBufferedDuration()
+                                         : invalid_clock();
+    const clock64_t audio_buffered = audio_stream->IsOpened() ? audio_stream->GetBufferedDuration() : invalid_clock();
+    // wait for full ring here, read thread blocked in Put would not service seek, pause or promotion
+    const bool ring_full = video_packet_queue->GetNbPackets() >= video_packet_queue->GetCapacity() ||
+                           audio_packet_queue->GetNbPackets() >= audio_packet_queue->GetCapacity();
+    if (ring_full || (opt_.infinite_buffer < 1 &&
+                      buffering.IsFull(video_buffered, audio_buffered,
+                                       video_packet_queue->GetSize() + audio_packet_queue->GetSize()))) {
+      read_wakeup_.WaitFor(READ_IDLE_WAKEUP_MSEC);
+      stats_->read_wakeups = read_wakeup_.GetWakeups();
       continue;
     }
     if (!paused_ && eof_) {
@@ -1390,6 +1752,7 @@ int VideoState::ReadThread() {
         return ERROR_RESULT_VALUE;
       }
     }
+    TRACE_BEGIN(read_start);
     int ret = av_read_frame(ic, pkt);
     if (ret < 0) {
       WARNING_LOG() << "Read input stream error: " << ffmpeg_errno_to_string(ret);
@@ -1411,16 +1774,36 @@ int VideoState::ReadThread() {
     } else {
       eof_ = false;
     }
+    TRACE_END(read_start, "demux", "read_frame", invalid_clock());
+
+    if (pkt->stream_index == master_stream->Index()) {
+      const clock64_t pkt_clock = packet_clock(pkt->pts, pkt->dts, master_stream->GetTimeBase());
+      if (IsValidClock(pkt_clock)) {
+        last_read_pts_ = pkt_clock;
+      }
+    }
+    if (live_wait_keyframe) {
+      if (pkt->stream_index == video_stream->Index() && (pkt->flags & AV_PKT_FLAG_KEY)) {
+        live_wait_keyframe = false;
+      } else if (pkt->stream_index == video_stream->Index()) {
+        av_packet_unref(pkt);
+        continue;
+      }
+    }
 
     if (pkt->stream_index == audio_stream->Index()) {
+      TRACE_BEGIN(put_start);
       audio_stream->RegisterPacket(pkt);
       audio_packet_queue->Put(pkt);
+      TRACE_END(put_start, "audio", "packet_put", packet_clock(pkt->pts, pkt->dts, audio_stream->GetTimeBase()));
     } else if (pkt->stream_index == video_stream->Index()) {
       if (video_stream->HaveDispositionPicture()) {
         av_packet_unref(pkt);
       } else {
+        TRACE_BEGIN(put_start);
         video_stream->RegisterPacket(pkt);
         video_packet_queue->Put(pkt);
+        TRACE_END(put_start, "video", "packet_put", packet_clock(pkt->pts, pkt->dts, video_stream->GetTimeBase()));
       }
     } else {
       av_packet_unref(pkt);
@@ -1431,6 +1814,45 @@ int VideoState::ReadThread() {
   return SUCCESS_RESULT_VALUE;
 }
 
+void VideoState::ReadWarmPackets(AVFormatContext* ic, int video_index, int audio_index, PrewarmBuffer* buffer) {
+  if (video_index >= 0) {
+    ic->streams[video_index]->discard = AVDISCARD_DEFAULT;
+  }
+  if (audio_index >= 0) {
+    ic->streams[audio_index]->discard = AVDISCARD_DEFAULT;
+  }
+  buffer->SetStreams(video_index, audio_index);
+
+  // on read error buffered packets are stale and dropped, after promotion read loop handles the error itself
+  bool reading = true;
+  AVPacket pkt;
+  while (IsWarm() && !IsAborted()) {
+    if (!reading) {
+      read_wakeup_.WaitFor(READ_IDLE_WAKEUP_MSEC);
+      continue;
+    }
+
+    // over bandwidth budget reading pauses, buffer drops itself once it lags too far behind the stream
+    const msec_t delay = buffer->GetThrottleDelay(GetCurrentMsec());
+    if (delay > 0) {
+      read_wakeup_.WaitFor(delay);
+      continue;
+    }
+
+    int ret = av_read_frame(ic, &pkt);
+    if (ret < 0) {
+      WARNING_LOG() << "Prewarm of " << id_ << " stopped, read error: " << ffmpeg_errno_to_string(ret);
+      if (ret != AVERROR_EOF) {
+        buffer->Clear();
+      }
+      reading = false;
+      continue;
+    }
+
+    buffer->Push(&pkt, GetCurrentMsec());
+  }
+}
+
 int VideoState::decode_interrupt_callback(void* user_data) {
   VideoState* is = static_cast<VideoState*>(user_data);
   if (is->IsAborted()) {
@@ -1441,6 +1863,7 @@ int VideoState::decode_interrupt_callback(void* user_data) {
 }
 
 int VideoState::AudioThread() {
+  TRACE_THREAD_NAME("audio decoder");
   frames::AudioFrame* af = nullptr;
   int ret = 0;
 
@@ -1496,6 +1919,7 @@ int VideoState::AudioThread() {
       while ((ret = av_buffersink_get_frame_flags(out_audio_filter_, frame, 0)) >= 0) {
         tb = out_audio_filter_->inputs[0]->time_base;
 #endif
+        TRACE_BEGIN(queue_start);
         af = audio_frame_queue_->GetPeekWritable();
         if (!af) {  // if stoped
 #if CONFIG_AVFILTER
@@ -1505,7 +1929,9 @@ int VideoState::AudioThread() {
           return ret;
         }
 
-        af->pts = IsValidPts(frame->pts) ? frame->pts * q2d_diff(tb) : invalid_clock();
+        // slot belongs to consumer after Push, so pts is kept for the trace
+        const clock64_t pts = IsValidPts(frame->pts) ? frame->pts * q2d_diff(tb) : invalid_clock();
+        af->pts = pts;
         af->pos = av_frame_get_pkt_pos(frame);
         af->format = static_cast<AVSampleFormat>(frame->format);
         AVRational tmp = {frame->nb_samples, frame->sample_rate};
@@ -1513,6 +1939,7 @@ int VideoState::AudioThread() {
 
         av_frame_move_ref(af->frame, frame);
         audio_frame_queue_->Push();
+        TRACE_END(queue_start, "audio", "queue_samples", pts);
 
 #if CONFIG_AVFILTER
       }
@@ -1531,6 +1958,7 @@ int VideoState::AudioThread() {
 }
 
 int VideoState::VideoThread() {
+  TRACE_THREAD_NAME("video decoder");
   AVFrame* frame = av_frame_alloc();
   if (!frame) {
     return AVERROR(ENOMEM);
@@ -1542,6 +1970,7 @@ int VideoState::VideoThread() {
   int last_w = 0;
   int last_h = 0;
   enum AVPixelFormat last_format = AV_PIX_FMT_NONE;  //-2
+  Size last_display_size;
   if (!graph) {
     av_frame_free(&frame);
     return AVERROR(ENOMEM);
@@ -1568,6 +1997,16 @@ int VideoState::VideoThread() {
     input_st_->hwaccel_retrieved_pix_fmt = static_cast<AVPixelFormat>(frame->format);
 
 #if CONFIG_AVFILTER
+    const Size display_size = unpack_size(display_size_);
+    if (opt_.display_downscale &&
+        (display_size.width != last_display_size.width || display_size.height != last_display_size.height)) {
+      if (scale_video_filter_ && UpdateVideoScale(display_size) >= 0) {
+        last_display_size = display_size;
+      } else {
+        last_format = AV_PIX_FMT_NONE;  // graph without scale filter, configure it again
+      }
+    }
+
     if (last_w != frame->width || last_h != frame->height || last_format != frame->format) {  // -vf option
       const std::string mess = common::MemSPrintf(
           "Video frame changed from size:%dx%d format:%s serial:%d to size:%dx%d format:%s "
@@ -1580,7 +2019,7 @@ int VideoState::VideoThread() {
       avfilter_graph_free(&graph);
       graph = avfilter_graph_alloc();
       const std::string vfilters = opt_.vfilters;
-      int ret = ConfigureVideoFilters(graph, vfilters, frame);
+      int ret = ConfigureVideoFilters(graph, vfilters, frame, display_size);
       if (ret < 0) {
         ERROR_LOG() << "Internal video error!";
         goto the_end;
@@ -1590,9 +2029,11 @@ int VideoState::VideoThread() {
       last_w = frame->width;
       last_h = frame->height;
       last_format = static_cast<AVPixelFormat>(frame->format);
+      last_display_size = display_size;
       frame_rate = filt_out->inputs[0]->frame_rate;
     }
 
+    TRACE_BEGIN(filter_start);
     ret = av_buffersrc_add_frame(filt_in, frame);
     if (ret < 0) {
       goto the_end;
@@ -1617,6 +2058,7 @@ int VideoState::VideoThread() {
       if (filt_out) {
         tb = filt_out->inputs[0]->time_base;
       }
+      TRACE_END(filter_start, "video", "filter", packet_clock(frame->pts, AV_NOPTS_VALUE, tb));
 #endif
       AVRational fr = {frame_rate.den, frame_rate.num};
       clock64_t duration = (frame_rate.num && frame_rate.den ? q2d_diff(fr) : 0);
@@ -1640,8 +2082,12 @@ the_end:
 }
 
 #if CONFIG_AVFILTER
-int VideoState::ConfigureVideoFilters(AVFilterGraph* graph, const std::string& vfilters, AVFrame* frame) {
-  static const enum AVPixelFormat pix_fmts[] = {AV_PIX_FMT_YUV420P, AV_PIX_FMT_BGRA, AV_PIX_FMT_NONE};
+int VideoState::ConfigureVideoFilters(AVFilterGraph* graph,
+                                      const std::string& vfilters,
+                                      AVFrame* frame,
+                                      const Size& display_size) {
+  // sink accepts everything renderer can upload, so no conversion is inserted for native decoder formats
+  const enum AVPixelFormat* pix_fmts = render_pix_fmts_.data();
   AVDictionary* sws_dict = copt_.sws_dict;
   AVDictionaryEntry* e = NULL;
   char sws_flags_str[512] = {0};
@@ -1711,6 +2157,23 @@ int VideoState::ConfigureVideoFilters(AVFilterGraph* graph, const std::string& v
     last_filter = filt_ctx;                                                                                      \
   } while (0)
 
+  // inserted first, so it is the last one before sink and sees rotated picture
+  scale_video_filter_ = NULL;
+  if (opt_.display_downscale && display_size.IsValid()) {
+    std::string scale_args = common::MemSPrintf("w=%s:h=%s", make_scale_width_expr(display_size),
+                                                make_scale_height_expr(display_size));
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+    // swscale scales slices of the picture in parallel
+    scale_args += common::MemSPrintf(":threads=%d", FFMIN(FFMAX(av_cpu_count(), 1), SCALE_MAX_THREADS));
+#endif
+    if (len_sws_flags) {
+      scale_args += ":";
+      scale_args += sws_flags_str;
+    }
+    INSERT_FILT("scale", scale_args.c_str());
+    scale_video_filter_ = last_filter;
+  }
+
   if (opt_.autorotate) {
     double theta = vstream_->GetRotation();
 
@@ -1740,6 +2203,30 @@ int VideoState::ConfigureVideoFilters(AVFilterGraph* graph, const std::string& v
   return ret;
 }
 
+int VideoState::UpdateVideoScale(const Size& display_size) {
+  if (!scale_video_filter_ || !display_size.IsValid()) {
+    return AVERROR(EINVAL);
+  }
+
+  // scale reconfigures its output link on every command, frames keep flowing through the same graph
+  const std::string width_expr = make_scale_width_expr(display_size);
+  int ret = avfilter_process_command(scale_video_filter_, "w", width_expr.c_str(), NULL, 0, 0);
+  if (ret < 0) {
+    WARNING_LOG() << "Failed to update scale width ret: " << ret;
+    return ret;
+  }
+
+  const std::string height_expr = make_scale_height_expr(display_size);
+  ret = avfilter_process_command(scale_video_filter_, "h", height_expr.c_str(), NULL, 0, 0);
+  if (ret < 0) {
+    WARNING_LOG() << "Failed to update scale height ret: " << ret;
+    return ret;
+  }
+
+  DEBUG_LOG() << "Video scale fitted into display: " << display_size.width << "x" << display_size.height;
+  return ret;
+}
+
 int VideoState::ConfigureAudioFilters(const std::string& afilters, int force_output_format) {
   static const enum AVSampleFormat sample_fmts[] = {AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_NONE};
   avfilter_graph_free(&agraph_);
@@ -21,6 +21,7 @@
 #include <stdint.h>  // for int64_t, uint8_t
 
 #include <string>  // for string
+#include <vector>  // for vector
 
 #include "ffmpeg_config.h"  // for CONFIG_AVFILTER
 
@@ -41,7 +42,8 @@ extern "C" {
 #include "client/core/app_options.h"   // for AppOptions, ComplexOptions
 #include "client/core/audio_params.h"  // for AudioParams
 #include "client/core/stream_statistic.h"
-#include "client/core/types.h"  // for clock64_t, AvSyncType
+#include "client/core/types.h"         // for clock64_t, AvSyncType
+#include "client/core/wakeup_event.h"  // for WakeupEvent
 
 struct SwrContext;
 struct InputStream;
@@ -53,10 +55,6 @@ class Thread;
 }
 }  // namespace common
 
-/* no AV correction is done if too big error */
-#define VIDEO_PICTURE_QUEUE_SIZE 3
-#define SAMPLE_QUEUE_SIZE 9
-
 namespace fasto {
 namespace fastotv {
 namespace client {
@@ -68,21 +66,25 @@ class AudioDecoder;
 class AudioStream;
 class VideoDecoder;
 class VideoStream;
+class FrameQueueAdapter;
+class LatencyController;
+class PrewarmBuffer;
+class DecoderSkipController;
+class ReadAheadIO;
+class SwrContextCache;
 
 namespace frames {
 struct AudioFrame;
 struct VideoFrame;
-template <size_t buffer_size>
 class AudioFrameQueue;
-template <size_t buffer_size>
 class VideoFrameQueue;
 }  // namespace frames
 
 class VideoState {
  public:
   typedef common::shared_ptr<Stats> stats_t;
-  typedef frames::VideoFrameQueue<VIDEO_PICTURE_QUEUE_SIZE> video_frame_queue_t;
-  typedef frames::AudioFrameQueue<SAMPLE_QUEUE_SIZE> audio_frame_queue_t;
+  typedef frames::VideoFrameQueue video_frame_queue_t;
+  typedef frames::AudioFrameQueue audio_frame_queue_t;
 
   enum { invalid_stream_index = -1 };
   VideoState(stream_id id,
@@ -117,8 +119,28 @@ class VideoState {
   void StreamCycleChannel(AVMediaType codec_type);
 
   bool RequestVideo(int width, int height, int av_pixel_format, AVRational aspect_ratio) WARN_UNUSED_RESULT;
+  // formats which renderer can consume without conversion, should be set before Exec
+  void SetRenderPixelFormats(const std::vector<AVPixelFormat>& pix_fmts);
+  // area pictures are fitted into on the screen, bigger frames are downscaled in the filter stage
+  // so less data is uploaded to textures, can be changed at any time
+  void SetDisplaySize(const Size& size);
+
+  // demux only mode for fast zapping: input is opened and packets from the last keyframe are buffered
+  // without decoding, should be set before Exec
+  void SetWarm(size_t max_buffer_bytes, bandwidth_t max_bandwidth);
+  bool IsWarm() const;
+  // starts decoding of warm stream, buffered packets are played first
+  void Promote();
 
   frames::VideoFrame* TryToGetVideoFrame();
+  // real clock time when TryToGetVideoFrame should be called for the next picture,
+  // invalid_clock() if it is unknown yet (paused or nothing decoded)
+  clock64_t GetNextFrameDeadline() const;
+  // pictures are selected this much before their deadline, so they hit the display refresh
+  // which follows the deadline, e.g. half of vsync period
+  void SetPresentLead(clock64_t lead);
+  // picture returned by TryToGetVideoFrame reached the display
+  void RegisterPresentation(clock64_t present_time);
   void UpdateAudioBuffer(uint8_t* stream, int len, int audio_volume);
 
   stats_t GetStatistic() const;
@@ -148,8 +170,18 @@ class VideoState {
   clock64_t ComputeTargetDelay(clock64_t delay) const;
   clock64_t GetMasterPts() const;
   clock64_t GetMasterClock() const;
+
+  bool IsLiveLatencyControlled() const;
+  // feeds distance to the live edge into controller and applies its speed to master clock,
+  // should be called from thread which updates master clock
+  double UpdateLiveLatency();
 #if CONFIG_AVFILTER
-  int ConfigureVideoFilters(AVFilterGraph* graph, const std::string& vfilters, AVFrame* frame);
+  int ConfigureVideoFilters(AVFilterGraph* graph,
+                            const std::string& vfilters,
+                            AVFrame* frame,
+                            const Size& display_size);
+  // retargets scale filter of the configured graph without rebuilding it
+  int UpdateVideoScale(const Size& display_size);
   int ConfigureAudioFilters(const std::string& afilters, int force_output_format);
 #endif
 
@@ -168,6 +200,7 @@ class VideoState {
   int QueuePicture(AVFrame* src_frame, clock64_t pts, clock64_t duration, int64_t pos);
 
   int ReadThread();
+  void ReadWarmPackets(AVFormatContext* ic, int video_index, int audio_index, PrewarmBuffer* buffer);
   int VideoThread();
   int AudioThread();
 
@@ -182,6 +215,11 @@ class VideoState {
   int read_pause_return_;
   AVFormatContext* ic_;
   bool realtime_;
+  LatencyController* live_latency_;          // NULL if not requested
+  ReadAheadIO* read_ahead_;                  // NULL if not requested
+  DecoderSkipController* decoder_skip_;      // NULL if disabled
+  size_t decoder_skip_flushes_;              // video decoder flushes seen by decoder_skip_
+  common::atomic<clock64_t> last_read_pts_;  // of master stream, msec
 
   VideoStream* vstream_;
   AudioStream* astream_;
@@ -191,6 +229,7 @@ class VideoState {
 
   video_frame_queue_t* video_frame_queue_;
   audio_frame_queue_t* audio_frame_queue_;
+  FrameQueueAdapter* video_queue_adapter_;
 
   clock64_t audio_clock_;
   clock64_t audio_diff_cum_; /* used for AV difference average computation */
@@ -209,9 +248,13 @@ class VideoState {
   AudioParams audio_filter_src_;
 #endif
   AudioParams audio_tgt_;
-  struct SwrContext* swr_ctx_;
+  SwrContextCache* swr_cache_;
+  struct SwrContext* swr_ctx_;  // current one, owned by swr_cache_
 
   clock64_t frame_timer_;
+  clock64_t next_frame_deadline_;
+  clock64_t present_deadline_;  // of the selected and not yet presented picture
+  clock64_t present_lead_;
   clock64_t frame_last_returned_time_;
   clock64_t frame_last_filter_delay_;
   clock64_t max_frame_duration_;  // maximum duration of a frame - above this, we consider the jump a
@@ -220,11 +263,12 @@ class VideoState {
   bool step_;
 
 #if CONFIG_AVFILTER
-  AVFilterContext* in_video_filter_;   // the first filter in the video chain
-  AVFilterContext* out_video_filter_;  // the last filter in the video chain
-  AVFilterContext* in_audio_filter_;   // the first filter in the audio chain
-  AVFilterContext* out_audio_filter_;  // the last filter in the audio chain
-  AVFilterGraph* agraph_;              // audio filter graph
+  AVFilterContext* in_video_filter_;     // the first filter in the video chain
+  AVFilterContext* out_video_filter_;    // the last filter in the video chain
+  AVFilterContext* scale_video_filter_;  // display downscale, NULL if not inserted
+  AVFilterContext* in_audio_filter_;     // the first filter in the audio chain
+  AVFilterContext* out_audio_filter_;    // the last filter in the audio chain
+  AVFilterGraph* agraph_;                // audio filter graph
 #endif
 
   int last_video_stream_;
@@ -238,7 +282,15 @@ class VideoState {
   bool eof_;
   bool abort_request_;
 
+  common::atomic<bool> warm_;
+  size_t warm_max_buffer_bytes_;
+  bandwidth_t warm_max_bandwidth_;
+
+  common::atomic<int> decoder_thread_count_;  // active video decoder threading
+  common::atomic<int> decoder_thread_type_;
   stats_t stats_;
+  std::vector<AVPixelFormat> render_pix_fmts_;  // terminated by AV_PIX_FMT_NONE
+  common::atomic<uint64_t> display_size_;  // packed, so video thread never sees half updated size
   VideoStateHandler* handler_;
   InputStream* input_st_;
 
@@ -247,8 +299,7 @@ class VideoState {
   int64_t seek_rel_;
   int seek_flags_;
 
-  common::condition_variable read_thread_cond_;
-  common::mutex read_thread_mutex_;
+  WakeupEvent read_wakeup_;  // read thread parks here while queues are full or warm stream stopped
 };
 
 }  // namespace core
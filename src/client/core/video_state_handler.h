@@ -47,10 +47,6 @@ class VideoStateHandler {
                                   int wanted_sample_rate,
                                   AudioParams* audio_hw_params,
                                   int* audio_buff_size) WARN_UNUSED_RESULT = 0;  // init audio
-  virtual void HanleAudioMix(uint8_t* audio_stream_ptr,
-                             const uint8_t* src,
-                             uint32_t len,
-                             int volume) = 0;  // change volume
 
   // video
   virtual bool HandleRequestVideo(VideoState* stream,
@@ -0,0 +1,66 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/core/wakeup_event.h"
+
+#include <chrono>  // for milliseconds
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+WakeupEvent::WakeupEvent() : signaled_(false), waiting_(false), wakeups_(0), mutex_(), cond_() {}
+
+bool WakeupEvent::WaitFor(clock64_t msec) {
+  bool notified = true;
+  lock_t lock(mutex_);
+  // pairs with signaled_ store in Notify, both seq_cst, so one of the sides sees the other
+  waiting_ = true;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(msec);
+  while (!signaled_.exchange(false)) {
+    if (cond_.wait_until(lock, deadline) == std::cv_status::timeout) {
+      notified = signaled_.exchange(false);
+      break;
+    }
+  }
+  waiting_ = false;
+  wakeups_++;
+  return notified;
+}
+
+void WakeupEvent::Notify() {
+  if (signaled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  signaled_ = true;
+  if (waiting_) {
+    lock_t lock(mutex_);
+    cond_.notify_one();
+  }
+}
+
+size_t WakeupEvent::GetWakeups() const {
+  return wakeups_;
+}
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,62 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <common/macros.h>         // for DISALLOW_COPY_AND_ASSIGN
+#include <common/threads/types.h>  // for condition_variable, mutex
+
+#include "client/core/types.h"  // for clock64_t
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+namespace core {
+
+/*
+ * Parks a single waiter until somebody has work for it.
+ * Notify is a lock free flag store when nobody waits, so it can be called on every packet
+ * from hot paths, notification which comes before Wait is not lost.
+ */
+class WakeupEvent {
+ public:
+  WakeupEvent();
+
+  // false on timeout
+  bool WaitFor(clock64_t msec);
+  void Notify();
+
+  size_t GetWakeups() const;  // returned Wait calls, timeouts included
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(WakeupEvent);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  common::atomic<bool> signaled_;
+  common::atomic<bool> waiting_;
+  common::atomic<size_t> wakeups_;
+  common::mutex mutex_;
+  common::condition_variable cond_;
+};
+
+}  // namespace core
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
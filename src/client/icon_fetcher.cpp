@@ -0,0 +1,805 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "client/icon_fetcher.h"
+
+#include <ctype.h>   // for isalpha, isdigit, tolower
+#include <stdint.h>  // for uint16_t
+#include <stdio.h>   // for fopen, rename, remove
+#include <stdlib.h>  // for atoi, strtoul
+
+#if defined(OS_POSIX)
+#include <sys/socket.h>  // for setsockopt, shutdown
+#include <sys/time.h>    // for timeval
+#elif defined(OS_WIN)
+#include <winsock2.h>  // for setsockopt, shutdown, timeval
+#endif
+
+#include <map>     // for map
+#include <set>     // for set
+#include <vector>  // for vector
+
+#include <common/convert2string.h>          // for ConvertToString
+#include <common/file_system.h>             // for is_file_exist
+#include <common/net/net.h>                 // for connect
+#include <common/net/socket_tcp.h>          // for SocketHolder
+#include <common/threads/thread_manager.h>  // for THREAD_MANAGER
+
+#include "client/utils.h"  // for DownloadFileToBuffer
+
+#define HTTP_SCHEME "http://"
+#define HTTP_DEFAULT_PORT 80
+#define HTTP_MAX_HEAD_SIZE (64 * 1024)
+#define META_FILE_EXTENSION ".meta"
+#define TEMP_FILE_EXTENSION ".tmp"
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+// sockets of requests in progress, Stop shuts them down to wake up blocked workers
+class ActiveSockets {
+ public:
+  ActiveSockets() : mutex_(), fds_(), stopped_(false) {}
+
+  // false if fetcher is stopping, socket shouldn't be used then
+  bool Add(common::net::socket_descr_t fd) {
+    lock_t lock(mutex_);
+    if (stopped_) {
+      return false;
+    }
+    fds_.insert(fd);
+    return true;
+  }
+
+  void Remove(common::net::socket_descr_t fd) {
+    lock_t lock(mutex_);
+    fds_.erase(fd);
+  }
+
+  void ShutdownAll() {
+    lock_t lock(mutex_);
+    stopped_ = true;
+    for (auto it = fds_.begin(); it != fds_.end(); ++it) {
+#if defined(OS_WIN)
+      shutdown(*it, SD_BOTH);
+#else
+      shutdown(*it, SHUT_RDWR);
+#endif
+    }
+  }
+
+  void Reset() {
+    lock_t lock(mutex_);
+    stopped_ = false;
+  }
+
+  bool IsStopped() const {
+    lock_t lock(mutex_);
+    return stopped_;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ActiveSockets);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  mutable common::mutex mutex_;
+  std::set<common::net::socket_descr_t> fds_;
+  bool stopped_;
+};
+
+namespace {
+
+enum FetchResult { FETCH_FAILED, FETCH_NOT_MODIFIED, FETCH_UPDATED };
+
+struct HttpUrl {
+  std::string host;
+  uint16_t port;
+  std::string target;
+};
+
+struct HttpResponse {
+  int status;
+  bool keep_alive;
+  std::map<std::string, std::string> headers;  // lower case names
+
+  std::string GetHeader(const std::string& name) const {
+    auto it = headers.find(name);
+    return it == headers.end() ? std::string() : it->second;
+  }
+};
+
+struct Validators {
+  std::string etag;
+  std::string last_modified;
+};
+
+std::string ToLower(std::string str) {
+  for (size_t i = 0; i < str.size(); ++i) {
+    str[i] = static_cast<char>(tolower(static_cast<unsigned char>(str[i])));
+  }
+  return str;
+}
+
+std::string Trim(const std::string& str) {
+  size_t start = str.find_first_not_of(" \t");
+  if (start == std::string::npos) {
+    return std::string();
+  }
+  size_t end = str.find_last_not_of(" \t\r\n");
+  return str.substr(start, end - start + 1);
+}
+
+bool IsHttpUrl(const std::string& url) {
+  return ToLower(url.substr(0, sizeof(HTTP_SCHEME) - 1)) == HTTP_SCHEME;
+}
+
+bool HasScheme(const std::string& ref) {
+  for (size_t i = 0; i < ref.size(); ++i) {
+    const unsigned char c = static_cast<unsigned char>(ref[i]);
+    if (c == ':') {
+      return i > 0;
+    }
+    if (!isalpha(c) && (i == 0 || (!isdigit(c) && c != '+' && c != '-' && c != '.'))) {
+      return false;
+    }
+  }
+  return false;
+}
+
+// RFC 3986 5.2.4, path starts with '/'
+std::string RemoveDotSegments(const std::string& path) {
+  std::vector<std::string> segments;
+  size_t start = 1;
+  while (true) {
+    const size_t end = path.find('/', start);
+    const bool last = end == std::string::npos;
+    const std::string segment = path.substr(start, last ? std::string::npos : end - start);
+    if (segment == "..") {
+      if (!segments.empty()) {
+        segments.pop_back();
+      }
+      if (last) {
+        segments.push_back(std::string());
+      }
+    } else if (segment == ".") {
+      if (last) {
+        segments.push_back(std::string());
+      }
+    } else {
+      segments.push_back(segment);
+    }
+    if (last) {
+      break;
+    }
+    start = end + 1;
+  }
+
+  std::string result;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    result += "/" + segments[i];
+  }
+  return result.empty() ? "/" : result;
+}
+
+// RFC 3986 5.2.2, base is absolute http url, fragments are dropped
+std::string ResolveLocation(const std::string& base, const std::string& location) {
+  const std::string ref = location.substr(0, location.find('#'));
+  if (HasScheme(ref)) {
+    return ref;
+  }
+  if (ref.compare(0, 2, "//") == 0) {
+    return "http:" + ref;
+  }
+
+  const std::string stripped = base.substr(0, base.find('#'));
+  const size_t path_start = stripped.find_first_of("/?", sizeof(HTTP_SCHEME) - 1);
+  const std::string origin = stripped.substr(0, path_start);
+  const std::string base_target = path_start == std::string::npos ? "/" : stripped.substr(path_start);
+  std::string base_path = base_target.substr(0, base_target.find('?'));
+  if (base_path.empty()) {
+    base_path = "/";
+  }
+
+  if (ref.empty()) {
+    return origin + base_target;
+  }
+  if (ref[0] == '?') {
+    return origin + base_path + ref;
+  }
+
+  const size_t query = ref.find('?');
+  const std::string ref_path = ref.substr(0, query);
+  const std::string ref_query = query == std::string::npos ? std::string() : ref.substr(query);
+  if (ref[0] == '/') {
+    return origin + RemoveDotSegments(ref_path) + ref_query;
+  }
+  const std::string merged = base_path.substr(0, base_path.rfind('/') + 1) + ref_path;
+  return origin + RemoveDotSegments(merged) + ref_query;
+}
+
+bool ParseHttpUrl(const std::string& url, HttpUrl* out) {
+  if (!IsHttpUrl(url)) {
+    return false;
+  }
+
+  const std::string rest = url.substr(sizeof(HTTP_SCHEME) - 1);
+  const size_t slash = rest.find('/');
+  std::string authority = rest.substr(0, slash);
+  std::string target = slash == std::string::npos ? "/" : rest.substr(slash);
+  target = target.substr(0, target.find('#'));
+  const size_t at = authority.rfind('@');
+  if (at != std::string::npos) {
+    authority = authority.substr(at + 1);
+  }
+
+  uint16_t port = HTTP_DEFAULT_PORT;
+  const size_t colon = authority.rfind(':');
+  if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+    port = static_cast<uint16_t>(atoi(authority.c_str() + colon + 1));
+    authority = authority.substr(0, colon);
+  }
+  if (authority.empty() || port == 0) {
+    return false;
+  }
+
+  *out = {authority, port, target};
+  return true;
+}
+
+bool ParseResponseHead(const std::string& head, HttpResponse* resp) {
+  if (head.compare(0, 5, "HTTP/") != 0) {
+    return false;
+  }
+
+  const size_t status_pos = head.find(' ');
+  if (status_pos == std::string::npos) {
+    return false;
+  }
+  resp->status = atoi(head.c_str() + status_pos + 1);
+  resp->headers.clear();
+
+  size_t line_start = head.find("\r\n");
+  while (line_start != std::string::npos) {
+    line_start += 2;
+    const size_t line_end = head.find("\r\n", line_start);
+    const std::string line = head.substr(line_start, line_end - line_start);
+    const size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+      resp->headers[ToLower(Trim(line.substr(0, colon)))] = Trim(line.substr(colon + 1));
+    }
+    line_start = line_end;
+  }
+
+  const std::string connection = ToLower(resp->GetHeader("connection"));
+  const bool http10 = head.compare(0, 8, "HTTP/1.0") == 0;
+  resp->keep_alive = http10 ? connection == "keep-alive" : connection != "close";
+  return resp->status > 0;
+}
+
+bool WriteFileAtomic(const std::string& path, const std::string& data) {
+  const std::string temp_path = path + TEMP_FILE_EXTENSION;
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+
+  const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+  if (fclose(file) != 0 || !written) {
+    remove(temp_path.c_str());
+    return false;
+  }
+
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    // rename doesn't replace existing file on some platforms
+    remove(path.c_str());
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+      remove(temp_path.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void LoadValidators(const std::string& path, Validators* validators) {
+  FILE* file = fopen((path + META_FILE_EXTENSION).c_str(), "rb");
+  if (!file) {
+    return;
+  }
+
+  char line[1024];
+  while (fgets(line, sizeof(line), file)) {
+    const std::string str(line);
+    const size_t colon = str.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    const std::string name = str.substr(0, colon);
+    if (name == "etag") {
+      validators->etag = Trim(str.substr(colon + 1));
+    } else if (name == "last-modified") {
+      validators->last_modified = Trim(str.substr(colon + 1));
+    }
+  }
+  fclose(file);
+}
+
+void SaveValidators(const std::string& path, const Validators& validators) {
+  const std::string meta_path = path + META_FILE_EXTENSION;
+  if (validators.etag.empty() && validators.last_modified.empty()) {
+    remove(meta_path.c_str());
+    return;
+  }
+
+  std::string data;
+  if (!validators.etag.empty()) {
+    data += "etag: " + validators.etag + "\n";
+  }
+  if (!validators.last_modified.empty()) {
+    data += "last-modified: " + validators.last_modified + "\n";
+  }
+  WriteFileAtomic(meta_path, data);
+}
+
+int IsInterrupted(void* opaque) {
+  return static_cast<ActiveSockets*>(opaque)->IsStopped() ? 1 : 0;
+}
+
+struct timeval MakeTimeout() {
+  struct timeval tv;
+  tv.tv_sec = IconFetcher::timeout_msec / 1000;
+  tv.tv_usec = (IconFetcher::timeout_msec % 1000) * 1000;
+  return tv;
+}
+
+class HttpConnection {
+ public:
+  HttpConnection(const common::net::socket_info& info, ActiveSockets* sockets)
+      : sock_(info), sockets_(sockets), registered_(sockets->Add(sock_.GetFd())), buffer_() {
+#if defined(OS_WIN)
+    const DWORD timeout = IconFetcher::timeout_msec;
+    setsockopt(sock_.GetFd(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    setsockopt(sock_.GetFd(), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+    const struct timeval tv = MakeTimeout();
+    setsockopt(sock_.GetFd(), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sock_.GetFd(), SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#endif
+  }
+
+  ~HttpConnection() {
+    if (registered_) {
+      sockets_->Remove(sock_.GetFd());
+    }
+    common::Error err = sock_.Close();
+    UNUSED(err);
+  }
+
+  // false if fetcher started stopping before socket was registered
+  bool IsRegistered() const { return registered_; }
+
+  bool Send(const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+      size_t written = 0;
+      common::Error err = sock_.Write(data.data() + offset, data.size() - offset, &written);
+      if ((err && err->IsError()) || written == 0) {
+        return false;
+      }
+      offset += written;
+    }
+    return true;
+  }
+
+  bool ReadHead(std::string* head) {
+    while (true) {
+      const size_t end = buffer_.find("\r\n\r\n");
+      if (end != std::string::npos) {
+        *head = buffer_.substr(0, end + 2);
+        buffer_.erase(0, end + 4);
+        return true;
+      }
+      if (buffer_.size() > HTTP_MAX_HEAD_SIZE || !Fill()) {
+        return false;
+      }
+    }
+  }
+
+  // reusable is false if connection can't carry next request
+  bool ReadBody(const HttpResponse& resp, std::string* body, bool* reusable) {
+    body->clear();
+    *reusable = resp.keep_alive;
+    if ((resp.status >= 100 && resp.status < 200) || resp.status == 204 || resp.status == 304) {
+      return true;
+    }
+
+    if (ToLower(resp.GetHeader("transfer-encoding")).find("chunked") != std::string::npos) {
+      return ReadChunked(body);
+    }
+
+    const std::string content_length = resp.GetHeader("content-length");
+    if (!content_length.empty()) {
+      const size_t length = strtoul(content_length.c_str(), NULL, 10);
+      if (length > IconFetcher::max_icon_size) {
+        return false;
+      }
+      return ReadExactly(length, body);
+    }
+
+    // till connection close
+    *reusable = false;
+    while (Fill()) {
+      if (buffer_.size() > IconFetcher::max_icon_size) {
+        return false;
+      }
+    }
+    body->swap(buffer_);
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HttpConnection);
+
+  bool Fill() {
+    char data[16 * 1024];
+    size_t nread = 0;
+    common::Error err = sock_.Read(data, sizeof(data), &nread);
+    if ((err && err->IsError()) || nread == 0) {
+      return false;
+    }
+    buffer_.append(data, nread);
+    return true;
+  }
+
+  bool ReadLine(std::string* line) {
+    while (true) {
+      const size_t end = buffer_.find("\r\n");
+      if (end != std::string::npos) {
+        *line = buffer_.substr(0, end);
+        buffer_.erase(0, end + 2);
+        return true;
+      }
+      if (buffer_.size() > HTTP_MAX_HEAD_SIZE || !Fill()) {
+        return false;
+      }
+    }
+  }
+
+  bool ReadExactly(size_t size, std::string* out) {
+    while (buffer_.size() < size) {
+      if (!Fill()) {
+        return false;
+      }
+    }
+    out->append(buffer_, 0, size);
+    buffer_.erase(0, size);
+    return true;
+  }
+
+  bool ReadChunked(std::string* body) {
+    while (true) {
+      std::string line;
+      if (!ReadLine(&line)) {
+        return false;
+      }
+      const size_t chunk_size = strtoul(line.c_str(), NULL, 16);
+      if (chunk_size == 0) {
+        break;
+      }
+      if (body->size() + chunk_size > IconFetcher::max_icon_size || !ReadExactly(chunk_size, body) ||
+          !ReadLine(&line)) {
+        return false;
+      }
+    }
+
+    // trailers
+    while (true) {
+      std::string line;
+      if (!ReadLine(&line)) {
+        return false;
+      }
+      if (line.empty()) {
+        return true;
+      }
+    }
+  }
+
+  common::net::SocketHolder sock_;
+  ActiveSockets* const sockets_;
+  const bool registered_;
+  std::string buffer_;
+};
+
+typedef std::map<std::string, HttpConnection*> connections_t;  // host:port
+
+std::string BuildRequest(const HttpUrl& url, const Validators& validators) {
+  std::string host = url.host;
+  if (url.port != HTTP_DEFAULT_PORT) {
+    host += ":" + common::ConvertToString(url.port);
+  }
+
+  std::string request = "GET " + url.target + " HTTP/1.1\r\nHost: " + host +
+                        "\r\nUser-Agent: " PROJECT_NAME_LOWERCASE "\r\nAccept: */*\r\nConnection: keep-alive\r\n";
+  if (!validators.etag.empty()) {
+    request += "If-None-Match: " + validators.etag + "\r\n";
+  }
+  if (!validators.last_modified.empty()) {
+    request += "If-Modified-Since: " + validators.last_modified + "\r\n";
+  }
+  return request + "\r\n";
+}
+
+bool Exchange(const HttpUrl& url,
+              const std::string& request,
+              ActiveSockets* sockets,
+              connections_t* connections,
+              size_t* opened,
+              HttpResponse* resp,
+              std::string* body) {
+  const std::string key = url.host + ":" + common::ConvertToString(url.port);
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    HttpConnection* connection = NULL;
+    bool reused = false;
+    auto it = connections->find(key);
+    if (it != connections->end()) {
+      connection = it->second;
+      reused = true;
+    } else {
+      common::net::socket_info info;
+      struct timeval tv = MakeTimeout();
+      common::ErrnoError err =
+          common::net::connect(common::net::HostAndPort(url.host, url.port), common::net::ST_SOCK_STREAM, &tv, &info);
+      if (err && err->IsError()) {
+        return false;
+      }
+      connection = new HttpConnection(info, sockets);
+      if (!connection->IsRegistered()) {
+        delete connection;
+        return false;
+      }
+      (*connections)[key] = connection;
+      (*opened)++;
+    }
+
+    std::string head;
+    bool reusable = false;
+    const bool ok = connection->Send(request) && connection->ReadHead(&head) && ParseResponseHead(head, resp) &&
+                    connection->ReadBody(*resp, body, &reusable);
+    if (!ok || !reusable) {
+      delete connection;
+      connections->erase(key);
+    }
+    if (ok) {
+      return true;
+    }
+    if (!reused) {
+      return false;
+    }
+    // server closed idle keep-alive connection, retry on new one
+  }
+  return false;
+}
+
+FetchResult FetchOther(const common::uri::Uri& uri, const std::string& path, ActiveSockets* sockets) {
+  if (common::file_system::is_file_exist(path)) {
+    return FETCH_NOT_MODIFIED;
+  }
+
+  const AVIOInterruptCB interrupt_cb = {IsInterrupted, sockets};
+  common::buffer_t buff;
+  if (!DownloadFileToBuffer(uri, &buff, &interrupt_cb) || buff.empty()) {
+    return FETCH_FAILED;
+  }
+
+  const std::string data(buff.begin(), buff.end());
+  return WriteFileAtomic(path, data) ? FETCH_UPDATED : FETCH_FAILED;
+}
+
+FetchResult FetchHttp(const std::string& url,
+                      const std::string& path,
+                      ActiveSockets* sockets,
+                      connections_t* connections,
+                      size_t* opened) {
+  Validators validators;
+  if (common::file_system::is_file_exist(path)) {
+    LoadValidators(path, &validators);
+  }
+
+  std::string location = url;
+  for (int redirect = 0; redirect <= IconFetcher::max_redirects; ++redirect) {
+    if (!IsHttpUrl(location)) {
+      // https and other schemes are handled by libavformat
+      return FetchOther(common::uri::Uri(location), path, sockets);
+    }
+
+    HttpUrl http_url;
+    if (!ParseHttpUrl(location, &http_url)) {
+      return FETCH_FAILED;
+    }
+
+    HttpResponse resp;
+    std::string body;
+    if (!Exchange(http_url, BuildRequest(http_url, validators), sockets, connections, opened, &resp, &body)) {
+      return FETCH_FAILED;
+    }
+
+    if (resp.status == 304) {
+      return FETCH_NOT_MODIFIED;
+    }
+
+    const std::string next = resp.GetHeader("location");
+    if (resp.status >= 300 && resp.status < 400 && !next.empty()) {
+      location = ResolveLocation(location, next);
+      continue;
+    }
+
+    if (resp.status != 200 || body.empty() || !WriteFileAtomic(path, body)) {
+      return FETCH_FAILED;
+    }
+
+    const Validators fresh = {resp.GetHeader("etag"), resp.GetHeader("last-modified")};
+    SaveValidators(path, fresh);
+    return FETCH_UPDATED;
+  }
+  return FETCH_FAILED;
+}
+
+}  // namespace
+
+IconFetcher::IconFetcher(updated_callback_t updated_cb, size_t concurrency)
+    : updated_cb_(updated_cb),
+      workers_(),
+      mutex_(),
+      cond_(),
+      requests_(),
+      pending_(),
+      running_(false),
+      sockets_(new ActiveSockets),
+      updated_(0),
+      not_modified_(0),
+      failed_(0),
+      connections_(0) {
+  for (size_t i = 0; i < (concurrency ? concurrency : 1); ++i) {
+    workers_.push_back(THREAD_MANAGER()->CreateThread(&IconFetcher::Run, this));
+  }
+}
+
+IconFetcher::~IconFetcher() {
+  Stop();
+  delete sockets_;
+}
+
+bool IconFetcher::Start() {
+  {
+    lock_t lock(mutex_);
+    if (running_) {
+      return true;
+    }
+    sockets_->Reset();
+    running_ = true;
+  }
+
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (!workers_[i]->Start()) {
+      {
+        lock_t lock(mutex_);
+        running_ = false;
+        cond_.notify_all();
+      }
+      sockets_->ShutdownAll();
+      for (size_t j = 0; j < i; ++j) {
+        workers_[j]->Join();
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void IconFetcher::Stop() {
+  {
+    lock_t lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    cond_.notify_all();
+  }
+
+  // unblocks workers waiting on slow hosts
+  sockets_->ShutdownAll();
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->Join();
+  }
+
+  lock_t lock(mutex_);
+  requests_.clear();
+  pending_.clear();
+}
+
+void IconFetcher::Fetch(const common::uri::Uri& uri, const std::string& path) {
+  lock_t lock(mutex_);
+  if (!running_ || !pending_.insert(path).second) {
+    return;
+  }
+
+  Request request = {uri, path};
+  requests_.push_back(request);
+  cond_.notify_one();
+}
+
+size_t IconFetcher::GetUpdatedCount() const {
+  return updated_;
+}
+
+size_t IconFetcher::GetNotModifiedCount() const {
+  return not_modified_;
+}
+
+size_t IconFetcher::GetFailedCount() const {
+  return failed_;
+}
+
+size_t IconFetcher::GetConnectionsCount() const {
+  return connections_;
+}
+
+int IconFetcher::Run() {
+  connections_t connections;  // kept alive between requests of this worker
+  while (true) {
+    Request request;
+    {
+      lock_t lock(mutex_);
+      while (running_ && requests_.empty()) {
+        cond_.wait(lock);
+      }
+      if (!running_) {
+        break;
+      }
+      request = requests_.front();
+      requests_.pop_front();
+    }
+
+    const std::string url = request.uri.Url();
+    size_t opened = 0;
+    const FetchResult result = IsHttpUrl(url) ? FetchHttp(url, request.path, sockets_, &connections, &opened)
+                                              : FetchOther(request.uri, request.path, sockets_);
+    connections_ += opened;
+    if (result == FETCH_UPDATED) {
+      updated_++;
+      if (updated_cb_) {
+        updated_cb_(request.path);
+      }
+    } else if (result == FETCH_NOT_MODIFIED) {
+      not_modified_++;
+    } else {
+      failed_++;
+    }
+
+    lock_t lock(mutex_);
+    pending_.erase(request.path);
+  }
+
+  for (auto it = connections.begin(); it != connections.end(); ++it) {
+    delete it->second;
+  }
+  return 0;
+}
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
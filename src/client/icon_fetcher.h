@@ -0,0 +1,100 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <deque>       // for deque
+#include <functional>  // for function
+#include <set>         // for set
+#include <string>      // for string
+#include <vector>      // for vector
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+#include <common/smart_ptr.h>
+#include <common/threads/types.h>  // for condition_variable, mutex
+#include <common/url.h>            // for Uri
+
+namespace common {
+namespace threads {
+template <typename RT>
+class Thread;
+}
+}  // namespace common
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+class ActiveSockets;
+
+/*
+ * Downloads channel icons on own workers, so slow icon hosts don't delay the control connection.
+ * http icons are revalidated with ETag/Last-Modified saved next to the icon and connections are kept alive
+ * per host, other schemes go through libavformat and are fetched only if icon file doesn't exist.
+ * Icon is written to temporary file and renamed over the icon path, readers never see partial file.
+ * Stop shuts down sockets of requests in progress, so it never waits for slow hosts longer than connect timeout.
+ */
+class IconFetcher {
+ public:
+  enum { default_concurrency = 4, timeout_msec = 10000, max_icon_size = 4 * 1024 * 1024, max_redirects = 3 };
+  typedef std::function<void(const std::string& path)> updated_callback_t;  // called on worker thread
+
+  explicit IconFetcher(updated_callback_t updated_cb, size_t concurrency = default_concurrency);
+  ~IconFetcher();
+
+  bool Start();
+  void Stop();  // drops queued requests
+
+  // thread safe, request for path which is already queued or in progress is ignored
+  void Fetch(const common::uri::Uri& uri, const std::string& path);
+
+  size_t GetUpdatedCount() const;
+  size_t GetNotModifiedCount() const;
+  size_t GetFailedCount() const;
+  size_t GetConnectionsCount() const;  // opened connections, less than requests when reused
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(IconFetcher);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  struct Request {
+    common::uri::Uri uri;
+    std::string path;
+  };
+
+  int Run();
+
+  const updated_callback_t updated_cb_;
+  std::vector<common::shared_ptr<common::threads::Thread<int> > > workers_;
+  common::mutex mutex_;
+  common::condition_variable cond_;
+  std::deque<Request> requests_;
+  std::set<std::string> pending_;
+  bool running_;
+  ActiveSockets* const sockets_;
+
+  common::atomic<size_t> updated_;
+  common::atomic<size_t> not_modified_;
+  common::atomic<size_t> failed_;
+  common::atomic<size_t> connections_;
+};
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -27,11 +27,16 @@
 
 #include "client/av_sdl_utils.h"
 #include "client/sdl_utils.h"
+#include "client/text_texture_cache.h"
 
+#include "client/core/decoder_skip.h"        // for ConvertDecoderSkipLevelToString
+#include "client/core/decoder_threading.h"   // for ConvertDecoderThreadingToString
 #include "client/core/frames/audio_frame.h"  // for AudioFrame
 #include "client/core/frames/video_frame.h"  // for VideoFrame
 #include "client/core/sdl_utils.h"
-#include "client/core/video_state.h"  // for VideoState
+#include "client/core/stream_reaper.h"  // for StreamReaper
+#include "client/core/trace.h"          // for TRACE_BEGIN, TRACE_END
+#include "client/core/video_state.h"    // for VideoState
 
 /* Step size for volume control */
 #define VOLUME_STEP 1
@@ -104,9 +109,14 @@ ISimplePlayer::ISimplePlayer(const PlayerOptions& options)
       muted_(false),
       show_statstic_(false),
       render_texture_(NULL),
+      text_cache_(NULL),
+      reaper_(new core::StreamReaper),
       update_video_timer_interval_msec_(0),
+      present_lead_msec_(0),
       last_pts_checkpoint_(core::invalid_clock()),
-      video_frames_handled_(0) {
+      last_pts_checkpoint_ts_(0),
+      presented_frames_(0),
+      uploaded_bytes_(0) {
   UpdateDisplayInterval(min_fps);
   // stable audio option
   options_.audio_volume = stable_value_in_range(options_.audio_volume, 0, 100);
@@ -145,6 +155,7 @@ void ISimplePlayer::SetMute(bool mute) {
 }
 
 ISimplePlayer::~ISimplePlayer() {
+  destroy(&reaper_);
   if (core::hw_device_ctx) {
     av_buffer_unref(&core::hw_device_ctx);
     core::hw_device_ctx = NULL;
@@ -247,10 +258,6 @@ bool ISimplePlayer::HandleRequestAudio(core::VideoState* stream,
   return true;
 }
 
-void ISimplePlayer::HanleAudioMix(uint8_t* audio_stream_ptr, const uint8_t* src, uint32_t len, int volume) {
-  SDL_MixAudio(audio_stream_ptr, src, len, ConvertToSDLVolume(volume));
-}
-
 bool ISimplePlayer::HandleRequestVideo(core::VideoState* stream,
                                        int width,
                                        int height,
@@ -276,6 +283,9 @@ bool ISimplePlayer::HandleRequestVideo(core::VideoState* stream,
 void ISimplePlayer::HandleRequestVideoEvent(core::events::RequestVideoEvent* event) {
   core::events::RequestVideoEvent* avent = static_cast<core::events::RequestVideoEvent*>(event);
   core::events::FrameInfo fr = avent->info();
+  if (fr.stream_ != stream_) {  // stream already freed
+    return;
+  }
   bool res = fr.stream_->RequestVideo(fr.width, fr.height, fr.av_pixel_format, fr.aspect_ratio);
   if (res) {
     return;
@@ -287,6 +297,9 @@ void ISimplePlayer::HandleRequestVideoEvent(core::events::RequestVideoEvent* eve
 
 void ISimplePlayer::HandleQuitStreamEvent(core::events::QuitStreamEvent* event) {
   core::events::QuitStreamInfo inf = event->info();
+  if (inf.stream_ != stream_) {  // stream already freed or not playing yet
+    return;
+  }
   if (inf.stream_ && inf.stream_->IsAborted()) {
     return;
   }
@@ -300,6 +313,10 @@ void ISimplePlayer::HandlePreExecEvent(core::events::PreExecEvent* event) {
   if (inf.code == EXIT_SUCCESS) {
     const std::string absolute_source_dir = common::file_system::absolute_path_from_relative(RELATIVE_SOURCE_DIR);
     render_texture_ = new TextureSaver;
+    text_cache_ = new TextTextureCache;
+    if (!reaper_->Start()) {
+      WARNING_LOG() << "Couldn't start stream reaper, streams will be freed on main thread.";
+    }
 
     const std::string font_path = common::file_system::make_path(absolute_source_dir, MAIN_FONT_PATH_RELATIVE);
     const char* font_path_ptr = common::utils::c_strornull(font_path);
@@ -314,6 +331,7 @@ void ISimplePlayer::HandlePostExecEvent(core::events::PostExecEvent* event) {
   core::events::PostExecInfo inf = event->info();
   if (inf.code == EXIT_SUCCESS) {
     FreeStreamSafe();
+    reaper_->Stop();
     if (font_) {
       TTF_CloseFont(font_);
       font_ = NULL;
@@ -323,6 +341,7 @@ void ISimplePlayer::HandlePostExecEvent(core::events::PostExecEvent* event) {
     destroy(&audio_params_);
 
     destroy(&render_texture_);
+    destroy(&text_cache_);
 
     if (renderer_) {
       SDL_DestroyRenderer(renderer_);
@@ -338,7 +357,6 @@ void ISimplePlayer::HandlePostExecEvent(core::events::PostExecEvent* event) {
 }
 
 void ISimplePlayer::HandleTimerEvent(core::events::TimerEvent* event) {
-  UNUSED(event);
   const core::msec_t cur_time = core::GetCurrentMsec();
   core::msec_t diff_currsor = cur_time - cursor_last_shown_;
   if (show_cursor_ && diff_currsor > CURSOR_HIDE_DELAY_MSEC) {
@@ -351,6 +369,22 @@ void ISimplePlayer::HandleTimerEvent(core::events::TimerEvent* event) {
     show_volume_ = false;
   }
   DrawDisplay();
+
+  const core::events::TimeInfo inf = event->info();
+  if (show_cursor_) {
+    inf.RequestNextTimer(cursor_last_shown_ + CURSOR_HIDE_DELAY_MSEC + 1);
+  }
+  if (show_volume_) {
+    inf.RequestNextTimer(volume_last_shown_ + VOLUME_HIDE_DELAY_MSEC + 1);
+  }
+  if (current_state_ == PLAYING_STATE && stream_ && !stream_->IsPaused()) {
+    const core::clock64_t deadline = stream_->GetNextFrameDeadline();
+    if (core::IsValidClock(deadline)) {
+      inf.RequestNextTimer(core::ClockToMsec(deadline));
+    } else {  // next picture isn't decoded yet
+      inf.RequestNextTimer(cur_time + update_video_timer_interval_msec_ / 2);
+    }
+  }
 }
 
 void ISimplePlayer::HandleLircPressEvent(core::events::LircPressEvent* event) {
@@ -526,6 +560,7 @@ void ISimplePlayer::HandleWindowResizeEvent(core::events::WindowResizeEvent* eve
   core::events::WindowResizeInfo inf = event->info();
   window_size_ = inf.size;
   if (stream_) {
+    stream_->SetDisplaySize(window_size_);
     stream_->RefreshRequest();
   }
 }
@@ -550,11 +585,19 @@ void ISimplePlayer::HandleQuitEvent(core::events::QuitEvent* event) {
 void ISimplePlayer::FreeStreamSafe() {
   CHECK(THREAD_MANAGER()->IsMainThread());
   if (stream_) {
-    stream_->Abort();
-    destroy(&stream_);
+    core::VideoState* stream = stream_;
+    SDL_LockAudio();  // audio callback can be inside of stream
+    stream_ = nullptr;
+    SDL_UnlockAudio();
+    ReapStream(stream);
   }
 }
 
+void ISimplePlayer::ReapStream(core::VideoState* stream) {
+  CHECK(THREAD_MANAGER()->IsMainThread());
+  reaper_->Reap(stream);
+}
+
 void ISimplePlayer::UpdateDisplayInterval(AVRational fps) {
   if (fps.num == 0) {
     fps = min_fps;
@@ -602,7 +645,6 @@ void ISimplePlayer::DrawDisplay() {
   } else {
     NOTREACHED();
   };
-  video_frames_handled_++;
 }
 
 void ISimplePlayer::DrawFailedStatus() {
@@ -619,10 +661,10 @@ void ISimplePlayer::DrawFailedStatus() {
 void ISimplePlayer::DrawPlayingStatus() {
   CHECK(THREAD_MANAGER()->IsMainThread());
   core::frames::VideoFrame* frame = stream_->TryToGetVideoFrame();
-  uint32_t frames_per_sec = 1000 / update_video_timer_interval_msec_;
-  uint32_t mod = frames_per_sec * no_data_panic_sec;
-  bool need_to_check_is_alive = video_frames_handled_ % mod == 0;
+  const core::msec_t cur_time = core::GetCurrentMsec();
+  bool need_to_check_is_alive = cur_time - last_pts_checkpoint_ts_ >= no_data_panic_sec * 1000;
   if (need_to_check_is_alive) {
+    last_pts_checkpoint_ts_ = cur_time;
     INFO_LOG() << "No data checkpoint.";
     core::VideoState::stats_t stats = stream_->GetStatistic();
     core::clock64_t cl = stats->master_pts;
@@ -640,14 +682,13 @@ void ISimplePlayer::DrawPlayingStatus() {
     return;
   }
 
+  TRACE_BEGIN(draw_start);
   int format = frame->format;
   int width = frame->width;
   int height = frame->height;
 
-  Uint32 sdl_format;
-  if (format == AV_PIX_FMT_YUV420P) {
-    sdl_format = SDL_PIXELFORMAT_YV12;
-  } else {
+  Uint32 sdl_format = ConvertPixelFormatToSDL(static_cast<AVPixelFormat>(format));
+  if (sdl_format == SDL_PIXELFORMAT_UNKNOWN) {
     sdl_format = SDL_PIXELFORMAT_ARGB8888;
   }
 
@@ -664,11 +705,17 @@ void ISimplePlayer::DrawPlayingStatus() {
     return;
   }
 
-  common::Error err = UploadTexture(texture, frame->frame);
-  if (err && err->IsError()) {
-    DEBUG_MSG_ERROR(err);
-    return;
+  if (render_texture_->GetContentId() != frame->picture_id) {
+    common::Error err = UploadTexture(texture, frame->frame);
+    if (err && err->IsError()) {
+      render_texture_->SetContentId(0);
+      DEBUG_MSG_ERROR(err);
+      return;
+    }
+    render_texture_->SetContentId(frame->picture_id);
+    uploaded_bytes_ += CalcUploadTextureSize(frame->frame);
   }
+  presented_frames_++;
 
   bool flip_v = frame->frame->linesize[0] < 0;
 
@@ -681,6 +728,8 @@ void ISimplePlayer::DrawPlayingStatus() {
 
   DrawInfo();
   SDL_RenderPresent(renderer_);
+  stream_->RegisterPresentation(core::GetRealClockTime());
+  TRACE_END(draw_start, "render", "draw", frame->pts);
 }  // namespace client
 
 void ISimplePlayer::DrawInitStatus() {
@@ -735,39 +784,94 @@ void ISimplePlayer::DrawStatistic() {
   std::string fmt_text = (is_unknown ? "N/A" : core::ConvertStreamFormatToString(stats->fmt));
   std::string hwaccel_text = (is_unknown ? "N/A" : common::ConvertToString(stats->active_hwaccel));
   std::transform(hwaccel_text.begin(), hwaccel_text.end(), hwaccel_text.begin(), ::toupper);
+  std::string dthreads_text =
+      (stats->fmt & core::HAVE_VIDEO_STREAM
+           ? core::ConvertDecoderThreadingToString(stats->decoder_thread_count, stats->decoder_thread_type)
+           : "N/A");
   double pts = stats->master_clock / 1000.0;
   std::string pts_text = (is_unknown ? "N/A" : common::ConvertToString(pts, 3));
   std::string fps_text = (is_unknown ? "N/A" : common::ConvertToString(stats->GetFps()));
   core::clock64_t diff = stats->GetDiffStreams();
   std::string diff_text = (is_unknown ? "N/A" : common::ConvertToString(diff));
-  std::string fd_text = (stats->fmt & core::HAVE_VIDEO_STREAM
-                             ? common::MemSPrintf("%d/%d", stats->frame_drops_early, stats->frame_drops_late)
-                             : "N/A");
+  std::string fd_text =
+      (stats->fmt & core::HAVE_VIDEO_STREAM
+           ? common::MemSPrintf("%d/%d skip %zu (%s)", stats->frame_drops_early, stats->frame_drops_late,
+                                stats->frame_skips,
+                                core::ConvertDecoderSkipLevelToString(
+                                    static_cast<core::DECODER_SKIP_LEVEL>(stats->decoder_skip_level)))
+           : "N/A");
   std::string vbitrate_text =
       (stats->fmt & core::HAVE_VIDEO_STREAM ? common::ConvertToString(stats->video_bandwidth * 8 / 1024) : "N/A");
   std::string abitrate_text =
       (stats->fmt & core::HAVE_AUDIO_STREAM ? common::ConvertToString(stats->audio_bandwidth * 8 / 1024) : "N/A");
+  std::string video_buffered_text =
+      (core::IsValidClock(stats->video_buffered) ? common::ConvertToString(stats->video_buffered) : "N/A");
   std::string video_queue_text =
-      (stats->fmt & core::HAVE_VIDEO_STREAM ? common::ConvertToString(stats->video_queue_size / 1024) : "N/A");
+      (stats->fmt & core::HAVE_VIDEO_STREAM
+           ? common::MemSPrintf("%s KB/%s msec", common::ConvertToString(stats->video_queue_size / 1024),
+                                video_buffered_text)
+           : "N/A");
+  std::string audio_buffered_text =
+      (core::IsValidClock(stats->audio_buffered) ? common::ConvertToString(stats->audio_buffered) : "N/A");
   std::string audio_queue_text =
-      (stats->fmt & core::HAVE_AUDIO_STREAM ? common::ConvertToString(stats->audio_queue_size / 1024) : "N/A");
-
-#define STATS_LINES_COUNT 10
+      (stats->fmt & core::HAVE_AUDIO_STREAM
+           ? common::MemSPrintf("%s KB/%s msec", common::ConvertToString(stats->audio_queue_size / 1024),
+                                audio_buffered_text)
+           : "N/A");
+  std::string teardown_text =
+      reaper_->GetReapedCount()
+          ? common::MemSPrintf("%s/%s", common::ConvertToString(reaper_->GetLastTeardownTime()),
+                               common::ConvertToString(reaper_->GetMaxTeardownTime()))
+          : "N/A";
+  std::string present_text =
+      (stats->fmt & core::HAVE_VIDEO_STREAM ? common::MemSPrintf("%s/%s", common::ConvertToString(stats->present_error),
+                                                                 common::ConvertToString(stats->present_error_avg, 1))
+                                            : "N/A");
+  std::string latency_text =
+      (stats->live_latency_target && core::IsValidClock(stats->live_latency)
+           ? common::MemSPrintf("%s/%s msec x%s", common::ConvertToString(stats->live_latency),
+                                common::ConvertToString(stats->live_latency_target),
+                                common::ConvertToString(stats->live_speed, 2))
+           : "N/A");
+  std::string readahead_text =
+      (stats->readahead_capacity
+           ? common::MemSPrintf("%s%% stalls %s/%s msec",
+                                common::ConvertToString(stats->readahead_filled * 100 / stats->readahead_capacity),
+                                common::ConvertToString(stats->readahead_stalls),
+                                common::ConvertToString(stats->readahead_stall_time))
+           : "N/A");
+  std::string upload_text =
+      (presented_frames_ ? common::ConvertToString(uploaded_bytes_ / 1024.0 / presented_frames_, 1) : "N/A");
+  std::string text_cache_text =
+      (text_cache_ ? common::MemSPrintf("%zu/%zu %zu KB", text_cache_->GetHits(), text_cache_->GetMisses(),
+                                        text_cache_->GetUsedBytes() / 1024)
+                   : "N/A");
+
+#define STATS_LINES_COUNT 17
   const std::string result_text = common::MemSPrintf(
       "FMT: %s\n"
       "HWACCEL: %s\n"
+      "DTHREADS: %s\n"
       "DIFF: %s msec\n"
       "PTS: %s\n"
       "FPS: %s\n"
       "FRAMEDROP: %s\n"
       "VBITRATE: %s kb/s\n"
       "ABITRATE: %s kb/s\n"
-      "VQUEUE: %s KB\n"
-      "AQUEUE: %s KB",
-      fmt_text, hwaccel_text, diff_text, pts_text, fps_text, fd_text, vbitrate_text, abitrate_text, video_queue_text,
-      audio_queue_text);
-
-  int h = TTF_FontLineSkip(font_) * STATS_LINES_COUNT;
+      "VQUEUE: %s\n"
+      "AQUEUE: %s\n"
+      "UPLOAD: %s KB/frame\n"
+      "PRESENT: %s msec\n"
+      "LATENCY: %s\n"
+      "READAHEAD: %s\n"
+      "TEXTCACHE: %s\n"
+      "TEARDOWN: %s msec",
+      fmt_text, hwaccel_text, dthreads_text, diff_text, pts_text, fps_text, fd_text, vbitrate_text, abitrate_text,
+      video_queue_text, audio_queue_text, upload_text, present_text, latency_text, readahead_text,
+      text_cache_text, teardown_text);
+
+  const int line_height = TTF_FontLineSkip(font_);
+  int h = line_height * STATS_LINES_COUNT;
   if (h > statistic_rect.h) {
     h = statistic_rect.h;
   }
@@ -776,7 +880,17 @@ void ISimplePlayer::DrawStatistic() {
   SDL_SetRenderDrawColor(renderer_, 171, 217, 98, Uint8(SDL_ALPHA_OPAQUE * 0.5));
   SDL_RenderFillRect(renderer_, &dst);
 
-  DrawWrappedTextInRect(result_text, text_color, dst);
+  // line by line, so only changed values are rendered again
+  size_t start = 0;
+  for (int y = dst.y; start < result_text.size() && y + line_height <= dst.y + dst.h; y += line_height) {
+    size_t end = result_text.find('\n', start);
+    if (end == std::string::npos) {
+      end = result_text.size();
+    }
+    SDL_Rect line_rect = {dst.x, y, dst.w, line_height};
+    DrawWrappedTextInRect(result_text.substr(start, end - start), text_color, line_rect);
+    start = end + 1;
+  }
 }
 
 void ISimplePlayer::DrawVolume() {
@@ -798,32 +912,36 @@ void ISimplePlayer::DrawVolume() {
 
 void ISimplePlayer::DrawCenterTextInRect(const std::string& text, SDL_Color text_color, SDL_Rect rect) {
   const char* text_ptr = common::utils::c_strornull(text);
-  if (!renderer_ || !font_ || !text_ptr) {
+  if (!renderer_ || !font_ || !text_ptr || !text_cache_) {
     DNOTREACHED();
     return;
   }
 
-  SDL_Surface* text_surf = TTF_RenderText_Blended(font_, text_ptr, text_color);
-  SDL_Rect dst = GetCenterRect(rect, text_surf->w, text_surf->h);
-  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, text_surf);
+  int width = 0, height = 0;
+  SDL_Texture* texture = text_cache_->GetTexture(renderer_, font_, text, text_color, 0, &width, &height);
+  if (!texture) {
+    return;
+  }
+
+  SDL_Rect dst = GetCenterRect(rect, width, height);
   SDL_RenderCopy(renderer_, texture, NULL, &dst);
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(text_surf);
 }
 
 void ISimplePlayer::DrawWrappedTextInRect(const std::string& text, SDL_Color text_color, SDL_Rect rect) {
   const char* text_ptr = common::utils::c_strornull(text);
-  if (!renderer_ || !font_ || !text_ptr) {
+  if (!renderer_ || !font_ || !text_ptr || !text_cache_) {
     DNOTREACHED();
     return;
   }
 
-  SDL_Surface* text_surf = TTF_RenderText_Blended_Wrapped(font_, text_ptr, text_color, rect.w);
-  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, text_surf);
-  rect.w = text_surf->w;
+  int width = 0, height = 0;
+  SDL_Texture* texture = text_cache_->GetTexture(renderer_, font_, text, text_color, rect.w, &width, &height);
+  if (!texture) {
+    return;
+  }
+
+  rect.w = width;
   SDL_RenderCopy(renderer_, texture, NULL, &rect);
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(text_surf);
 }
 
 SDL_Renderer* ISimplePlayer::GetRenderer() const {
@@ -836,10 +954,17 @@ TTF_Font* ISimplePlayer::GetFont() const {
 
 void ISimplePlayer::InitWindow(const std::string& title, States status) {
   CalculateDispalySize();
+  if (stream_) {
+    stream_->SetDisplaySize(window_size_);
+  }
   if (!window_) {
     if (!core::create_window(window_size_, options_.is_full_screen, title, &renderer_, &window_)) {
       return;
     }
+    present_lead_msec_ = options_.align_to_vsync ? core::calculate_vsync_period(renderer_, window_) / 2 : 0;
+    if (stream_) {
+      stream_->SetPresentLead(present_lead_msec_);
+    }
   }
 
   SDL_SetWindowTitle(window_, title.c_str());
@@ -876,9 +1001,19 @@ void ISimplePlayer::PauseStream() {
 void ISimplePlayer::SetStream(core::VideoState* stream) {
   FreeStreamSafe();
   stream_ = stream;
+  presented_frames_ = 0;
+  uploaded_bytes_ = 0;
   if (!stream_) {
     common::Error err = common::make_error_value("Failed to create stream", common::Value::E_ERROR);
     SwitchToChannelErrorMode(err);
+    return;
+  }
+
+  stream_->SetPresentLead(present_lead_msec_);
+
+  if (stream_->IsWarm()) {
+    options_.last_showed_channel_id = stream_->GetId();
+    stream_->Promote();
   }
 }
 
@@ -887,6 +1022,10 @@ core::VideoState* ISimplePlayer::CreateStream(stream_id sid,
                                               core::AppOptions opt,
                                               core::ComplexOptions copt) {
   core::VideoState* stream = new core::VideoState(sid, uri, opt, copt, this);
+  if (renderer_) {
+    stream->SetRenderPixelFormats(GetSupportedPixelFormats(renderer_));
+  }
+  stream->SetDisplaySize(window_size_);
   options_.last_showed_channel_id = sid;
   int res = stream->Exec();
   if (res == EXIT_FAILURE) {
@@ -897,6 +1036,27 @@ core::VideoState* ISimplePlayer::CreateStream(stream_id sid,
   return stream;
 }
 
+core::VideoState* ISimplePlayer::CreateWarmStream(stream_id sid,
+                                                  const common::uri::Uri& uri,
+                                                  core::AppOptions opt,
+                                                  core::ComplexOptions copt,
+                                                  size_t max_buffer_bytes,
+                                                  bandwidth_t max_bandwidth) {
+  core::VideoState* stream = new core::VideoState(sid, uri, opt, copt, this);
+  if (renderer_) {
+    stream->SetRenderPixelFormats(GetSupportedPixelFormats(renderer_));
+  }
+  stream->SetDisplaySize(window_size_);
+  stream->SetWarm(max_buffer_bytes, max_bandwidth);
+  int res = stream->Exec();
+  if (res == EXIT_FAILURE) {
+    delete stream;
+    return nullptr;
+  }
+
+  return stream;
+}
+
 }  // namespace client
 }  // namespace fastotv
 }  // namespace fasto
@@ -33,8 +33,10 @@ namespace fastotv {
 namespace client {
 
 class TextureSaver;
+class TextTextureCache;
 namespace core {
 struct AudioParams;
+class StreamReaper;
 }  // namespace core
 
 int CalcHeightFontPlaceByRowCount(const TTF_Font* font, int row);
@@ -87,7 +89,6 @@ class ISimplePlayer : public StreamHandler, public core::events::EventListener {
                                   int wanted_sample_rate,
                                   core::AudioParams* audio_hw_params,
                                   int* audio_buff_size) override;
-  virtual void HanleAudioMix(uint8_t* audio_stream_ptr, const uint8_t* src, uint32_t len, int volume) override;
 
   // should executed in gui thread
   virtual bool HandleRequestVideo(core::VideoState* stream,
@@ -133,7 +134,15 @@ class ISimplePlayer : public StreamHandler, public core::events::EventListener {
                                  const common::uri::Uri& uri,
                                  core::AppOptions opt,
                                  core::ComplexOptions copt);
+  // demux only stream, SetStream promotes it to playing
+  core::VideoState* CreateWarmStream(stream_id sid,
+                                     const common::uri::Uri& uri,
+                                     core::AppOptions opt,
+                                     core::ComplexOptions copt,
+                                     size_t max_buffer_bytes,
+                                     bandwidth_t max_bandwidth);
   void SetStream(core::VideoState* stream);  // if stream == NULL => SwitchToChannelErrorMode
+  void ReapStream(core::VideoState* stream);  // aborts and frees stream in background
 
   SDL_Rect GetDrawRect() const;  // GetDisplayRect + with margins
   SDL_Rect GetDisplayRect() const;
@@ -196,11 +205,18 @@ class ISimplePlayer : public StreamHandler, public core::events::EventListener {
   bool show_statstic_;
 
   TextureSaver* render_texture_;
+  TextTextureCache* text_cache_;
+  core::StreamReaper* reaper_;
 
   uint32_t update_video_timer_interval_msec_;
+  core::clock64_t present_lead_msec_;  // half of vsync period if pictures are aligned to display refresh
 
   core::clock64_t last_pts_checkpoint_;
-  size_t video_frames_handled_;
+  core::msec_t last_pts_checkpoint_ts_;
+
+  // texture uploads, redraw of the already uploaded picture costs nothing
+  uint64_t presented_frames_;
+  uint64_t uploaded_bytes_;
 };
 
 }  // namespace client
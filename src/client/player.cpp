@@ -18,6 +18,8 @@
 
 #include "client/player.h"
 
+#include <algorithm>  // for find
+
 #include <SDL2/SDL_image.h>
 
 #include <common/convert2string.h>
@@ -25,17 +27,21 @@
 #include <common/threads/thread_manager.h>
 #include <common/utils.h>
 
-#include "client/ioservice.h"  // for IoService
+#include "client/channel_icon_cache.h"  // for ChannelIconCache
+#include "client/icon_fetcher.h"        // for IconFetcher
+#include "client/ioservice.h"           // for IoService
 
 #include "client/core/application/sdl2_application.h"
+#include "client/core/trace.h"        // for DumpTrace
+#include "client/core/video_state.h"  // for VideoState
 
 #include "client/sdl_utils.h"  // for IMG_LoadPNG, SurfaceSaver
-#include "client/utils.h"
 
 #define IMG_OFFLINE_CHANNEL_PATH_RELATIVE "share/resources/offline_channel.png"
 #define IMG_CONNECTION_ERROR_PATH_RELATIVE "share/resources/connection_error.png"
 
 #define CACHE_FOLDER_NAME "cache"
+#define TRACE_FILE_NAME "trace.json"
 
 #define FOOTER_HIDE_DELAY_MSEC 2000  // 2 sec
 #define KEYPAD_HIDE_DELAY_MSEC 3000  // 3 sec
@@ -52,8 +58,11 @@ Player::Player(const std::string& app_directory_absolute_path,
       offline_channel_texture_(nullptr),
       connection_error_texture_(nullptr),
       controller_(new IoService),
+      icons_(nullptr),
+      fetcher_(nullptr),
       current_stream_pos_(0),
       play_list_(),
+      warm_streams_(),
       show_footer_(false),
       footer_last_shown_(0),
       current_state_str_("Init"),
@@ -145,6 +154,16 @@ void Player::HandlePreExecEvent(core::events::PreExecEvent* event) {
     if (surface2) {
       connection_error_texture_ = new SurfaceSaver(surface2);
     }
+    const PlayerOptions opt = GetOptions();
+    icons_ = new ChannelIconCache(static_cast<size_t>(opt.icons_max_memory) * 1024);
+    if (!icons_->Start()) {
+      WARNING_LOG() << "Couldn't start channel icons loader.";
+    }
+    ChannelIconCache* icons = icons_;
+    fetcher_ = new IconFetcher([icons](const std::string& path) { icons->Invalidate(path); });
+    if (!fetcher_->Start()) {
+      WARNING_LOG() << "Couldn't start channel icons fetcher.";
+    }
     controller_->Start();
     SwitchToConnectMode();
   }
@@ -163,13 +182,38 @@ void Player::HandleTimerEvent(core::events::TimerEvent* event) {
     ResetKeyPad();
   }
 
+  const core::events::TimeInfo inf = event->info();
+  if (show_footer_) {
+    inf.RequestNextTimer(footer_last_shown_ + FOOTER_HIDE_DELAY_MSEC + 1);
+  }
+  if (show_keypad_) {
+    inf.RequestNextTimer(keypad_last_shown_ + KEYPAD_HIDE_DELAY_MSEC + 1);
+  }
   base_class::HandleTimerEvent(event);
 }
 
+void Player::HandleQuitStreamEvent(core::events::QuitStreamEvent* event) {
+  core::events::QuitStreamInfo inf = event->info();
+  for (auto it = warm_streams_.begin(); it != warm_streams_.end(); ++it) {
+    core::VideoState* stream = it->stream;
+    if (stream == inf.stream_) {
+      WARNING_LOG() << "Prewarm of channel " << stream->GetId() << " failed.";
+      warm_streams_.erase(it);
+      ReapStream(stream);
+      return;
+    }
+  }
+
+  base_class::HandleQuitStreamEvent(event);
+}
+
 void Player::HandlePostExecEvent(core::events::PostExecEvent* event) {
   core::events::PostExecInfo inf = event->info();
   if (inf.code == EXIT_SUCCESS) {
     controller_->Stop();
+    FreeWarmStreams();
+    destroy(&fetcher_);
+    destroy(&icons_);
     destroy(&offline_channel_texture_);
     destroy(&connection_error_texture_);
     play_list_.clear();
@@ -213,8 +257,7 @@ void Player::SwitchToPlayingMode() {
 
   size_t pos = current_stream_pos_;
   for (size_t i = 0; i < play_list_.size() && opt.last_showed_channel_id != invalid_stream_id; ++i) {
-    PlaylistEntry ent = play_list_[i];
-    ChannelInfo ch = ent.GetChannelInfo();
+    const ChannelInfo& ch = play_list_[i].GetChannelInfo();
     if (ch.GetId() == opt.last_showed_channel_id) {
       pos = i;
       break;
@@ -223,6 +266,7 @@ void Player::SwitchToPlayingMode() {
 
   core::VideoState* stream = CreateStreamPos(pos);
   SetStream(stream);
+  UpdateWarmStreams();
 }
 
 void Player::SwitchToAuthorizeMode() {
@@ -294,11 +338,6 @@ void Player::HandleReceiveChannelsEvent(core::events::ReceiveChannelsEvent* even
 
   for (const ChannelInfo& ch : channels) {
     PlaylistEntry entry = PlaylistEntry(cache_dir, ch);
-    const std::string icon_path = entry.GetIconPath();
-    const char* channel_icon_img_full_path_ptr = common::utils::c_strornull(icon_path);
-    SDL_Surface* surface = IMG_Load(channel_icon_img_full_path_ptr);
-    channel_icon_t shared_surface = common::make_shared<SurfaceSaver>(surface);
-    entry.SetIcon(shared_surface);
     play_list_.push_back(entry);
 
     if (is_exist_cache_root) {  // prepare cache folders for channels
@@ -317,43 +356,16 @@ void Player::HandleReceiveChannelsEvent(core::events::ReceiveChannelsEvent* even
         continue;
       }
 
-      EpgInfo epg = ch.GetEpg();
+      const EpgInfo& epg = ch.GetEpg();
       common::uri::Uri uri = epg.GetIconUrl();
       bool is_unknown_icon = EpgInfo::IsUnknownIconUrl(uri);
       if (is_unknown_icon) {
         continue;
       }
 
-      auto load_image_cb = [entry, uri, channel_dir]() {
-        const std::string channel_icon_path = entry.GetIconPath();
-        if (!common::file_system::is_file_exist(channel_icon_path)) {  // if not exist trying to download
-          common::buffer_t buff;
-          bool is_file_downloaded = DownloadFileToBuffer(uri, &buff);
-          if (!is_file_downloaded) {
-            return;
-          }
-
-          const uint32_t fl = common::file_system::File::FLAG_CREATE | common::file_system::File::FLAG_WRITE |
-                              common::file_system::File::FLAG_OPEN_BINARY;
-          common::file_system::File channel_icon_file;
-          common::ErrnoError err = channel_icon_file.Open(channel_icon_path, fl);
-          if (err && err->IsError()) {
-            DEBUG_MSG_ERROR(err);
-            return;
-          }
-
-          size_t writed;
-          err = channel_icon_file.Write(buff, &writed);
-          if (err && err->IsError()) {
-            DEBUG_MSG_ERROR(err);
-            err = channel_icon_file.Close();
-            return;
-          }
-
-          err = channel_icon_file.Close();
-        }
-      };
-      controller_->ExecInLoopThread(load_image_cb);
+      if (fetcher_) {
+        fetcher_->Fetch(uri, entry.GetIconPath());
+      }
     }
   }
 
@@ -443,6 +455,18 @@ void Player::HandleKeyPressEvent(core::events::KeyPressEvent* event) {
       ToggleShowProgramsList();
       break;
     }
+#if defined(HAVE_TRACING)
+    case SDLK_F6: {
+      const std::string trace_path = common::file_system::make_path(app_directory_absolute_path_, TRACE_FILE_NAME);
+      common::Error err = core::trace::DumpTrace(trace_path);
+      if (err && err->IsError()) {
+        DEBUG_MSG_ERROR(err);
+      } else {
+        INFO_LOG() << "Pipeline trace saved to: " << trace_path;
+      }
+      break;
+    }
+#endif
     case SDLK_PERIOD: {
       MoveToNextProgrammsPage();
       break;
@@ -535,25 +559,31 @@ void Player::MoveToPreviousProgrammsPage() {
   }
 }
 
-bool Player::GetChannelDescription(size_t pos, ChannelDescription* descr) const {
+bool Player::GetChannelDescription(size_t pos, ChannelDescription* descr) {
   if (!descr || pos >= play_list_.size()) {
     DNOTREACHED();
     return false;
   }
 
-  PlaylistEntry entry = play_list_[pos];
+  PlaylistEntry& entry = play_list_[pos];
   std::string decr = "N/A";
-  ChannelInfo url = entry.GetChannelInfo();
-  EpgInfo epg = url.GetEpg();
-  ProgrammeInfo prog;
-  if (epg.FindProgrammeByTime(common::time::current_mstime(), &prog)) {
-    decr = prog.GetTitle();
+  const ProgrammeInfo* prog = entry.GetCurrentProgramme(common::time::current_mstime());
+  if (prog) {
+    decr = prog->GetTitle();
   }
 
-  *descr = {pos, url.GetName(), decr, entry.GetIcon()};
+  *descr = {pos, entry.GetChannelInfo().GetName(), decr};
   return true;
 }
 
+channel_icon_t Player::GetChannelIcon(size_t pos, int size) {
+  if (!icons_ || pos >= play_list_.size()) {
+    return channel_icon_t();
+  }
+
+  return icons_->GetIcon(play_list_[pos].GetIconPath(), size);
+}
+
 void Player::HandleKeyPad(uint8_t key) {
   if (play_list_.empty()) {
     return;
@@ -604,6 +634,7 @@ void Player::FinishKeyPadInput() {
 
   core::VideoState* stream = CreateStreamPos(stabled_pos);
   SetStream(stream);
+  UpdateWarmStreams();
 }
 
 void Player::ResetKeyPad() {
@@ -661,7 +692,7 @@ void Player::DrawProgramsList() {
       std::string number_str = common::ConvertToString(i + 1);
       DrawCenterTextInRect(number_str, text_color, number_rect);
 
-      channel_icon_t icon = descr.icon;
+      channel_icon_t icon = GetChannelIcon(i, font_height_2line);
       shift = keypad_width;  // in any case shift should be
       if (icon) {
         SDL_Texture* img = icon->GetTexture(render);
@@ -748,7 +779,7 @@ void Player::DrawFooter() {
         h = footer_rect.h;
       }
 
-      channel_icon_t icon = descr.icon;
+      channel_icon_t icon = GetChannelIcon(current_stream_pos_, h);
       int shift = 0;
       if (icon) {
         SDL_Texture* img = icon->GetTexture(render);
@@ -813,11 +844,13 @@ void Player::DrawInitStatus() {
 void Player::MoveToNextStream() {
   core::VideoState* stream = CreateNextStream();
   SetStream(stream);
+  UpdateWarmStreams();
 }
 
 void Player::MoveToPreviousStream() {
   core::VideoState* stream = CreatePrevStream();
   SetStream(stream);
+  UpdateWarmStreams();
 }
 
 core::VideoState* Player::CreateNextStream() {
@@ -846,15 +879,96 @@ core::VideoState* Player::CreateStreamPos(size_t pos) {
   CHECK(THREAD_MANAGER()->IsMainThread());
   current_stream_pos_ = pos;
 
-  PlaylistEntry entry = play_list_[current_stream_pos_];
-  ChannelInfo url = entry.GetChannelInfo();
+  core::VideoState* warm = TakeWarmStream(pos);
+  if (warm) {
+    return warm;
+  }
+
+  const ChannelInfo& url = play_list_[current_stream_pos_].GetChannelInfo();
   stream_id sid = url.GetId();
+  core::VideoState* stream = CreateStream(sid, url.GetUrl(), GetStreamOptionsPos(pos), copt_);
+  return stream;
+}
+
+core::AppOptions Player::GetStreamOptionsPos(size_t pos) const {
+  const PlaylistEntry& entry = play_list_[pos];
+  const ChannelInfo& url = entry.GetChannelInfo();
   core::AppOptions copy = GetStreamOptions();
   copy.enable_audio = url.IsEnableVideo();
   copy.enable_video = url.IsEnableAudio();
+  copy.probe_cache_path = entry.GetProbeCachePath();
+  return copy;
+}
 
-  core::VideoState* stream = CreateStream(sid, url.GetUrl(), copy, copt_);
-  return stream;
+void Player::UpdateWarmStreams() {
+  CHECK(THREAD_MANAGER()->IsMainThread());
+  const PlayerOptions opt = GetOptions();
+  std::vector<size_t> adjacent;
+  if (opt.prewarm_adjacent_streams && play_list_.size() > 1) {
+    adjacent.push_back(GenerateNextPosition());
+    const size_t prev_pos = GeneratePrevPosition();
+    if (prev_pos != adjacent[0]) {
+      adjacent.push_back(prev_pos);
+    }
+  }
+
+  for (auto it = warm_streams_.begin(); it != warm_streams_.end();) {
+    if (std::find(adjacent.begin(), adjacent.end(), it->pos) != adjacent.end()) {
+      ++it;
+      continue;
+    }
+
+    core::VideoState* stream = it->stream;
+    it = warm_streams_.erase(it);
+    ReapStream(stream);
+  }
+
+  if (adjacent.empty()) {
+    return;
+  }
+
+  // limits are shared by all warm streams
+  const size_t max_buffer_bytes = static_cast<size_t>(opt.prewarm_max_memory) * 1024 / adjacent.size();
+  const bandwidth_t max_bandwidth = static_cast<bandwidth_t>(opt.prewarm_max_bandwidth) * 1024 / 8 / adjacent.size();
+  for (size_t pos : adjacent) {
+    bool is_warm = false;
+    for (const WarmStream& warm : warm_streams_) {
+      if (warm.pos == pos) {
+        is_warm = true;
+        break;
+      }
+    }
+    if (is_warm) {
+      continue;
+    }
+
+    const ChannelInfo& url = play_list_[pos].GetChannelInfo();
+    core::VideoState* stream = CreateWarmStream(url.GetId(), url.GetUrl(), GetStreamOptionsPos(pos), copt_,
+                                                max_buffer_bytes, max_bandwidth);
+    if (stream) {
+      warm_streams_.push_back({pos, stream});
+    }
+  }
+}
+
+core::VideoState* Player::TakeWarmStream(size_t pos) {
+  for (auto it = warm_streams_.begin(); it != warm_streams_.end(); ++it) {
+    if (it->pos == pos) {
+      core::VideoState* stream = it->stream;
+      warm_streams_.erase(it);
+      return stream;
+    }
+  }
+
+  return nullptr;
+}
+
+void Player::FreeWarmStreams() {
+  CHECK(THREAD_MANAGER()->IsMainThread());
+  for (const WarmStream& warm : warm_streams_) {
+    ReapStream(warm.stream);
+  }
+  warm_streams_.clear();
 }
 
 size_t Player::GenerateNextPosition() const {
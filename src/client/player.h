@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "client/channel_icon_cache.h"  // for channel_icon_t
 #include "client/isimple_player.h"
 #include "client/playlist_entry.h"
 
@@ -28,12 +29,12 @@ namespace fastotv {
 namespace client {
 
 class IoService;
+class IconFetcher;
 
 struct ChannelDescription {
   size_t pos;
   std::string title;
   std::string description;
-  channel_icon_t icon;
 };
 
 class Player : public ISimplePlayer {
@@ -61,6 +62,7 @@ class Player : public ISimplePlayer {
   virtual void HandlePostExecEvent(core::events::PostExecEvent* event) override;
 
   virtual void HandleTimerEvent(core::events::TimerEvent* event) override;
+  virtual void HandleQuitStreamEvent(core::events::QuitStreamEvent* event) override;
 
   virtual void HandleBandwidthEstimationEvent(core::events::BandwidthEstimationEvent* event);
   virtual void HandleClientConnectedEvent(core::events::ClientConnectedEvent* event);
@@ -84,7 +86,8 @@ class Player : public ISimplePlayer {
 
  private:
   int GetMaxProgrammsLines() const;
-  bool GetChannelDescription(size_t pos, ChannelDescription* descr) const;
+  bool GetChannelDescription(size_t pos, ChannelDescription* descr);
+  channel_icon_t GetChannelIcon(size_t pos, int size);  // empty until decoded
 
   void HandleKeyPad(uint8_t key);
   void FinishKeyPadInput();
@@ -116,6 +119,12 @@ class Player : public ISimplePlayer {
   core::VideoState* CreateNextStream();
   core::VideoState* CreatePrevStream();
   core::VideoState* CreateStreamPos(size_t pos);
+  core::AppOptions GetStreamOptionsPos(size_t pos) const;
+
+  // zapping accelerator, adjacent channels are kept opened in demux only mode
+  void UpdateWarmStreams();
+  core::VideoState* TakeWarmStream(size_t pos);  // nullptr if pos isn't warm
+  void FreeWarmStreams();
 
   size_t GenerateNextPosition() const;
   size_t GeneratePrevPosition() const;
@@ -127,10 +136,18 @@ class Player : public ISimplePlayer {
   SurfaceSaver* connection_error_texture_;
 
   IoService* controller_;
+  ChannelIconCache* icons_;
+  IconFetcher* fetcher_;
 
   size_t current_stream_pos_;
   std::vector<PlaylistEntry> play_list_;
 
+  struct WarmStream {
+    size_t pos;
+    core::VideoState* stream;
+  };
+  std::vector<WarmStream> warm_streams_;
+
   bool show_footer_;
   core::msec_t footer_last_shown_;
   std::string current_state_str_;
@@ -29,7 +29,12 @@ PlayerOptions::PlayerOptions()
       default_size(width, height),
       screen_size(0, 0),
       audio_volume(volume),
-      last_showed_channel_id(invalid_stream_id) {}
+      last_showed_channel_id(invalid_stream_id),
+      prewarm_adjacent_streams(false),
+      prewarm_max_memory(prewarm_memory),
+      prewarm_max_bandwidth(0),
+      align_to_vsync(false),
+      icons_max_memory(icons_memory) {}
 
 }  // namespace client
 }  // namespace fastotv
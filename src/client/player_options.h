@@ -25,7 +25,7 @@ namespace fastotv {
 namespace client {
 
 struct PlayerOptions {
-  enum { width = 640, height = 480, volume = 100 };
+  enum { width = 640, height = 480, volume = 100, prewarm_memory = 16 * 1024, icons_memory = 8 * 1024 };
   PlayerOptions();
 
   bool exit_on_keydown;
@@ -37,6 +37,14 @@ struct PlayerOptions {
 
   int audio_volume;  // Range: 0 - 100
   stream_id last_showed_channel_id;
+
+  bool prewarm_adjacent_streams;  // keep next and previous channels opened for fast zapping
+  int prewarm_max_memory;         // KB, shared by all warm streams
+  int prewarm_max_bandwidth;      // kb/s, shared by all warm streams, 0 - unlimited
+
+  bool align_to_vsync;  // select pictures for the display refresh nearest to their deadline
+
+  int icons_max_memory;  // KB, decoded channel icons
 };
 
 }  // namespace client
@@ -23,15 +23,16 @@
 #define IMG_UNKNOWN_CHANNEL_PATH_RELATIVE "share/resources/unknown_channel.png"
 
 #define ICON_FILE_NAME "icon"
+#define PROBE_CACHE_FILE_NAME "probe.json"
 
 namespace fasto {
 namespace fastotv {
 namespace client {
 
-PlaylistEntry::PlaylistEntry() : info_(), icon_(), cache_dir_() {}
+PlaylistEntry::PlaylistEntry() : info_(), cache_dir_(), programmes_() {}
 
 PlaylistEntry::PlaylistEntry(const std::string& cache_root_dir, const ChannelInfo& info)
-    : info_(info), icon_(), cache_dir_() {
+    : info_(info), cache_dir_(), programmes_() {
   std::string id = info_.GetId();
   cache_dir_ = common::file_system::make_path(cache_root_dir, id);
 }
@@ -41,7 +42,7 @@ std::string PlaylistEntry::GetCacheDir() const {
 }
 
 std::string PlaylistEntry::GetIconPath() const {
-  EpgInfo epg = info_.GetEpg();
+  const EpgInfo& epg = info_.GetEpg();
   common::uri::Uri uri = epg.GetIconUrl();
   bool is_unknown_icon = EpgInfo::IsUnknownIconUrl(uri);
   if (is_unknown_icon) {
@@ -52,16 +53,21 @@ std::string PlaylistEntry::GetIconPath() const {
   return common::file_system::make_path(dir, ICON_FILE_NAME);
 }
 
-void PlaylistEntry::SetIcon(channel_icon_t icon) {
-  icon_ = icon;
+std::string PlaylistEntry::GetProbeCachePath() const {
+  std::string dir = GetCacheDir();
+  return common::file_system::make_path(dir, PROBE_CACHE_FILE_NAME);
 }
 
-channel_icon_t PlaylistEntry::GetIcon() const {
-  return icon_;
+const ChannelInfo& PlaylistEntry::GetChannelInfo() const {
+  return info_;
 }
 
-ChannelInfo PlaylistEntry::GetChannelInfo() const {
-  return info_;
+const ProgrammeInfo* PlaylistEntry::GetCurrentProgramme(timestamp_t time) {
+  return programmes_.GetCurrent(info_.GetEpg(), time);
+}
+
+const ProgrammeInfo* PlaylistEntry::GetNextProgramme(timestamp_t time) {
+  return programmes_.GetNext(info_.GetEpg(), time);
 }
 
 }  // namespace client
@@ -18,34 +18,32 @@
 
 #pragma once
 
-#include <common/smart_ptr.h>
-
 #include "channels_info.h"
 
+#include "client/programme_cache.h"
+
 namespace fasto {
 namespace fastotv {
 namespace client {
 
-class SurfaceSaver;
-typedef common::shared_ptr<SurfaceSaver> channel_icon_t;
-
 class PlaylistEntry {
  public:
   PlaylistEntry();
   PlaylistEntry(const std::string& cache_root_dir, const ChannelInfo& info);
 
-  ChannelInfo GetChannelInfo() const;
-
-  void SetIcon(channel_icon_t icon);
-  channel_icon_t GetIcon() const;
+  const ChannelInfo& GetChannelInfo() const;
+  // nullptr if nothing is on air, cheap enough to be called every frame
+  const ProgrammeInfo* GetCurrentProgramme(timestamp_t time);
+  const ProgrammeInfo* GetNextProgramme(timestamp_t time);
 
   std::string GetCacheDir() const;
   std::string GetIconPath() const;
+  std::string GetProbeCachePath() const;
 
  private:
   ChannelInfo info_;
-  channel_icon_t icon_;
   std::string cache_dir_;
+  ProgrammeCache programmes_;
 };
 
 }  // namespace client
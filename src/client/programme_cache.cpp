@@ -0,0 +1,88 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "client/programme_cache.h"
+
+#include <limits>  // for numeric_limits
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+ProgrammeCache::ProgrammeCache()
+    : valid_(false),
+      valid_from_(0),
+      valid_until_(0),
+      has_current_(false),
+      current_(),
+      has_next_(false),
+      next_(),
+      lookups_(0) {}
+
+const ProgrammeInfo* ProgrammeCache::GetCurrent(const EpgInfo& epg, timestamp_t time) {
+  Update(epg, time);
+  return has_current_ ? &current_ : nullptr;
+}
+
+const ProgrammeInfo* ProgrammeCache::GetNext(const EpgInfo& epg, timestamp_t time) {
+  Update(epg, time);
+  return has_next_ ? &next_ : nullptr;
+}
+
+void ProgrammeCache::Invalidate() {
+  valid_ = false;
+}
+
+size_t ProgrammeCache::GetLookups() const {
+  return lookups_;
+}
+
+void ProgrammeCache::Update(const EpgInfo& epg, timestamp_t time) {
+  if (valid_ && time >= valid_from_ && time <= valid_until_) {
+    return;
+  }
+
+  lookups_++;
+  const EpgInfo::programs_t& programs = epg.GetPrograms();
+  size_t index;
+  has_current_ = epg.FindProgrammeIndexByTime(time, &index);
+  if (has_current_) {
+    current_ = programs[index];
+  }
+
+  const size_t next_index = epg.FindNextProgrammeIndex(time);
+  has_next_ = next_index < programs.size();
+  if (has_next_) {
+    next_ = programs[next_index];
+  }
+
+  // earlier times are not predictable from this lookup, e.g. after clock goes back
+  valid_from_ = time;
+  valid_until_ = std::numeric_limits<timestamp_t>::max();
+  if (has_current_) {
+    valid_until_ = current_.GetStop();
+  }
+  if (has_next_ && next_.GetStart() - 1 < valid_until_) {  // started programme becomes current one
+    valid_until_ = next_.GetStart() - 1;
+  }
+  valid_ = true;
+}
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
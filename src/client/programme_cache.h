@@ -0,0 +1,62 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include "epg_info.h"
+#include "programme_info.h"
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+/*
+ * Current and next programme of one channel. Overlays ask for them every frame,
+ * EPG is searched again only when time leaves the interval where the cached answer holds:
+ * the current programme ends or the next one starts.
+ */
+class ProgrammeCache {
+ public:
+  ProgrammeCache();
+
+  // nullptr if nothing is on air at time, pointer is valid until next call
+  const ProgrammeInfo* GetCurrent(const EpgInfo& epg, timestamp_t time);
+  // the first programme which starts after time, nullptr if none
+  const ProgrammeInfo* GetNext(const EpgInfo& epg, timestamp_t time);
+  void Invalidate();  // epg changed
+
+  size_t GetLookups() const;  // epg searches, all other calls were answered from cache
+
+ private:
+  void Update(const EpgInfo& epg, timestamp_t time);
+
+  bool valid_;
+  timestamp_t valid_from_;  // cached answer holds for [valid_from_, valid_until_]
+  timestamp_t valid_until_;
+  bool has_current_;
+  ProgrammeInfo current_;
+  bool has_next_;
+  ProgrammeInfo next_;
+  size_t lookups_;
+};
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
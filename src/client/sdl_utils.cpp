@@ -18,8 +18,6 @@
 
 #include "client/sdl_utils.h"
 
-#include <SDL2/SDL_audio.h>
-
 namespace fasto {
 namespace fastotv {
 namespace client {
@@ -53,7 +51,7 @@ SDL_Texture* SurfaceSaver::GetTexture(SDL_Renderer* renderer) const {
       texture_ = NULL;
     }
 
-    texture_ = SDL_CreateTextureFromSurface(renderer_, surface_);
+    texture_ = SDL_CreateTextureFromSurface(renderer, surface_);
     renderer_ = renderer;
   }
 
@@ -76,7 +74,7 @@ int SurfaceSaver::GetHeightSurface() const {
   return surface_->h;
 }
 
-TextureSaver::TextureSaver() : texture_(NULL), renderer_(NULL) {}
+TextureSaver::TextureSaver() : texture_(NULL), renderer_(NULL), content_id_(0) {}
 
 int TextureSaver::GetWidth() const {
   Uint32 format;
@@ -110,6 +108,7 @@ SDL_Texture* TextureSaver::GetTexture(SDL_Renderer* renderer, int width, int hei
     SDL_DestroyTexture(texture_);
     texture_ = NULL;
     renderer_ = NULL;
+    content_id_ = 0;
 
     SDL_Texture* ltexture = NULL;
     common::Error err = CreateTexture(renderer, format, width, height, SDL_BLENDMODE_NONE, false, &ltexture);
@@ -124,6 +123,14 @@ SDL_Texture* TextureSaver::GetTexture(SDL_Renderer* renderer, int width, int hei
   return texture_;
 }
 
+uint64_t TextureSaver::GetContentId() const {
+  return content_id_;
+}
+
+void TextureSaver::SetContentId(uint64_t content_id) {
+  content_id_ = content_id;
+}
+
 TextureSaver::~TextureSaver() {
   if (texture_) {
     SDL_DestroyTexture(texture_);
@@ -181,11 +188,6 @@ SDL_Rect GetCenterRect(SDL_Rect rect, int width, int height) {
   return {calc_x, calc_y, calc_width, calc_height};
 }
 
-int ConvertToSDLVolume(int val) {
-  val = stable_value_in_range(val, 0, 100);
-  return stable_value_in_range(SDL_MIX_MAXVOLUME * val / 100, 0, SDL_MIX_MAXVOLUME);
-}
-
 }  // namespace client
 }  // namespace fastotv
 }  // namespace fasto
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <stdint.h>  // for uint64_t
+
 #include <SDL2/SDL_blendmode.h>  // for SDL_BlendMode
 #include <SDL2/SDL_render.h>     // for SDL_Renderer, SDL_Texture
 #include <SDL2/SDL_stdinc.h>     // for Uint32
@@ -56,9 +58,15 @@ class TextureSaver {
   int GetWidth() const;
   int GetHeight() const;
 
+  // id of picture which pixels are in texture, 0 if nothing uploaded
+  // texture recreation resets it, so redraw of the same picture can skip upload
+  uint64_t GetContentId() const;
+  void SetContentId(uint64_t content_id);
+
  private:
   mutable SDL_Texture* texture_;
   mutable SDL_Renderer* renderer_;
+  mutable uint64_t content_id_;
 };
 
 common::Error CreateTexture(SDL_Renderer* renderer,
@@ -71,8 +79,6 @@ common::Error CreateTexture(SDL_Renderer* renderer,
 
 SDL_Rect GetCenterRect(SDL_Rect rect, int width, int height);
 
-int ConvertToSDLVolume(int val);
-
 }  // namespace client
 }  // namespace fastotv
 }  // namespace fasto
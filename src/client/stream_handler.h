@@ -34,7 +34,6 @@ class StreamHandler : public core::VideoStateHandler {
                                   int wanted_sample_rate,
                                   core::AudioParams* audio_hw_params,
                                   int* audio_buff_size) override = 0;
-  virtual void HanleAudioMix(uint8_t* audio_stream_ptr, const uint8_t* src, uint32_t len, int volume) override = 0;
 
   virtual bool HandleRequestVideo(core::VideoState* stream,
                                   int width,
@@ -0,0 +1,140 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "client/text_texture_cache.h"
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+namespace {
+Uint32 PackColor(SDL_Color color) {
+  return (static_cast<Uint32>(color.r) << 24) | (static_cast<Uint32>(color.g) << 16) |
+         (static_cast<Uint32>(color.b) << 8) | color.a;
+}
+}  // namespace
+
+bool TextTextureCache::Key::operator<(const Key& other) const {
+  if (font != other.font) {
+    return font < other.font;
+  }
+  if (color != other.color) {
+    return color < other.color;
+  }
+  if (wrap_width != other.wrap_width) {
+    return wrap_width < other.wrap_width;
+  }
+  return text < other.text;
+}
+
+TextTextureCache::TextTextureCache(size_t budget)
+    : budget_(budget), renderer_(NULL), entries_(), index_(), used_bytes_(0), hits_(0), misses_(0) {}
+
+TextTextureCache::~TextTextureCache() {
+  Clear();
+}
+
+SDL_Texture* TextTextureCache::GetTexture(SDL_Renderer* renderer,
+                                          TTF_Font* font,
+                                          const std::string& text,
+                                          SDL_Color color,
+                                          int wrap_width,
+                                          int* width,
+                                          int* height) {
+  if (!renderer || !font || text.empty() || !width || !height) {
+    return NULL;
+  }
+
+  if (renderer_ != renderer) {
+    Clear();
+    renderer_ = renderer;
+  }
+
+  const Key key = {text, font, PackColor(color), wrap_width};
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, found->second);
+    hits_++;
+    *width = found->second->width;
+    *height = found->second->height;
+    return found->second->texture;
+  }
+
+  misses_++;
+  SDL_Surface* surface = wrap_width > 0 ? TTF_RenderText_Blended_Wrapped(font, text.c_str(), color, wrap_width)
+                                        : TTF_RenderText_Blended(font, text.c_str(), color);
+  if (!surface) {
+    return NULL;
+  }
+
+  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+  const Entry entry = {key, texture, surface->w, surface->h, static_cast<size_t>(surface->w) * surface->h * 4};
+  SDL_FreeSurface(surface);
+  if (!texture) {
+    return NULL;
+  }
+
+  entries_.push_front(entry);
+  index_[key] = entries_.begin();
+  used_bytes_ += entry.bytes;
+  Shrink();
+
+  *width = entry.width;
+  *height = entry.height;
+  return texture;
+}
+
+void TextTextureCache::Clear() {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    SDL_DestroyTexture(it->texture);
+  }
+  entries_.clear();
+  index_.clear();
+  used_bytes_ = 0;
+  renderer_ = NULL;
+}
+
+void TextTextureCache::Shrink() {
+  // newest texture stays even over budget, caller draws it right away
+  while (used_bytes_ > budget_ && entries_.size() > 1) {
+    const Entry& last = entries_.back();
+    SDL_DestroyTexture(last.texture);
+    used_bytes_ -= last.bytes;
+    index_.erase(last.key);
+    entries_.pop_back();
+  }
+}
+
+size_t TextTextureCache::GetBudget() const {
+  return budget_;
+}
+
+size_t TextTextureCache::GetUsedBytes() const {
+  return used_bytes_;
+}
+
+size_t TextTextureCache::GetHits() const {
+  return hits_;
+}
+
+size_t TextTextureCache::GetMisses() const {
+  return misses_;
+}
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -0,0 +1,98 @@
+/*  Copyright (C) 2014-2017 FastoGT. All right reserved.
+
+    This file is part of FastoTV.
+
+    FastoTV is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    FastoTV is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with FastoTV. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <stddef.h>  // for size_t
+
+#include <list>    // for list
+#include <map>     // for map
+#include <string>  // for string
+
+#include <SDL2/SDL_pixels.h>  // for SDL_Color
+#include <SDL2/SDL_render.h>  // for SDL_Renderer, SDL_Texture
+#include <SDL2/SDL_ttf.h>     // for TTF_Font
+
+#include <common/macros.h>  // for DISALLOW_COPY_AND_ASSIGN
+
+namespace fasto {
+namespace fastotv {
+namespace client {
+
+/*
+ * Keeps rendered text textures between frames, overlays redraw mostly the same strings,
+ * so only changed ones go through TTF rendering and texture upload.
+ * Least recently used textures are destroyed when budget is exceeded, budget 0 disables caching.
+ */
+class TextTextureCache {
+ public:
+  enum { default_budget = 4 * 1024 * 1024 };  // bytes
+
+  explicit TextTextureCache(size_t budget = default_budget);
+  ~TextTextureCache();
+
+  // wrap_width 0 - single line, texture is owned by cache and valid until next GetTexture or Clear
+  SDL_Texture* GetTexture(SDL_Renderer* renderer,
+                          TTF_Font* font,
+                          const std::string& text,
+                          SDL_Color color,
+                          int wrap_width,
+                          int* width,
+                          int* height);
+  void Clear();
+
+  size_t GetBudget() const;
+  size_t GetUsedBytes() const;
+  size_t GetHits() const;
+  size_t GetMisses() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TextTextureCache);
+
+  struct Key {
+    std::string text;
+    TTF_Font* font;
+    Uint32 color;
+    int wrap_width;
+
+    bool operator<(const Key& other) const;
+  };
+
+  struct Entry {
+    Key key;
+    SDL_Texture* texture;
+    int width;
+    int height;
+    size_t bytes;
+  };
+
+  typedef std::list<Entry> entries_t;
+
+  void Shrink();
+
+  const size_t budget_;
+  SDL_Renderer* renderer_;
+  entries_t entries_;  // most recently used first
+  std::map<Key, entries_t::iterator> index_;
+  size_t used_bytes_;
+  size_t hits_;
+  size_t misses_;
+};
+
+}  // namespace client
+}  // namespace fastotv
+}  // namespace fasto
@@ -28,7 +28,7 @@ namespace fasto {
 namespace fastotv {
 namespace client {
 
-bool DownloadFileToBuffer(const common::uri::Uri& uri, common::buffer_t* buff) {
+bool DownloadFileToBuffer(const common::uri::Uri& uri, common::buffer_t* buff, const AVIOInterruptCB* interrupt_cb) {
   if (!uri.IsValid() || !buff) {
     return false;
   }
@@ -46,6 +46,10 @@ bool DownloadFileToBuffer(const common::uri::Uri& uri, common::buffer_t* buff) {
     uri_str = uri.Url();
   }
 
+  if (interrupt_cb) {
+    ic->interrupt_callback = *interrupt_cb;
+  }
+
   const char* in_filename = common::utils::c_strornull(uri_str);
   int open_result = avformat_open_input(&ic, in_filename, NULL, NULL);
   if (open_result < 0) {
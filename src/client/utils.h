@@ -18,6 +18,10 @@
 
 #pragma once
 
+extern "C" {
+#include <libavformat/avio.h>  // for AVIOInterruptCB
+}
+
 #include <common/types.h>
 #include <common/url.h>
 
@@ -25,7 +29,10 @@ namespace fasto {
 namespace fastotv {
 namespace client {
 
-bool DownloadFileToBuffer(const common::uri::Uri& uri, common::buffer_t* buff);
+// interrupt_cb lets other thread abort blocking download
+bool DownloadFileToBuffer(const common::uri::Uri& uri,
+                          common::buffer_t* buff,
+                          const AVIOInterruptCB* interrupt_cb = NULL);
 
 }  // namespace client
 }  // namespace fastotv
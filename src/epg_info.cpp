@@ -18,6 +18,8 @@
 
 #include "epg_info.h"
 
+#include <algorithm>  // for max, stable_sort, upper_bound
+
 /*
 <channel id="id">
   <display-name lang="ru"></display-name>
@@ -35,11 +37,21 @@
 namespace fasto {
 namespace fastotv {
 
+namespace {
+bool programme_start_less(const ProgrammeInfo& left, const ProgrammeInfo& right) {
+  return left.GetStart() < right.GetStart();
+}
+
+bool time_less_programme_start(timestamp_t time, const ProgrammeInfo& prog) {
+  return time < prog.GetStart();
+}
+}  // namespace
+
 EpgInfo::EpgInfo()
-    : id_(invalid_epg_channel_id), uri_(), display_name_(), icon_src_(GetUnknownIconUrl()), programs_() {}
+    : id_(invalid_epg_channel_id), uri_(), display_name_(), icon_src_(GetUnknownIconUrl()), programs_(), max_stops_() {}
 
 EpgInfo::EpgInfo(epg_channel_id id, const common::uri::Uri& uri, const std::string& name)
-    : id_(id), uri_(uri), display_name_(name), icon_src_(GetUnknownIconUrl()), programs_() {}
+    : id_(id), uri_(uri), display_name_(name), icon_src_(GetUnknownIconUrl()), programs_(), max_stops_() {}
 
 bool EpgInfo::IsValid() const {
   return id_ != invalid_epg_channel_id && uri_.IsValid() && !display_name_.empty();
@@ -50,10 +62,24 @@ bool EpgInfo::FindProgrammeByTime(timestamp_t time, ProgrammeInfo* inf) const {
     return false;
   }
 
-  for (size_t i = 0; i < programs_.size(); ++i) {
-    ProgrammeInfo pr = programs_[i];
-    if (time >= pr.GetStart() && time <= pr.GetStop()) {
-      *inf = pr;
+  size_t index;
+  if (!FindProgrammeIndexByTime(time, &index)) {
+    return false;
+  }
+
+  *inf = programs_[index];
+  return true;
+}
+
+bool EpgInfo::FindProgrammeIndexByTime(timestamp_t time, size_t* index) const {
+  if (!index) {
+    return false;
+  }
+
+  // walk back only while some earlier programme can still be on air, one step for guides without overlaps
+  for (size_t i = FindNextProgrammeIndex(time); i > 0 && max_stops_[i - 1] >= time; --i) {
+    if (programs_[i - 1].GetStop() >= time) {
+      *index = i - 1;
       return true;
     }
   }
@@ -61,6 +87,11 @@ bool EpgInfo::FindProgrammeByTime(timestamp_t time, ProgrammeInfo* inf) const {
   return false;
 }
 
+size_t EpgInfo::FindNextProgrammeIndex(timestamp_t time) const {
+  programs_t::const_iterator it = std::upper_bound(programs_.begin(), programs_.end(), time, time_less_programme_start);
+  return it - programs_.begin();
+}
+
 void EpgInfo::SetUrl(const common::uri::Uri& url) {
   uri_ = url;
 }
@@ -91,9 +122,15 @@ void EpgInfo::SetIconUrl(const common::uri::Uri& url) {
 
 void EpgInfo::SetPrograms(const programs_t& progs) {
   programs_ = progs;
+  std::stable_sort(programs_.begin(), programs_.end(), programme_start_less);
+  max_stops_.resize(programs_.size());
+  for (size_t i = 0; i < programs_.size(); ++i) {
+    const timestamp_t stop = programs_[i].GetStop();
+    max_stops_[i] = i == 0 ? stop : std::max(max_stops_[i - 1], stop);
+  }
 }
 
-EpgInfo::programs_t EpgInfo::GetPrograms() const {
+const EpgInfo::programs_t& EpgInfo::GetPrograms() const {
   return programs_;
 }
 
@@ -115,7 +152,7 @@ common::Error EpgInfo::SerializeImpl(serialize_type* deserialized) const {
   json_object_object_add(obj, EPG_INFO_ICON_FIELD, json_object_new_string(icon_url_str.c_str()));
 
   json_object* jprograms = json_object_new_array();
-  for (ProgrammeInfo prog : programs_) {
+  for (const ProgrammeInfo& prog : programs_) {
     json_object* jprog = NULL;
     common::Error err = prog.Serialize(&jprog);
     if (err && err->IsError()) {
@@ -191,7 +228,7 @@ common::Error EpgInfo::DeSerialize(const serialize_type& serialized, value_type*
       }
       progs.push_back(prog);
     }
-    url.programs_ = progs;
+    url.SetPrograms(progs);
   }
 
   *obj = url;
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <string>  // for string
+#include <vector>  // for vector
 
 #include <common/error.h>   // for Error
 #include <common/macros.h>  // for WARN_UNUSED_RESULT
@@ -40,6 +41,11 @@ class EpgInfo : public JsonSerializer<EpgInfo> {
 
   bool IsValid() const;
   bool FindProgrammeByTime(timestamp_t time, ProgrammeInfo* inf) const;
+  // binary search over programmes sorted by start time, index in GetPrograms();
+  // if programmes overlap the latest started one which is still on air wins
+  bool FindProgrammeIndexByTime(timestamp_t time, size_t* index) const;
+  // index of the first programme which starts after time, GetPrograms().size() if none
+  size_t FindNextProgrammeIndex(timestamp_t time) const;
 
   void SetUrl(const common::uri::Uri& url);
   common::uri::Uri GetUrl() const;
@@ -53,8 +59,8 @@ class EpgInfo : public JsonSerializer<EpgInfo> {
   void SetIconUrl(const common::uri::Uri& url);
   common::uri::Uri GetIconUrl() const;
 
-  void SetPrograms(const programs_t& progs);
-  programs_t GetPrograms() const;
+  void SetPrograms(const programs_t& progs);  // sorted by start time on set
+  const programs_t& GetPrograms() const;
 
   static common::Error DeSerialize(const serialize_type& serialized, value_type* obj) WARN_UNUSED_RESULT;
 
@@ -71,7 +77,8 @@ class EpgInfo : public JsonSerializer<EpgInfo> {
   common::uri::Uri uri_;
   std::string display_name_;
   common::uri::Uri icon_src_;
-  programs_t programs_;
+  programs_t programs_;                // sorted by start time
+  std::vector<timestamp_t> max_stops_;  // max stop of programs_[0..i], lookup skips ended programmes by it
 };
 
 inline bool operator==(const EpgInfo& left, const EpgInfo& right) {
@@ -0,0 +1,95 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h>  // for atoi, rand, EXIT_SUCCESS
+#include <string.h>  // for memset
+
+#include <chrono>
+#include <vector>
+
+#include <SDL2/SDL_audio.h>
+
+#include "client/core/audio_mix.h"
+
+using namespace fasto::fastotv::client::core;
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+#define CALLBACK_SAMPLES (2048 * 2)  // stereo callback buffer
+#define VOLUME (AUDIO_MIX_MAX_VOLUME / 2)
+
+void PrintResult(const char* name, int count, double seconds) {
+  const double samples = static_cast<double>(count) * CALLBACK_SAMPLES;
+  printf("%-20s %10d buffers %8.3f sec %10.1f Msamples/sec %8.1f nsec/buffer\n", name, count, seconds,
+         samples / seconds / 1000000, seconds * 1000000000 / count);
+}
+
+template <typename T>
+void RunSDL(const char* name, SDL_AudioFormat format, const std::vector<T>& src, int count) {
+  std::vector<T> dst(src.size());
+  const Uint32 len = src.size() * sizeof(T);
+  auto start = bench_clock_t::now();
+  for (int i = 0; i < count; ++i) {
+    memset(dst.data(), 0, len);
+    SDL_MixAudioFormat(reinterpret_cast<Uint8*>(dst.data()), reinterpret_cast<const Uint8*>(src.data()), format, len,
+                       VOLUME);
+  }
+  std::chrono::duration<double> elapsed = bench_clock_t::now() - start;
+  PrintResult(name, count, elapsed.count());
+}
+
+void RunS16(AudioMixKernel kernel, const std::vector<int16_t>& src, int count) {
+  std::vector<int16_t> dst(src.size());
+  auto start = bench_clock_t::now();
+  for (int i = 0; i < count; ++i) {
+    ScaleAudioS16(dst.data(), src.data(), src.size(), VOLUME, kernel);
+  }
+  std::chrono::duration<double> elapsed = bench_clock_t::now() - start;
+  char name[32];
+  snprintf(name, sizeof(name), "s16 %s", ConvertAudioMixKernelToString(kernel));
+  PrintResult(name, count, elapsed.count());
+}
+
+void RunFlt(AudioMixKernel kernel, const std::vector<float>& src, int count) {
+  std::vector<float> dst(src.size());
+  auto start = bench_clock_t::now();
+  for (int i = 0; i < count; ++i) {
+    ScaleAudioFlt(dst.data(), src.data(), src.size(), VOLUME, kernel);
+  }
+  std::chrono::duration<double> elapsed = bench_clock_t::now() - start;
+  char name[32];
+  snprintf(name, sizeof(name), "flt %s", ConvertAudioMixKernelToString(kernel));
+  PrintResult(name, count, elapsed.count());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int count = 200000;
+  if (argc > 1) {
+    count = atoi(argv[1]);
+  }
+
+  std::vector<int16_t> s16(CALLBACK_SAMPLES);
+  std::vector<float> flt(CALLBACK_SAMPLES);
+  for (size_t i = 0; i < CALLBACK_SAMPLES; ++i) {
+    s16[i] = static_cast<int16_t>(rand() & 0xFFFF);
+    flt[i] = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+  }
+
+  const AudioMixKernel kernels[] = {AUDIO_MIX_KERNEL_C, AUDIO_MIX_KERNEL_SSE2, AUDIO_MIX_KERNEL_AVX2,
+                                    AUDIO_MIX_KERNEL_NEON};
+  RunSDL("s16 SDL_MixAudio", AUDIO_S16SYS, s16, count);
+  for (size_t i = 0; i < SDL_arraysize(kernels); ++i) {
+    if (IsAudioMixKernelSupported(kernels[i])) {
+      RunS16(kernels[i], s16, count);
+    }
+  }
+  RunSDL("flt SDL_MixAudio", AUDIO_F32SYS, flt, count);
+  for (size_t i = 0; i < SDL_arraysize(kernels); ++i) {
+    if (IsAudioMixKernelSupported(kernels[i])) {
+      RunFlt(kernels[i], flt, count);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h>  // for atoi, EXIT_SUCCESS, EXIT_FAILURE
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <common/sprintf.h>
+
+#include "channel_info.h"
+#include "epg_info.h"
+#include "programme_info.h"
+
+#include "client/programme_cache.h"
+
+using namespace fasto::fastotv;
+
+namespace {
+
+#define CHANNELS_COUNT 2000
+#define GUIDE_DAYS 7
+#define MSEC_PER_MINUTE (60 * 1000)
+#define MSEC_PER_DAY (24 * 60 * MSEC_PER_MINUTE)
+#define FRAME_STEP_MSEC (40 * 1000)  // much longer than real frame, so programme boundaries are crossed
+#define GUIDE_START 1500000000000
+
+// programmes from 15 to 90 minutes with realistic titles, so copies cost what they cost in player
+std::vector<ChannelInfo> MakeGuide() {
+  std::vector<ChannelInfo> channels;
+  channels.reserve(CHANNELS_COUNT);
+  for (int i = 0; i < CHANNELS_COUNT; ++i) {
+    const std::string id = common::MemSPrintf("channel%d.example", i);
+    EpgInfo epg(id, common::uri::Uri(common::MemSPrintf("http://example.com/%d/index.m3u8", i)),
+                common::MemSPrintf("Channel %d", i));
+    EpgInfo::programs_t programs;
+    timestamp_t start = GUIDE_START - (i % 30) * MSEC_PER_MINUTE;
+    for (int j = 0; start < GUIDE_START + static_cast<timestamp_t>(GUIDE_DAYS) * MSEC_PER_DAY; ++j) {
+      const timestamp_t duration = (15 + (i * 7 + j * 13) % 76) * MSEC_PER_MINUTE;
+      programs.push_back(ProgrammeInfo(id, start, start + duration - 1,
+                                       common::MemSPrintf("Programme %d of channel %d, episode %d", j, i, j % 24)));
+      start += duration;
+    }
+    epg.SetPrograms(programs);
+    channels.push_back(ChannelInfo(epg, true, true));
+  }
+  return channels;
+}
+
+// previous lookup, whole epg copied out of channel and programmes copied while scanned
+std::string FindLinear(const ChannelInfo& channel, timestamp_t time) {
+  EpgInfo epg = channel.GetEpg();
+  EpgInfo::programs_t programs = epg.GetPrograms();
+  for (size_t i = 0; i < programs.size(); ++i) {
+    ProgrammeInfo pr = programs[i];
+    if (time >= pr.GetStart() && time <= pr.GetStop()) {
+      return pr.GetTitle();
+    }
+  }
+  return std::string();
+}
+
+std::string FindIndexed(const ChannelInfo& channel, timestamp_t time) {
+  const EpgInfo& epg = channel.GetEpg();
+  size_t index;
+  if (!epg.FindProgrammeIndexByTime(time, &index)) {
+    return std::string();
+  }
+  return epg.GetPrograms()[index].GetTitle();
+}
+
+std::string FindCached(const ChannelInfo& channel, client::ProgrammeCache* cache, timestamp_t time) {
+  const ProgrammeInfo* prog = cache->GetCurrent(channel.GetEpg(), time);
+  return prog ? prog->GetTitle() : std::string();
+}
+
+timestamp_t FrameTime(int frame) {
+  return GUIDE_START + static_cast<timestamp_t>(frame) * FRAME_STEP_MSEC;
+}
+
+void PrintResult(const char* name, int frames, double seconds) {
+  printf("%-16s %6d frames x %d channels %8.3f sec %10.1f usec/frame\n", name, frames, CHANNELS_COUNT, seconds,
+         seconds * 1000000 / frames);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int frames = 20;
+  if (argc > 1) {
+    frames = atoi(argv[1]);
+  }
+
+  const std::vector<ChannelInfo> channels = MakeGuide();
+  size_t programmes = 0;
+  for (const ChannelInfo& channel : channels) {
+    programmes += channel.GetEpg().GetPrograms().size();
+  }
+  printf("guide: %d channels, %d days, %zu programmes\n", CHANNELS_COUNT, GUIDE_DAYS, programmes);
+
+  std::vector<std::string> expected(static_cast<size_t>(frames) * channels.size());
+  auto start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; ++f) {
+    for (size_t i = 0; i < channels.size(); ++i) {
+      expected[f * channels.size() + i] = FindLinear(channels[i], FrameTime(f));
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  PrintResult("copy + linear", frames, elapsed.count());
+
+  size_t mismatches = 0;
+  start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; ++f) {
+    for (size_t i = 0; i < channels.size(); ++i) {
+      if (FindIndexed(channels[i], FrameTime(f)) != expected[f * channels.size() + i]) {
+        mismatches++;
+      }
+    }
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  PrintResult("indexed", frames, elapsed.count());
+
+  std::vector<client::ProgrammeCache> caches(channels.size());
+  start = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; ++f) {
+    for (size_t i = 0; i < channels.size(); ++i) {
+      if (FindCached(channels[i], &caches[i], FrameTime(f)) != expected[f * channels.size() + i]) {
+        mismatches++;
+      }
+    }
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  PrintResult("now/next cache", frames, elapsed.count());
+
+  size_t lookups = 0;
+  for (const client::ProgrammeCache& cache : caches) {
+    lookups += cache.GetLookups();
+  }
+  printf("%-16s %10zu epg searches for %zu calls\n", "", lookups, static_cast<size_t>(frames) * channels.size());
+
+  if (mismatches) {
+    printf("%zu results differ from linear search\n", mismatches);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h>  // for atoi, EXIT_SUCCESS
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <common/macros.h>
+#include <common/threads/types.h>  // for condition_variable, mutex
+
+#include "client/core/frames/frame_queue.h"
+
+using namespace fasto::fastotv::client::core;
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+struct BenchFrame {
+  BenchFrame() : pushed() {}
+  void ClearFrame() { pushed = bench_clock_t::time_point(); }
+
+  bench_clock_t::time_point pushed;
+};
+
+// previous mutex guarded ring, kept here as baseline
+template <typename T, size_t buffer_size>
+class LockedFrameQueue {
+ public:
+  typedef T* pointer_type;
+
+  LockedFrameQueue() : queue_cond_(), queue_mutex_(), queue_(), rindex_shown_(0), rindex_(0), windex_(0), size_(0) {
+    for (size_t i = 0; i < buffer_size; i++) {
+      queue_[i] = new T;
+    }
+  }
+
+  ~LockedFrameQueue() {
+    for (size_t i = 0; i < buffer_size; i++) {
+      delete queue_[i];
+    }
+  }
+
+  pointer_type GetPeekReadable() {
+    lock_t lock(queue_mutex_);
+    while (IsEmpty()) {
+      queue_cond_.wait(lock);
+    }
+    return queue_[(rindex_ + rindex_shown_) % buffer_size];
+  }
+
+  pointer_type GetPeekWritable() {
+    lock_t lock(queue_mutex_);
+    while (size_ >= buffer_size) {
+      queue_cond_.wait(lock);
+    }
+    return queue_[windex_];
+  }
+
+  void Push() {
+    if (++windex_ == buffer_size) {
+      windex_ = 0;
+    }
+    size_++;
+    Signal();
+  }
+
+  void Pop() {
+    if (!rindex_shown_) {
+      rindex_shown_ = 1;
+      return;
+    }
+    queue_[rindex_]->ClearFrame();
+    if (++rindex_ == buffer_size) {
+      rindex_ = 0;
+    }
+    size_--;
+    Signal();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LockedFrameQueue);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  void Signal() {
+    lock_t lock(queue_mutex_);
+    queue_cond_.notify_one();
+  }
+
+  bool IsEmpty() const { return size_ - rindex_shown_ <= 0; }
+
+  common::condition_variable queue_cond_;
+  common::mutex queue_mutex_;
+  pointer_type queue_[buffer_size];
+  size_t rindex_shown_;
+  size_t rindex_;
+  common::atomic<size_t> windex_;
+  common::atomic<size_t> size_;
+};
+
+template <typename Queue>
+void Run(const char* name, Queue& queue, int count) {
+  std::vector<double> latencies;
+  latencies.reserve(count);
+
+  auto start = bench_clock_t::now();
+  std::thread producer([&queue, count]() {
+    for (int i = 0; i < count; ++i) {
+      BenchFrame* fr = queue.GetPeekWritable();
+      fr->pushed = bench_clock_t::now();
+      queue.Push();
+    }
+  });
+
+  for (int i = 0; i < count; ++i) {
+    BenchFrame* fr = queue.GetPeekReadable();
+    std::chrono::duration<double, std::micro> latency = bench_clock_t::now() - fr->pushed;
+    latencies.push_back(latency.count());
+    queue.Pop();
+  }
+  producer.join();
+  std::chrono::duration<double> elapsed = bench_clock_t::now() - start;
+
+  std::sort(latencies.begin(), latencies.end());
+  double sum = 0;
+  for (double lat : latencies) {
+    sum += lat;
+  }
+  printf("%-16s %10d frames %12.0f frames/sec latency usec: avg %8.2f p50 %8.2f p99 %8.2f max %8.2f\n", name, count,
+         count / elapsed.count(), sum / latencies.size(), latencies[latencies.size() / 2],
+         latencies[latencies.size() * 99 / 100], latencies.back());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int count = 1000000;
+  if (argc > 1) {
+    count = atoi(argv[1]);
+  }
+
+  {
+    LockedFrameQueue<BenchFrame, 3> queue;
+    Run("mutex ring(3)", queue, count);
+  }
+  {
+    frames::BaseFrameQueue<BenchFrame> queue(3, 3);
+    Run("spsc ring(3)", queue, count);
+  }
+  {
+    LockedFrameQueue<BenchFrame, 9> queue;
+    Run("mutex ring(9)", queue, count);
+  }
+  {
+    frames::BaseFrameQueue<BenchFrame> queue(9, 9);
+    Run("spsc ring(9)", queue, count);
+  }
+  return EXIT_SUCCESS;
+}
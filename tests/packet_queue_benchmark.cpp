@@ -0,0 +1,175 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h>  // for atoi, EXIT_SUCCESS
+
+#include <chrono>
+#include <deque>
+#include <thread>
+
+#include <common/macros.h>
+#include <common/threads/types.h>  // for condition_variable, mutex
+
+extern "C" {
+#include <libavcodec/avcodec.h>  // for AVPacket
+}
+
+#include "client/core/packet_queue.h"
+
+using namespace fasto::fastotv::client::core;
+
+namespace {
+
+// previous mutex + deque queue, kept here as baseline
+class LockedPacketQueue {
+ public:
+  LockedPacketQueue() : queue_(), abort_request_(true), cond_(), mutex_() {}
+  ~LockedPacketQueue() { Flush(); }
+
+  void Start() {
+    lock_t lock(mutex_);
+    abort_request_ = false;
+    cond_.notify_one();
+  }
+
+  void Abort() {
+    lock_t lock(mutex_);
+    abort_request_ = true;
+    cond_.notify_one();
+  }
+
+  int Put(AVPacket* pkt) {
+    lock_t lock(mutex_);
+    if (abort_request_) {
+      av_packet_unref(pkt);
+      return -1;
+    }
+
+    queue_.push_back(*pkt);
+    cond_.notify_one();
+    return 0;
+  }
+
+  bool Get(AVPacket* pkt) {
+    lock_t lock(mutex_);
+    while (queue_.empty() && !abort_request_) {
+      cond_.wait(lock);
+    }
+    if (abort_request_) {
+      return false;
+    }
+
+    *pkt = queue_[0];
+    queue_.pop_front();
+    return true;
+  }
+
+  void Flush() {
+    lock_t lock(mutex_);
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+      AVPacket pkt = *it;
+      av_packet_unref(&pkt);
+    }
+    queue_.clear();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LockedPacketQueue);
+  typedef common::unique_lock<common::mutex> lock_t;
+
+  std::deque<AVPacket> queue_;
+  bool abort_request_;
+  common::condition_variable cond_;
+  common::mutex mutex_;
+};
+
+#define FAKE_PACKET_SIZE 4096
+
+void MakePacket(AVPacket* pkt) {
+  // refcounted payload like demuxer produces
+  av_new_packet(pkt, FAKE_PACKET_SIZE);
+  pkt->duration = 1;
+}
+
+template <typename Queue>
+double RunSingle(Queue* queue, int count) {
+  queue->Start();
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([queue, count]() {
+    for (int i = 0; i < count; ++i) {
+      AVPacket pkt;
+      MakePacket(&pkt);
+      queue->Put(&pkt);
+    }
+  });
+
+  for (int i = 0; i < count; ++i) {
+    AVPacket pkt;
+    if (!queue->Get(&pkt)) {
+      break;
+    }
+    av_packet_unref(&pkt);
+  }
+  producer.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  queue->Abort();
+  return elapsed.count();
+}
+
+double RunBatch(PacketQueue* queue, int count, size_t batch) {
+  queue->Start();
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([queue, count]() {
+    for (int i = 0; i < count; ++i) {
+      AVPacket pkt;
+      MakePacket(&pkt);
+      queue->Put(&pkt);
+    }
+  });
+
+  AVPacket* pkts = new AVPacket[batch];
+  int received = 0;
+  while (received < count) {
+    size_t got = queue->GetBatch(pkts, batch);
+    if (!got) {
+      break;
+    }
+    for (size_t i = 0; i < got; ++i) {
+      av_packet_unref(&pkts[i]);
+    }
+    received += got;
+  }
+  producer.join();
+  delete[] pkts;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  queue->Abort();
+  return elapsed.count();
+}
+
+void PrintResult(const char* name, int count, double seconds) {
+  printf("%-24s %10d packets %8.3f sec %12.0f packets/sec\n", name, count, seconds, count / seconds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int count = 5000000;
+  if (argc > 1) {
+    count = atoi(argv[1]);
+  }
+
+  {
+    LockedPacketQueue queue;
+    PrintResult("mutex deque", count, RunSingle(&queue, count));
+  }
+  {
+    PacketQueue queue;
+    PrintResult("spsc Get", count, RunSingle(&queue, count));
+  }
+  const size_t batches[] = {4, 8, 32};
+  for (size_t i = 0; i < SIZEOFMASS(batches); ++i) {
+    PacketQueue queue;
+    char name[32];
+    snprintf(name, sizeof(name), "spsc GetBatch(%zu)", batches[i]);
+    PrintResult(name, count, RunBatch(&queue, count, batches[i]));
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h>  // for atoi, EXIT_SUCCESS
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <common/convert2string.h>
+
+#include "client/text_texture_cache.h"
+
+using namespace fasto::fastotv::client;
+
+namespace {
+
+#define DEFAULT_FONT_PATH PROJECT_TEST_SOURCES_DIR "/../install/fastotv/fonts/FreeSans.ttf"
+#define STATS_LINES_COUNT 18
+#define PROGRAMS_COUNT 10
+
+const SDL_Color text_color = {255, 255, 255, 0};
+
+void DrawText(TextTextureCache* cache,
+              SDL_Renderer* renderer,
+              TTF_Font* font,
+              const std::string& text,
+              SDL_Rect rect,
+              bool wrapped) {
+  int width = 0, height = 0;
+  SDL_Texture* texture = cache->GetTexture(renderer, font, text, text_color, wrapped ? rect.w : 0, &width, &height);
+  if (!texture) {
+    return;
+  }
+  rect.w = width;
+  rect.h = height;
+  SDL_RenderCopy(renderer, texture, NULL, &rect);
+}
+
+// statistics panel with a few values changing every frame, programs list, keypad and footer
+void DrawOverlay(TextTextureCache* cache, SDL_Renderer* renderer, TTF_Font* font, int frame) {
+  const int line_height = TTF_FontLineSkip(font);
+  for (int i = 0; i < STATS_LINES_COUNT; ++i) {
+    std::string line = "STAT" + common::ConvertToString(i) + ": ";
+    if (i == 3 || i == 4 || i == 5) {  // DIFF, PTS, FPS
+      line += common::ConvertToString(frame * (i + 1) % 1000);
+    } else {
+      line += "N/A";
+    }
+    SDL_Rect rect = {0, i * line_height, 400, line_height};
+    DrawText(cache, renderer, font, line, rect, true);
+  }
+
+  for (int i = 0; i < PROGRAMS_COUNT; ++i) {
+    SDL_Rect number_rect = {880, i * line_height * 2, 40, line_height * 2};
+    DrawText(cache, renderer, font, common::ConvertToString(i + 1), number_rect, false);
+    SDL_Rect text_rect = {920, i * line_height * 2, 360, line_height * 2};
+    DrawText(cache, renderer, font, "Channel " + common::ConvertToString(i + 1) + "\nCurrent program title", text_rect,
+             true);
+  }
+
+  SDL_Rect keypad_rect = {1200, 600, 80, line_height};
+  DrawText(cache, renderer, font, "123", keypad_rect, false);
+  SDL_Rect footer_rect = {0, 680, 1280, line_height};
+  DrawText(cache, renderer, font, "Channel 1: Current program title", footer_rect, false);
+}
+
+void Run(const char* name, size_t budget, SDL_Renderer* renderer, TTF_Font* font, int frames) {
+  TextTextureCache cache(budget);
+  std::vector<double> times;
+  times.reserve(frames);
+  for (int i = 0; i < frames; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    SDL_RenderClear(renderer);
+    DrawOverlay(&cache, renderer, font, i);
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    times.push_back(elapsed.count());
+  }
+
+  std::sort(times.begin(), times.end());
+  double sum = 0;
+  for (double time : times) {
+    sum += time;
+  }
+  printf("%-10s %6d frames draw usec: avg %9.1f p50 %9.1f p99 %9.1f hits %8zu misses %8zu used %6zu KB\n", name,
+         frames, sum / times.size(), times[times.size() / 2], times[times.size() * 99 / 100], cache.GetHits(),
+         cache.GetMisses(), cache.GetUsedBytes() / 1024);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int frames = 1000;
+  const char* font_path = DEFAULT_FONT_PATH;
+  if (argc > 1) {
+    frames = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    font_path = argv[2];
+  }
+  if (frames <= 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (TTF_Init() != 0) {
+    printf("TTF_Init failed: %s\n", TTF_GetError());
+    return EXIT_FAILURE;
+  }
+
+  TTF_Font* font = TTF_OpenFont(font_path, 24);
+  if (!font) {
+    printf("Couldn't open font file path: %s\n", font_path);
+    TTF_Quit();
+    return EXIT_FAILURE;
+  }
+
+  // software renderer, no window or display needed
+  SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, 1280, 720, 32, SDL_PIXELFORMAT_ARGB8888);
+  SDL_Renderer* renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+  if (!renderer) {
+    printf("Couldn't create software renderer: %s\n", SDL_GetError());
+    SDL_FreeSurface(target);
+    TTF_CloseFont(font);
+    TTF_Quit();
+    return EXIT_FAILURE;
+  }
+
+  Run("disabled", 0, renderer, font, frames);
+  Run("enabled", TextTextureCache::default_budget, renderer, font, frames);
+
+  SDL_DestroyRenderer(renderer);
+  SDL_FreeSurface(target);
+  TTF_CloseFont(font);
+  TTF_Quit();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <SDL2/SDL_audio.h>
+
+#include "client/core/audio_mix.h"
+
+using namespace fasto::fastotv::client::core;
+
+namespace {
+
+const AudioMixKernel kernels[] = {AUDIO_MIX_KERNEL_C, AUDIO_MIX_KERNEL_SSE2, AUDIO_MIX_KERNEL_AVX2,
+                                  AUDIO_MIX_KERNEL_NEON, AUDIO_MIX_KERNEL_AUTO};
+const size_t samples_count = 4096 + 13;  // tail which doesn't fill vector register
+
+std::vector<int16_t> MakeS16Samples() {
+  std::vector<int16_t> samples(samples_count);
+  srand(0);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int16_t>(rand() & 0xFFFF);
+  }
+  const int16_t edges[] = {-32768, 32767, -1, 1, 0, -127, -128, -129, 127, 128, 129};
+  memcpy(samples.data(), edges, sizeof(edges));
+  return samples;
+}
+
+std::vector<float> MakeFltSamples() {
+  std::vector<float> samples(samples_count);
+  srand(0);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+  }
+  const float edges[] = {-0.0f, 0.0f, -1.0f, 1.0f, 1e-30f, -1e-30f, 0.999999f, -0.999999f};
+  memcpy(samples.data(), edges, sizeof(edges));
+  return samples;
+}
+
+}  // namespace
+
+TEST(audio_mix, s16_bit_exact_with_sdl) {
+  const std::vector<int16_t> src = MakeS16Samples();
+  const Uint32 len = src.size() * sizeof(int16_t);
+  for (AudioMixKernel kernel : kernels) {
+    if (!IsAudioMixKernelSupported(kernel)) {
+      continue;
+    }
+    for (int volume = 0; volume <= AUDIO_MIX_MAX_VOLUME; ++volume) {
+      std::vector<int16_t> expected(src.size(), 0);
+      SDL_MixAudioFormat(reinterpret_cast<Uint8*>(expected.data()), reinterpret_cast<const Uint8*>(src.data()),
+                         AUDIO_S16SYS, len, volume);
+      std::vector<int16_t> result(src.size(), 0x55);
+      ScaleAudioS16(result.data(), src.data(), src.size(), volume, kernel);
+      ASSERT_EQ(memcmp(expected.data(), result.data(), len), 0) << ConvertAudioMixKernelToString(kernel) << " volume "
+                                                                << volume;
+    }
+  }
+}
+
+TEST(audio_mix, flt_bit_exact_with_sdl) {
+  const std::vector<float> src = MakeFltSamples();
+  const Uint32 len = src.size() * sizeof(float);
+  for (AudioMixKernel kernel : kernels) {
+    if (!IsAudioMixKernelSupported(kernel)) {
+      continue;
+    }
+    for (int volume = 0; volume <= AUDIO_MIX_MAX_VOLUME; ++volume) {
+      std::vector<float> expected(src.size(), 0.0f);
+      SDL_MixAudioFormat(reinterpret_cast<Uint8*>(expected.data()), reinterpret_cast<const Uint8*>(src.data()),
+                         AUDIO_F32SYS, len, volume);
+      std::vector<float> result(src.size(), 0.5f);
+      ScaleAudioFlt(result.data(), src.data(), src.size(), volume, kernel);
+      ASSERT_EQ(memcmp(expected.data(), result.data(), len), 0) << ConvertAudioMixKernelToString(kernel) << " volume "
+                                                                << volume;
+    }
+  }
+}
+
+TEST(audio_mix, scale_in_place) {
+  const std::vector<int16_t> src = MakeS16Samples();
+  std::vector<int16_t> expected(src.size());
+  ScaleAudioS16(expected.data(), src.data(), src.size(), 64, AUDIO_MIX_KERNEL_C);
+  std::vector<int16_t> result = src;
+  ASSERT_TRUE(ScaleAudio(reinterpret_cast<uint8_t*>(result.data()), reinterpret_cast<const uint8_t*>(result.data()),
+                         result.size() * sizeof(int16_t), AV_SAMPLE_FMT_S16, 64));
+  ASSERT_EQ(expected, result);
+  ASSERT_FALSE(ScaleAudio(reinterpret_cast<uint8_t*>(result.data()), reinterpret_cast<const uint8_t*>(src.data()),
+                          result.size() * sizeof(int16_t), AV_SAMPLE_FMT_S16P, 64));
+}
+
+TEST(audio_mix, volume_conversion) {
+  ASSERT_EQ(ConvertToMixVolume(-1), 0);
+  ASSERT_EQ(ConvertToMixVolume(0), 0);
+  ASSERT_EQ(ConvertToMixVolume(50), SDL_MIX_MAXVOLUME / 2);
+  ASSERT_EQ(ConvertToMixVolume(100), SDL_MIX_MAXVOLUME);
+  ASSERT_EQ(ConvertToMixVolume(150), SDL_MIX_MAXVOLUME);
+}
@@ -0,0 +1,320 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/icon_fetcher.h"
+
+#if defined(MSG_NOSIGNAL)
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0  // SO_NOSIGPIPE is set on accepted sockets
+#endif
+
+using namespace fasto::fastotv::client;
+
+namespace {
+
+// local stand-in of icon host, keep-alive connections and conditional requests
+class IconServer {
+ public:
+  IconServer()
+      : listen_fd_(-1),
+        port_(0),
+        stop_(false),
+        connections_(0),
+        requests_(0),
+        not_modified_(0),
+        chunked_(false),
+        body_("icon-v1"),
+        etag_("\"v1\"") {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen(listen_fd_, 16);
+    accept_thread_ = std::thread(&IconServer::Accept, this);
+  }
+
+  ~IconServer() {
+    stop_ = true;
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+    accept_thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < fds_.size(); ++i) {
+      shutdown(fds_[i], SHUT_RDWR);
+    }
+    for (size_t i = 0; i < clients_.size(); ++i) {
+      clients_[i].join();
+    }
+  }
+
+  std::string Url(const std::string& name) const { return "http://127.0.0.1:" + std::to_string(port_) + "/" + name; }
+
+  void SetContent(const std::string& body, const std::string& etag, bool chunked) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    body_ = body;
+    etag_ = etag;
+    chunked_ = chunked;
+  }
+
+  int GetConnections() const { return connections_; }
+  int GetRequests() const { return requests_; }
+  int GetNotModified() const { return not_modified_; }
+
+ private:
+  void Accept() {
+    while (!stop_) {
+      int fd = accept(listen_fd_, NULL, NULL);
+      if (fd < 0) {
+        return;
+      }
+#if defined(SO_NOSIGPIPE)
+      int on = 1;
+      setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+      connections_++;
+      std::lock_guard<std::mutex> lock(mutex_);
+      fds_.push_back(fd);
+      clients_.push_back(std::thread(&IconServer::Serve, this, fd));
+    }
+  }
+
+  void Serve(int fd) {
+    std::string buffer;
+    char data[4096];
+    while (!stop_) {
+      size_t end = buffer.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        ssize_t nread = recv(fd, data, sizeof(data), 0);
+        if (nread <= 0) {
+          break;
+        }
+        buffer.append(data, nread);
+        continue;
+      }
+
+      const std::string head = buffer.substr(0, end);
+      buffer.erase(0, end + 4);
+      requests_++;
+      std::string response;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (head.find("GET /missing") == 0) {
+          response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+        } else if (head.find("GET /stall") == 0) {
+          continue;  // never answered
+        } else if (head.find("GET /moved/") == 0) {
+          response = "HTTP/1.1 302 Found\r\nLocation: ../icons/./icon.png#top\r\nContent-Length: 0\r\n\r\n";
+        } else if (head.find("If-None-Match: " + etag_) != std::string::npos) {
+          not_modified_++;
+          response = "HTTP/1.1 304 Not Modified\r\nETag: " + etag_ + "\r\n\r\n";
+        } else if (chunked_) {
+          const size_t half = body_.size() / 2;
+          char size1[16], size2[16];
+          snprintf(size1, sizeof(size1), "%zx", half);
+          snprintf(size2, sizeof(size2), "%zx", body_.size() - half);
+          response = "HTTP/1.1 200 OK\r\nETag: " + etag_ + "\r\nTransfer-Encoding: chunked\r\n\r\n" + size1 + "\r\n" +
+                     body_.substr(0, half) + "\r\n" + size2 + "\r\n" + body_.substr(half) + "\r\n0\r\n\r\n";
+        } else {
+          response = "HTTP/1.1 200 OK\r\nETag: " + etag_ + "\r\nContent-Length: " + std::to_string(body_.size()) +
+                     "\r\n\r\n" + body_;
+        }
+      }
+      if (send(fd, response.data(), response.size(), SEND_FLAGS) != static_cast<ssize_t>(response.size())) {
+        break;
+      }
+    }
+    close(fd);
+  }
+
+  int listen_fd_;
+  uint16_t port_;
+  std::atomic<bool> stop_;
+  std::atomic<int> connections_;
+  std::atomic<int> requests_;
+  std::atomic<int> not_modified_;
+  std::thread accept_thread_;
+  std::mutex mutex_;
+  std::vector<std::thread> clients_;
+  std::vector<int> fds_;
+  bool chunked_;
+  std::string body_;
+  std::string etag_;
+};
+
+std::string MakeTempDir() {
+  char path[] = "/tmp/icon_fetcher_XXXXXX";
+  return mkdtemp(path) ? path : std::string();
+}
+
+std::string ReadFile(const std::string& path) {
+  std::string result;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return result;
+  }
+  char data[4096];
+  size_t nread;
+  while ((nread = fread(data, 1, sizeof(data), file)) > 0) {
+    result.append(data, nread);
+  }
+  fclose(file);
+  return result;
+}
+
+bool WaitFinished(const IconFetcher& fetcher, size_t count) {
+  for (int i = 0; i < 500; ++i) {
+    if (fetcher.GetUpdatedCount() + fetcher.GetNotModifiedCount() + fetcher.GetFailedCount() >= count) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(IconFetcher, download_revalidate_and_update) {
+  IconServer server;
+  const std::string dir = MakeTempDir();
+  ASSERT_FALSE(dir.empty());
+  const std::string path = dir + "/icon";
+
+  std::mutex updated_mutex;
+  std::vector<std::string> updated;
+  IconFetcher fetcher(
+      [&updated_mutex, &updated](const std::string& icon_path) {
+        std::lock_guard<std::mutex> lock(updated_mutex);
+        updated.push_back(icon_path);
+      },
+      1);
+  ASSERT_TRUE(fetcher.Start());
+
+  fetcher.Fetch(common::uri::Uri(server.Url("icon.png")), path);
+  ASSERT_TRUE(WaitFinished(fetcher, 1));
+  ASSERT_EQ(1u, fetcher.GetUpdatedCount());
+  ASSERT_EQ("icon-v1", ReadFile(path));
+  ASSERT_TRUE(ReadFile(path + ".tmp").empty());
+  ASSERT_NE(std::string::npos, ReadFile(path + ".meta").find("\"v1\""));
+
+  // same etag, file is kept
+  fetcher.Fetch(common::uri::Uri(server.Url("icon.png")), path);
+  ASSERT_TRUE(WaitFinished(fetcher, 2));
+  ASSERT_EQ(1u, fetcher.GetNotModifiedCount());
+  ASSERT_EQ(1, server.GetNotModified());
+  ASSERT_EQ("icon-v1", ReadFile(path));
+
+  // changed on server, chunked response
+  server.SetContent("icon-version-2", "\"v2\"", true);
+  fetcher.Fetch(common::uri::Uri(server.Url("icon.png")), path);
+  ASSERT_TRUE(WaitFinished(fetcher, 3));
+  ASSERT_EQ(2u, fetcher.GetUpdatedCount());
+  ASSERT_EQ("icon-version-2", ReadFile(path));
+  ASSERT_NE(std::string::npos, ReadFile(path + ".meta").find("\"v2\""));
+
+  fetcher.Stop();
+  std::lock_guard<std::mutex> lock(updated_mutex);
+  ASSERT_EQ(2u, updated.size());
+  ASSERT_EQ(path, updated[0]);
+
+  // all requests went through one keep-alive connection
+  ASSERT_EQ(1u, fetcher.GetConnectionsCount());
+  ASSERT_EQ(1, server.GetConnections());
+  ASSERT_EQ(3, server.GetRequests());
+
+  remove(path.c_str());
+  remove((path + ".meta").c_str());
+  rmdir(dir.c_str());
+}
+
+TEST(IconFetcher, concurrent_fetches_and_failures) {
+  IconServer server;
+  const std::string dir = MakeTempDir();
+  ASSERT_FALSE(dir.empty());
+
+  IconFetcher fetcher(IconFetcher::updated_callback_t(), 4);
+  ASSERT_TRUE(fetcher.Start());
+  const size_t icons_count = 40;
+  for (size_t i = 0; i < icons_count; ++i) {
+    fetcher.Fetch(common::uri::Uri(server.Url("icon" + std::to_string(i))), dir + "/" + std::to_string(i));
+  }
+  fetcher.Fetch(common::uri::Uri(server.Url("missing")), dir + "/missing");
+  ASSERT_TRUE(WaitFinished(fetcher, icons_count + 1));
+  fetcher.Stop();
+
+  ASSERT_EQ(icons_count, fetcher.GetUpdatedCount());
+  ASSERT_EQ(1u, fetcher.GetFailedCount());
+  ASSERT_LE(fetcher.GetConnectionsCount(), 4u);
+  ASSERT_TRUE(ReadFile(dir + "/missing").empty());
+  for (size_t i = 0; i < icons_count; ++i) {
+    const std::string path = dir + "/" + std::to_string(i);
+    ASSERT_EQ("icon-v1", ReadFile(path));
+    remove(path.c_str());
+    remove((path + ".meta").c_str());
+  }
+  rmdir(dir.c_str());
+}
+
+TEST(IconFetcher, relative_redirect) {
+  IconServer server;
+  const std::string dir = MakeTempDir();
+  ASSERT_FALSE(dir.empty());
+  const std::string path = dir + "/icon";
+
+  IconFetcher fetcher(IconFetcher::updated_callback_t(), 1);
+  ASSERT_TRUE(fetcher.Start());
+  fetcher.Fetch(common::uri::Uri(server.Url("moved/old.png")), path);
+  ASSERT_TRUE(WaitFinished(fetcher, 1));
+  fetcher.Stop();
+
+  ASSERT_EQ(1u, fetcher.GetUpdatedCount());
+  ASSERT_EQ("icon-v1", ReadFile(path));
+  ASSERT_EQ(2, server.GetRequests());
+  ASSERT_EQ(1, server.GetConnections());
+
+  remove(path.c_str());
+  remove((path + ".meta").c_str());
+  rmdir(dir.c_str());
+}
+
+TEST(IconFetcher, stop_interrupts_stalled_request) {
+  IconServer server;
+  const std::string dir = MakeTempDir();
+  ASSERT_FALSE(dir.empty());
+
+  IconFetcher fetcher(IconFetcher::updated_callback_t(), 1);
+  ASSERT_TRUE(fetcher.Start());
+  fetcher.Fetch(common::uri::Uri(server.Url("stall")), dir + "/stall");
+  for (int i = 0; i < 500 && server.GetRequests() == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1, server.GetRequests());
+
+  const auto start = std::chrono::steady_clock::now();
+  fetcher.Stop();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), IconFetcher::timeout_msec / 2);
+  ASSERT_EQ(1u, fetcher.GetFailedCount());
+  ASSERT_TRUE(ReadFile(dir + "/stall").empty());
+
+  rmdir(dir.c_str());
+}
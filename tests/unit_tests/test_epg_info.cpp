@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "epg_info.h"
+#include "programme_info.h"
+
+namespace {
+
+fasto::fastotv::ProgrammeInfo MakeProgramme(fasto::fastotv::timestamp_t start,
+                                            fasto::fastotv::timestamp_t stop,
+                                            const std::string& title) {
+  return fasto::fastotv::ProgrammeInfo("channel", start, stop, title);
+}
+
+fasto::fastotv::EpgInfo MakeEpg(const fasto::fastotv::EpgInfo::programs_t& programs) {
+  fasto::fastotv::EpgInfo epg("channel", common::uri::Uri("http://localhost:8080/play.m3u8"), "Channel");
+  epg.SetPrograms(programs);
+  return epg;
+}
+
+}  // namespace
+
+TEST(EpgInfo, programs_sorted_by_start) {
+  fasto::fastotv::EpgInfo::programs_t programs;
+  programs.push_back(MakeProgramme(200, 299, "third"));
+  programs.push_back(MakeProgramme(0, 99, "first"));
+  programs.push_back(MakeProgramme(100, 199, "second"));
+  const fasto::fastotv::EpgInfo epg = MakeEpg(programs);
+
+  const fasto::fastotv::EpgInfo::programs_t& sorted = epg.GetPrograms();
+  ASSERT_EQ(sorted.size(), 3u);
+  ASSERT_EQ(sorted[0].GetTitle(), "first");
+  ASSERT_EQ(sorted[1].GetTitle(), "second");
+  ASSERT_EQ(sorted[2].GetTitle(), "third");
+}
+
+TEST(EpgInfo, find_programme_by_time) {
+  fasto::fastotv::EpgInfo::programs_t programs;
+  programs.push_back(MakeProgramme(100, 199, "first"));
+  programs.push_back(MakeProgramme(200, 299, "second"));
+  programs.push_back(MakeProgramme(400, 499, "after gap"));
+  const fasto::fastotv::EpgInfo epg = MakeEpg(programs);
+
+  fasto::fastotv::ProgrammeInfo prog;
+  ASSERT_FALSE(epg.FindProgrammeByTime(99, &prog));
+  ASSERT_TRUE(epg.FindProgrammeByTime(100, &prog));
+  ASSERT_EQ(prog.GetTitle(), "first");
+  ASSERT_TRUE(epg.FindProgrammeByTime(199, &prog));
+  ASSERT_EQ(prog.GetTitle(), "first");
+  ASSERT_TRUE(epg.FindProgrammeByTime(250, &prog));
+  ASSERT_EQ(prog.GetTitle(), "second");
+  ASSERT_FALSE(epg.FindProgrammeByTime(350, &prog));
+  ASSERT_TRUE(epg.FindProgrammeByTime(499, &prog));
+  ASSERT_EQ(prog.GetTitle(), "after gap");
+  ASSERT_FALSE(epg.FindProgrammeByTime(500, &prog));
+
+  ASSERT_EQ(epg.FindNextProgrammeIndex(0), 0u);
+  ASSERT_EQ(epg.FindNextProgrammeIndex(150), 1u);
+  ASSERT_EQ(epg.FindNextProgrammeIndex(350), 2u);
+  ASSERT_EQ(epg.FindNextProgrammeIndex(450), 3u);
+}
+
+TEST(EpgInfo, find_programme_overlapped) {
+  fasto::fastotv::EpgInfo::programs_t programs;
+  programs.push_back(MakeProgramme(0, 999, "day"));
+  programs.push_back(MakeProgramme(100, 199, "news"));
+  programs.push_back(MakeProgramme(300, 399, "weather"));
+  const fasto::fastotv::EpgInfo epg = MakeEpg(programs);
+
+  size_t index;
+  ASSERT_TRUE(epg.FindProgrammeIndexByTime(150, &index));
+  ASSERT_EQ(epg.GetPrograms()[index].GetTitle(), "news");
+  ASSERT_TRUE(epg.FindProgrammeIndexByTime(250, &index));
+  ASSERT_EQ(epg.GetPrograms()[index].GetTitle(), "day");
+  ASSERT_TRUE(epg.FindProgrammeIndexByTime(999, &index));
+  ASSERT_EQ(epg.GetPrograms()[index].GetTitle(), "day");
+  ASSERT_FALSE(epg.FindProgrammeIndexByTime(1000, &index));
+}
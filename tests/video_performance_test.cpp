@@ -1,11 +1,41 @@
+#include <stdio.h>   // for printf, fopen
+#include <stdlib.h>  // for atoi, EXIT_SUCCESS
+#include <string.h>  // for strcmp, strstr
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(OS_POSIX)
+#include <sys/resource.h>  // for getrusage
+#else
+#include <windows.h>  // for GetProcessTimes
+#endif
+
 #include <common/application/application.h>
-#include <common/threads/types.h>  // for condition_variable, mutex
+#include <common/file_system.h>
+#include <common/threads/types.h>  // for atomic
+#include <common/utils.h>          // for MemSPrintf
+
+#include "ffmpeg_config.h"  // for CONFIG_AVFILTER
 
 extern "C" {
+#include <libavcodec/avcodec.h>
 #include <libavdevice/avdevice.h>  // for avdevice_register_all
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+#if CONFIG_AVFILTER
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#endif
 }
 
+#include "client/core/audio_params.h"
 #include "client/core/events/events.h"
+#include "client/core/frames/video_frame.h"
 #include "client/core/sdl_utils.h"
 #include "client/core/video_state.h"
 #include "client/core/video_state_handler.h"
@@ -14,7 +44,27 @@ using namespace fasto::fastotv;
 using namespace fasto::fastotv::client;
 using namespace fasto::fastotv::client::core;
 
+/*
+ * Headless playback benchmark, inputs are generated locally from lavfi testsrc/sine,
+ * so results are reproducible without network and display.
+ *
+ * video_performance_test [--duration sec] [--inputs dir] [--case substring]
+ *
+ * Prints one json object per case (json lines) into stdout.
+ * Peak RSS is process high-water mark, run one case per process (--case) for exact per case value.
+ */
+
+#define BENCHMARK_FRAME_RATE 25
+#define BENCHMARK_SAMPLE_RATE 48000
+#define BENCHMARK_DEFAULT_DURATION_SEC 10
+#define BENCHMARK_AUDIO_PERIOD_MSEC 20
+#define BENCHMARK_SAMPLE_PERIOD_MSEC 100  // queues occupancy sampling
+#define BENCHMARK_FILTERS "yadif,scale=iw/2:ih/2"
+#define BENCHMARK_PAUSE_AFTER_MSEC 2000  // paused pipeline plays this long to fill queues
+#define BENCHMARK_INPUTS_DIR PROJECT_TEST_SOURCES_DIR "/benchmark_inputs"
+
 namespace {
+
 struct DictionaryOptions {
   DictionaryOptions() : sws_dict(NULL), swr_opts(NULL), format_opts(NULL), codec_opts(NULL) {
     av_dict_set(&sws_dict, "flags", "bicubic", 0);
@@ -34,10 +84,293 @@ struct DictionaryOptions {
  private:
   DISALLOW_COPY_AND_ASSIGN(DictionaryOptions);
 };
-}  // namespace
 
-class FakeHandler : public VideoStateHandler {
-  virtual ~FakeHandler() {}
+struct BenchmarkInput {
+  const char* name;
+  const char* encoder_name;  // preferred encoder, default one for codec_id otherwise
+  AVCodecID codec_id;
+  int width;
+  int height;
+};
+
+const BenchmarkInput inputs[] = {{"h264_360p", "libx264", AV_CODEC_ID_H264, 640, 360},
+                                 {"h264_720p", "libx264", AV_CODEC_ID_H264, 1280, 720},
+                                 {"h264_1080p", "libx264", AV_CODEC_ID_H264, 1920, 1080},
+                                 {"hevc_360p", "libx265", AV_CODEC_ID_HEVC, 640, 360},
+                                 {"hevc_720p", "libx265", AV_CODEC_ID_HEVC, 1280, 720},
+                                 {"hevc_1080p", "libx265", AV_CODEC_ID_HEVC, 1920, 1080},
+                                 {"mpeg2_360p", "mpeg2video", AV_CODEC_ID_MPEG2VIDEO, 640, 360},
+                                 {"mpeg2_720p", "mpeg2video", AV_CODEC_ID_MPEG2VIDEO, 1280, 720},
+                                 {"mpeg2_1080p", "mpeg2video", AV_CODEC_ID_MPEG2VIDEO, 1920, 1080}};
+
+enum Pipeline { PIPELINE_DECODE = 0, PIPELINE_DECODE_FILTER = 1, PIPELINE_PAUSED = 2 };
+
+const char* ConvertPipelineToString(Pipeline pipeline) {
+  if (pipeline == PIPELINE_DECODE) {
+    return "decode";
+  } else if (pipeline == PIPELINE_DECODE_FILTER) {
+    return "decode+filter";
+  }
+  return "paused";
+}
+
+struct ResourceUsage {
+  double cpu_sec;    // user + system
+  long peak_rss_kb;  // 0 if unknown
+};
+
+ResourceUsage GetResourceUsage() {
+  ResourceUsage usage = {0, 0};
+#if defined(OS_POSIX)
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == 0) {
+    usage.cpu_sec = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+#if defined(__APPLE__)
+    usage.peak_rss_kb = ru.ru_maxrss / 1024;  // bytes
+#else
+    usage.peak_rss_kb = ru.ru_maxrss;
+#endif
+  }
+#else
+  FILETIME creation, exit, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    usage.cpu_sec = (k.QuadPart + u.QuadPart) / 1e7;  // 100 nsec units
+  }
+#endif
+  return usage;
+}
+
+#if CONFIG_AVFILTER
+class SourceGraph {
+ public:
+  SourceGraph() : graph_(avfilter_graph_alloc()), sink_(NULL) {}
+  ~SourceGraph() { avfilter_graph_free(&graph_); }
+
+  bool Init(const std::string& description, bool audio) {
+    if (!graph_) {
+      return false;
+    }
+
+    const char* sink_name = audio ? "abuffersink" : "buffersink";
+    if (avfilter_graph_create_filter(&sink_, avfilter_get_by_name(sink_name), "out", NULL, NULL, graph_) < 0) {
+      return false;
+    }
+
+    AVFilterInOut* outputs = NULL;
+    AVFilterInOut* inputs = avfilter_inout_alloc();
+    if (!inputs) {
+      return false;
+    }
+    inputs->name = av_strdup("out");
+    inputs->filter_ctx = sink_;
+    inputs->pad_idx = 0;
+    inputs->next = NULL;
+    int ret = avfilter_graph_parse_ptr(graph_, description.c_str(), &inputs, &outputs, NULL);
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    if (ret < 0) {
+      return false;
+    }
+    return avfilter_graph_config(graph_, NULL) >= 0;
+  }
+
+  void SetFrameSize(int frame_size) { av_buffersink_set_frame_size(sink_, frame_size); }
+
+  // 0 if frame received, AVERROR_EOF at the end of source
+  int GetFrame(AVFrame* frame) { return av_buffersink_get_frame(sink_, frame); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SourceGraph);
+
+  AVFilterGraph* graph_;
+  AVFilterContext* sink_;
+};
+
+class OutputStream {
+ public:
+  OutputStream() : enc_(NULL), st_(NULL), source_(), next_pts_(0), finished_(false) {}
+  ~OutputStream() { avcodec_free_context(&enc_); }
+
+  bool InitVideo(AVFormatContext* oc, const BenchmarkInput& input, int duration_sec) {
+    AVCodec* codec = avcodec_find_encoder_by_name(input.encoder_name);
+    if (!codec) {
+      codec = avcodec_find_encoder(input.codec_id);
+    }
+    if (!codec || !(enc_ = avcodec_alloc_context3(codec))) {
+      return false;
+    }
+
+    enc_->width = input.width;
+    enc_->height = input.height;
+    enc_->pix_fmt = AV_PIX_FMT_YUV420P;
+    enc_->time_base = {1, BENCHMARK_FRAME_RATE};
+    enc_->framerate = {BENCHMARK_FRAME_RATE, 1};
+    enc_->gop_size = BENCHMARK_FRAME_RATE * 2;
+    enc_->max_b_frames = 2;
+    enc_->bit_rate = static_cast<int64_t>(input.width) * input.height * 3;
+    av_opt_set(enc_->priv_data, "preset", "veryfast", 0);
+    const std::string description = common::MemSPrintf("testsrc=size=%dx%d:rate=%d:duration=%d,format=yuv420p",
+                                                       input.width, input.height, BENCHMARK_FRAME_RATE, duration_sec);
+    return Open(oc, codec) && source_.Init(description, false);
+  }
+
+  bool InitAudio(AVFormatContext* oc, int duration_sec) {
+    AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MP2);
+    if (!codec || !(enc_ = avcodec_alloc_context3(codec))) {
+      return false;
+    }
+
+    enc_->sample_fmt = AV_SAMPLE_FMT_S16;
+    enc_->sample_rate = BENCHMARK_SAMPLE_RATE;
+    enc_->channel_layout = AV_CH_LAYOUT_STEREO;
+    enc_->channels = av_get_channel_layout_nb_channels(enc_->channel_layout);
+    enc_->time_base = {1, BENCHMARK_SAMPLE_RATE};
+    enc_->bit_rate = 128000;
+    const std::string description = common::MemSPrintf(
+        "sine=frequency=440:sample_rate=%d:duration=%d,aformat=sample_fmts=s16:channel_layouts=stereo",
+        BENCHMARK_SAMPLE_RATE, duration_sec);
+    if (!Open(oc, codec) || !source_.Init(description, true)) {
+      return false;
+    }
+    source_.SetFrameSize(enc_->frame_size);
+    return true;
+  }
+
+  bool IsFinished() const { return finished_; }
+
+  // stream which should be written first for interleaving
+  bool IsBefore(const OutputStream& other) const {
+    return av_compare_ts(next_pts_, enc_->time_base, other.next_pts_, other.enc_->time_base) <= 0;
+  }
+
+  bool WriteNext(AVFormatContext* oc, AVFrame* frame) {
+    int ret = source_.GetFrame(frame);
+    if (ret == AVERROR_EOF) {
+      finished_ = true;
+      return Encode(oc, NULL);
+    }
+    if (ret < 0) {
+      return false;
+    }
+
+    frame->pts = next_pts_;
+    next_pts_ += enc_->codec_type == AVMEDIA_TYPE_AUDIO ? frame->nb_samples : 1;
+    bool result = Encode(oc, frame);
+    av_frame_unref(frame);
+    return result;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(OutputStream);
+
+  bool Open(AVFormatContext* oc, AVCodec* codec) {
+    if (oc->oformat->flags & AVFMT_GLOBALHEADER) {
+      enc_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if (avcodec_open2(enc_, codec, NULL) < 0) {
+      return false;
+    }
+
+    st_ = avformat_new_stream(oc, NULL);
+    if (!st_) {
+      return false;
+    }
+    st_->time_base = enc_->time_base;
+    return avcodec_parameters_from_context(st_->codecpar, enc_) >= 0;
+  }
+
+  bool Encode(AVFormatContext* oc, AVFrame* frame) {
+    if (avcodec_send_frame(enc_, frame) < 0) {
+      return false;
+    }
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    while (true) {
+      int ret = avcodec_receive_packet(enc_, &pkt);
+      if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return true;
+      }
+      if (ret < 0) {
+        return false;
+      }
+
+      av_packet_rescale_ts(&pkt, enc_->time_base, st_->time_base);
+      pkt.stream_index = st_->index;
+      if (av_interleaved_write_frame(oc, &pkt) < 0) {
+        return false;
+      }
+    }
+  }
+
+  AVCodecContext* enc_;
+  AVStream* st_;
+  SourceGraph source_;
+  int64_t next_pts_;
+  bool finished_;
+};
+
+bool EncodeInput(const BenchmarkInput& input, int duration_sec, const std::string& path) {
+  AVFormatContext* oc = NULL;
+  if (avformat_alloc_output_context2(&oc, NULL, "mpegts", path.c_str()) < 0) {
+    return false;
+  }
+
+  OutputStream video;
+  OutputStream audio;
+  bool result = video.InitVideo(oc, input, duration_sec) && audio.InitAudio(oc, duration_sec) &&
+                avio_open(&oc->pb, path.c_str(), AVIO_FLAG_WRITE) >= 0;
+  if (result && avformat_write_header(oc, NULL) >= 0) {
+    AVFrame* frame = av_frame_alloc();
+    while (result && frame && (!video.IsFinished() || !audio.IsFinished())) {
+      if (!video.IsFinished() && (audio.IsFinished() || video.IsBefore(audio))) {
+        result = video.WriteNext(oc, frame);
+      } else {
+        result = audio.WriteNext(oc, frame);
+      }
+    }
+    av_frame_free(&frame);
+    av_write_trailer(oc);
+  } else {
+    result = false;
+  }
+
+  avio_closep(&oc->pb);
+  avformat_free_context(oc);
+  if (!result) {
+    remove(path.c_str());
+  }
+  return result;
+}
+#endif
+
+// encoded files are kept in inputs directory and reused by next runs
+bool PrepareInput(const BenchmarkInput& input, int duration_sec, const std::string& inputs_dir, std::string* path) {
+  const std::string file_name = common::MemSPrintf("%s_%ds.ts", input.name, duration_sec);
+  *path = common::file_system::make_path(inputs_dir, file_name);
+  if (common::file_system::is_file_exist(*path)) {
+    return true;
+  }
+
+#if CONFIG_AVFILTER
+  return EncodeInput(input, duration_sec, *path);
+#else
+  return false;
+#endif
+}
+
+class BenchmarkHandler : public VideoStateHandler {
+ public:
+  BenchmarkHandler() : finished_(false) {}
+
+  bool IsFinished() const { return finished_; }
 
   // audio
   virtual bool HandleRequestAudio(VideoState* stream,
@@ -53,19 +386,13 @@ class FakeHandler : public VideoStateHandler {
     UNUSED(audio_buff_size);
 
     core::AudioParams laudio_hw_params;
-    if (!core::init_audio_params(3, 48000, 2, &laudio_hw_params)) {
+    if (!core::init_audio_params(AV_CH_LAYOUT_STEREO, BENCHMARK_SAMPLE_RATE, 2, &laudio_hw_params)) {
       return false;
     }
 
     *audio_hw_params = laudio_hw_params;
     return true;
   }
-  virtual void HanleAudioMix(uint8_t* audio_stream_ptr, const uint8_t* src, uint32_t len, int volume) override {
-    UNUSED(audio_stream_ptr);
-    UNUSED(src);
-    UNUSED(len);
-    UNUSED(volume);
-  }
 
   // video
   virtual bool HandleRequestVideo(VideoState* stream,
@@ -97,12 +424,187 @@ class FakeHandler : public VideoStateHandler {
     UNUSED(stream);
     UNUSED(exit_code);
     UNUSED(err);
+    finished_ = true;
   }
+
+ private:
+  common::atomic<bool> finished_;
+};
+
+struct BenchmarkResult {
+  BenchmarkResult()
+      : completed(false),
+        wall_sec(0),
+        frames(0),
+        frame_drops_early(0),
+        frame_drops_late(0),
+        video_queue_avg_kb(0),
+        video_queue_max_kb(0),
+        audio_queue_avg_kb(0),
+        audio_queue_max_kb(0),
+        cpu_msec_per_frame(0),
+        peak_rss_kb(0),
+        read_wakeups_per_sec(0) {}
+
+  bool completed;  // stream reached the end before timeout
+  double wall_sec;
+  size_t frames;
+  size_t frame_drops_early;
+  size_t frame_drops_late;
+  double video_queue_avg_kb;
+  int video_queue_max_kb;
+  double audio_queue_avg_kb;
+  int audio_queue_max_kb;
+  double cpu_msec_per_frame;  // whole process, decoded frames including dropped
+  long peak_rss_kb;
+  double read_wakeups_per_sec;  // paused pipeline counts only the pause
 };
 
+BenchmarkResult RunCase(const std::string& path, Pipeline pipeline, int duration_sec) {
+  core::AppOptions opt;
+  opt.auto_exit = true;
+#if CONFIG_AVFILTER
+  if (pipeline == PIPELINE_DECODE_FILTER) {
+    opt.vfilters = BENCHMARK_FILTERS;
+  }
+#endif
+  DictionaryOptions dict;
+  const core::ComplexOptions copt(dict.swr_opts, dict.sws_dict, dict.format_opts, dict.codec_opts);
+  BenchmarkHandler handler;
+  VideoState* vs = new VideoState("benchmark", common::uri::Uri("file://" + path), opt, copt, &handler);
+
+  BenchmarkResult result;
+  const ResourceUsage usage_start = GetResourceUsage();
+  const auto start = std::chrono::steady_clock::now();
+  if (vs->Exec() != EXIT_SUCCESS) {
+    delete vs;
+    return result;
+  }
+
+  // drains audio in realtime like sound card does
+  common::atomic<bool> stop(false);
+  core::AudioParams params;
+  bool params_ok = core::init_audio_params(AV_CH_LAYOUT_STEREO, BENCHMARK_SAMPLE_RATE, 2, &params);
+  UNUSED(params_ok);
+  const size_t audio_period_bytes = params.bytes_per_sec * BENCHMARK_AUDIO_PERIOD_MSEC / 1000;
+  std::thread audio([vs, &stop, audio_period_bytes]() {
+    std::vector<uint8_t> buffer(audio_period_bytes);
+    auto next = std::chrono::steady_clock::now();
+    while (!stop) {
+      vs->UpdateAudioBuffer(buffer.data(), static_cast<int>(buffer.size()), 100);
+      next += std::chrono::milliseconds(BENCHMARK_AUDIO_PERIOD_MSEC);
+      std::this_thread::sleep_until(next);
+    }
+  });
+
+  const bool pause = pipeline == PIPELINE_PAUSED;
+  // playback gets time for slow decoders, paused one just holds pause for duration
+  const auto deadline = start + std::chrono::milliseconds(pause ? BENCHMARK_PAUSE_AFTER_MSEC + duration_sec * 1000
+                                                                : (duration_sec * 3 + 10) * 1000);
+  auto next_sample = start;
+  auto wakeups_start = start;
+  size_t wakeups_base = 0;
+  size_t samples = 0;
+  double video_queue_sum = 0, audio_queue_sum = 0;
+  while (!handler.IsFinished() && std::chrono::steady_clock::now() < deadline) {
+    vs->TryToGetVideoFrame();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (pause && !vs->IsPaused() && now >= start + std::chrono::milliseconds(BENCHMARK_PAUSE_AFTER_MSEC)) {
+      vs->TogglePause();
+      wakeups_start = now;
+      wakeups_base = vs->GetStatistic()->read_wakeups;
+    }
+    if (now >= next_sample) {
+      VideoState::stats_t stats = vs->GetStatistic();
+      const int vqueue_kb = stats->video_queue_size / 1024;
+      const int aqueue_kb = stats->audio_queue_size / 1024;
+      video_queue_sum += vqueue_kb;
+      audio_queue_sum += aqueue_kb;
+      result.video_queue_max_kb = std::max(result.video_queue_max_kb, vqueue_kb);
+      result.audio_queue_max_kb = std::max(result.audio_queue_max_kb, aqueue_kb);
+      samples++;
+      next_sample += std::chrono::milliseconds(BENCHMARK_SAMPLE_PERIOD_MSEC);
+    }
+
+    // sleep until the next picture is due, at least a bit to not spin while decoders are busy
+    clock64_t wait_msec = 1;
+    const clock64_t next_frame = vs->GetNextFrameDeadline();
+    if (IsValidClock(next_frame)) {
+      wait_msec = std::max(wait_msec, std::min(next_frame - GetRealClockTime(), static_cast<clock64_t>(10)));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(wait_msec));
+  }
+
+  result.completed = handler.IsFinished();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.wall_sec = elapsed.count();
+  VideoState::stats_t stats = vs->GetStatistic();
+  result.frames = stats->frame_processed;
+  result.frame_drops_early = stats->frame_drops_early;
+  result.frame_drops_late = stats->frame_drops_late;
+  const std::chrono::duration<double> wakeups_elapsed = std::chrono::steady_clock::now() - wakeups_start;
+  if (wakeups_elapsed.count() > 0) {
+    result.read_wakeups_per_sec = (stats->read_wakeups - wakeups_base) / wakeups_elapsed.count();
+  }
+  if (samples) {
+    result.video_queue_avg_kb = video_queue_sum / samples;
+    result.audio_queue_avg_kb = audio_queue_sum / samples;
+  }
+
+  stop = true;
+  vs->Abort();
+  audio.join();
+  delete vs;
+
+  const ResourceUsage usage_end = GetResourceUsage();
+  const size_t decoded = result.frames + result.frame_drops_early + result.frame_drops_late;
+  if (decoded) {
+    result.cpu_msec_per_frame = (usage_end.cpu_sec - usage_start.cpu_sec) * 1000 / decoded;
+  }
+  result.peak_rss_kb = usage_end.peak_rss_kb;
+  return result;
+}
+
+void PrintResult(const BenchmarkInput& input, Pipeline pipeline, const BenchmarkResult& result) {
+  printf(
+      "{\"case\":\"%s\",\"pipeline\":\"%s\",\"width\":%d,\"height\":%d,\"completed\":%s,\"wall_sec\":%.3f,"
+      "\"frames\":%zu,\"fps\":%.2f,\"frame_drops_early\":%zu,\"frame_drops_late\":%zu,"
+      "\"video_queue_avg_kb\":%.1f,\"video_queue_max_kb\":%d,\"audio_queue_avg_kb\":%.1f,\"audio_queue_max_kb\":%d,"
+      "\"cpu_msec_per_frame\":%.3f,\"peak_rss_kb\":%ld,\"read_wakeups_per_sec\":%.1f}\n",
+      input.name, ConvertPipelineToString(pipeline), input.width, input.height, result.completed ? "true" : "false",
+      result.wall_sec, result.frames, result.wall_sec > 0 ? result.frames / result.wall_sec : 0.0,
+      result.frame_drops_early, result.frame_drops_late, result.video_queue_avg_kb, result.video_queue_max_kb,
+      result.audio_queue_avg_kb, result.audio_queue_max_kb, result.cpu_msec_per_frame, result.peak_rss_kb,
+      result.read_wakeups_per_sec);
+  fflush(stdout);
+}
+
+void PrintSkipped(const BenchmarkInput& input, const char* reason) {
+  printf("{\"case\":\"%s\",\"skipped\":\"%s\"}\n", input.name, reason);
+  fflush(stdout);
+}
+
+}  // namespace
+
 class FakeApplication : public common::application::IApplicationImpl {
  public:
-  FakeApplication(int argc, char** argv) : common::application::IApplicationImpl(argc, argv), stop_(false) {}
+  FakeApplication(int argc, char** argv)
+      : common::application::IApplicationImpl(argc, argv),
+        duration_sec_(BENCHMARK_DEFAULT_DURATION_SEC),
+        inputs_dir_(BENCHMARK_INPUTS_DIR),
+        case_filter_() {
+    for (int i = 1; i < argc; ++i) {
+      const bool last_arg = i == argc - 1;
+      if (strcmp(argv[i], "--duration") == 0 && !last_arg) {
+        duration_sec_ = std::max(atoi(argv[++i]), 1);
+      } else if (strcmp(argv[i], "--inputs") == 0 && !last_arg) {
+        inputs_dir_ = argv[++i];
+      } else if (strcmp(argv[i], "--case") == 0 && !last_arg) {
+        case_filter_ = argv[++i];
+      }
+    }
+  }
 
   virtual int PreExec() override { /* register all codecs, demux and protocols */
 #if CONFIG_AVDEVICE
@@ -114,46 +616,41 @@ class FakeApplication : public common::application::IApplicationImpl {
     av_register_all();
     return EXIT_SUCCESS;
   }
+
   virtual int Exec() override {
-    const stream_id id = "unique";
-    // wget http://download.blender.org/peach/bigbuckbunny_movies/big_buck_bunny_1080p_h264.mov
-    const common::uri::Uri uri = common::uri::Uri("file://" PROJECT_TEST_SOURCES_DIR "/big_buck_bunny_1080p_h264.mov");
-    core::AppOptions opt;
-    DictionaryOptions* dict = new DictionaryOptions;
-    const core::ComplexOptions copt(dict->swr_opts, dict->sws_dict, dict->format_opts, dict->codec_opts);
-    VideoStateHandler* handler = new FakeHandler;
-    VideoState* vs = new VideoState(id, uri, opt, copt, handler);
-    int res = vs->Exec();
-    if (res != EXIT_SUCCESS) {
-      delete handler;
-      delete dict;
-      return res;
-    }
-
-    std::thread audio([this, vs]() {
-      while (!stop_) {
-        uint8_t stream_buff[8192];
-        vs->UpdateAudioBuffer(stream_buff, sizeof(stream_buff), 100);
-        std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    if (!common::file_system::is_directory_exist(inputs_dir_)) {
+      common::ErrnoError err = common::file_system::create_directory(inputs_dir_, true);
+      if (err && err->IsError()) {
+        DEBUG_MSG_ERROR(err);
+        return EXIT_FAILURE;
       }
-    });
+    }
 
-    lock_t lock(stop_mutex_);
-    while (!stop_) {
-      std::cv_status interrupt_status = stop_cond_.wait_for(lock, std::chrono::milliseconds(20));
-      if (interrupt_status == std::cv_status::no_timeout) {  // if notify
-      } else {
-        vs->TryToGetVideoFrame();
+    const Pipeline pipelines[] = {PIPELINE_DECODE, PIPELINE_DECODE_FILTER, PIPELINE_PAUSED};
+    for (size_t i = 0; i < SIZEOFMASS(inputs); ++i) {
+      const BenchmarkInput& input = inputs[i];
+      if (!case_filter_.empty() && !strstr(input.name, case_filter_.c_str())) {
+        continue;
       }
-    }
 
-    vs->Abort();
-    audio.join();
-    delete vs;
-    delete handler;
-    delete dict;
+      std::string path;
+      if (!PrepareInput(input, duration_sec_, inputs_dir_, &path)) {
+        PrintSkipped(input, "no encoder");
+        continue;
+      }
+
+      for (size_t j = 0; j < SIZEOFMASS(pipelines); ++j) {
+#if !CONFIG_AVFILTER
+        if (pipelines[j] == PIPELINE_DECODE_FILTER) {
+          continue;
+        }
+#endif
+        PrintResult(input, pipelines[j], RunCase(path, pipelines[j], duration_sec_));
+      }
+    }
     return EXIT_SUCCESS;
   }
+
   virtual int PostExec() override { return EXIT_SUCCESS; }
 
   virtual void PostEvent(event_t* event) override {
@@ -162,14 +659,7 @@ class FakeApplication : public common::application::IApplicationImpl {
       core::events::RequestVideoEvent* avent = static_cast<core::events::RequestVideoEvent*>(event);
       core::events::FrameInfo fr = avent->info();
       bool res = fr.stream_->RequestVideo(fr.width, fr.height, fr.av_pixel_format, fr.aspect_ratio);
-      if (!res) {
-        fApp->Exit(EXIT_FAILURE);
-      }
-    } else if (fevent->GetEventType() == core::events::QuitStreamEvent::EventType) {
-      // events::QuitStreamEvent* qevent = static_cast<core::events::QuitStreamEvent*>(event);
-      fApp->Exit(EXIT_SUCCESS);
-    } else {
-      NOTREACHED();
+      UNUSED(res);
     }
   }
   virtual void SendEvent(event_t* event) override {
@@ -190,12 +680,7 @@ class FakeApplication : public common::application::IApplicationImpl {
   virtual void ShowCursor() override {}
   virtual void HideCursor() override {}
 
-  virtual void Exit(int result) override {
-    UNUSED(result);
-    lock_t lock(stop_mutex_);
-    stop_ = true;
-    stop_cond_.notify_one();
-  }
+  virtual void Exit(int result) override { UNUSED(result); }
 
   virtual common::application::timer_id_t AddTimer(uint32_t interval,
                                                    common::application::timer_callback_t cb,
@@ -212,10 +697,9 @@ class FakeApplication : public common::application::IApplicationImpl {
   }
 
  private:
-  typedef common::unique_lock<common::mutex> lock_t;
-  common::condition_variable stop_cond_;
-  common::mutex stop_mutex_;
-  bool stop_;
+  int duration_sec_;
+  std::string inputs_dir_;
+  std::string case_filter_;
 };
 
 common::application::IApplicationImpl* CreateApplicationImpl(int argc, char** argv) {
@@ -223,11 +707,8 @@ common::application::IApplicationImpl* CreateApplicationImpl(int argc, char** ar
 }
 
 int main(int argc, char** argv) {
-#if defined(NDEBUG)
-  common::logging::LEVEL_LOG level = common::logging::L_INFO;
-#else
-  common::logging::LEVEL_LOG level = common::logging::L_INFO;
-#endif
+  // results go to stdout, keep log quiet
+  common::logging::LEVEL_LOG level = common::logging::L_WARNING;
 #if defined(LOG_TO_FILE)
   std::string log_path = common::file_system::prepare_path("~/" PROJECT_NAME_LOWERCASE ".log");
   INIT_LOGGER(PROJECT_NAME_TITLE, log_path, level);